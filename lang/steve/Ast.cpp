@@ -1,6 +1,8 @@
 
 #include <iostream>
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 
 #include <steve/Ast.hpp>
 #include <steve/Type.hpp>
@@ -69,6 +71,233 @@ init_exprs() {
 }
 
 
+// -------------------------------------------------------------------------- //
+// Canonical types
+//
+// Canonical types are hash-consed in a global table. Two types are
+// the same entry when they have the same kind and their operands are
+// identical. Operands are compared shallowly: canonical and other
+// user-defined types by address, builtin types by kind, and integer,
+// boolean, and unit terms by value. Any other operand (e.g., a
+// reference to a parameter) is also compared by address, so types
+// that depend on different declarations are never merged.
+
+namespace {
+
+inline std::size_t
+hash_combine(std::size_t h, std::size_t v) {
+  return h ^ (v + 0x9e3779b9 + (h << 6) + (h >> 2));
+}
+
+// Returns true if e is a builtin type, which is identified by its kind.
+inline bool
+is_builtin_type(Expr* e) {
+  switch (e->kind) {
+  case typename_type:
+  case unit_type:
+  case bool_type:
+  case nat_type:
+  case int_type:
+  case char_type:
+    return true;
+  default:
+    return false;
+  }
+}
+
+std::size_t
+hash_operand(Expr* e) {
+  if (not e)
+    return 0;
+  if (is_builtin_type(e))
+    return e->kind;
+  switch (e->kind) {
+  case unit_term: return e->kind;
+  case bool_term: return hash_combine(e->kind, as<Bool>(e)->value());
+  case int_term: return hash_combine(e->kind, as<Int>(e)->value().gets());
+  default: return std::hash<Expr*>()(e);
+  }
+}
+
+template<typename T>
+  std::size_t
+  hash_operand(Seq<T>* s) {
+    std::size_t h = s->size();
+    for (T* e : *s)
+      h = hash_combine(h, hash_operand(e));
+    return h;
+  }
+
+bool
+same_operand(Expr* a, Expr* b) {
+  if (a == b)
+    return true;
+  if (not a or not b or a->kind != b->kind)
+    return false;
+  if (is_builtin_type(a))
+    return true;
+  switch (a->kind) {
+  case unit_term: return true;
+  case bool_term: return as<Bool>(a)->value() == as<Bool>(b)->value();
+  case int_term: return as<Int>(a)->value() == as<Int>(b)->value();
+  default: return false;
+  }
+}
+
+template<typename T>
+  bool
+  same_operand(Seq<T>* a, Seq<T>* b) {
+    if (a->size() != b->size())
+      return false;
+    for (std::size_t i = 0; i < a->size(); ++i)
+      if (not same_operand((*a)[i], (*b)[i]))
+        return false;
+    return true;
+  }
+
+std::size_t
+hash_type(Type* t) {
+  std::size_t h = t->kind;
+  switch (t->kind) {
+  case fn_type: {
+    Fn_type* f = as<Fn_type>(t);
+    h = hash_combine(h, hash_operand(f->first));
+    return hash_combine(h, hash_operand(f->second));
+  }
+  case range_type:
+    return hash_combine(h, hash_operand(as<Range_type>(t)->first));
+  case bitfield_type: {
+    Bitfield_type* b = as<Bitfield_type>(t);
+    h = hash_combine(h, hash_operand(b->first));
+    h = hash_combine(h, hash_operand(b->second));
+    return hash_combine(h, hash_operand(b->third));
+  }
+  case net_str_type:
+    return hash_combine(h, hash_operand(as<Net_str_type>(t)->first));
+  case net_seq_type: {
+    Net_seq_type* s = as<Net_seq_type>(t);
+    h = hash_combine(h, hash_operand(s->first));
+    return hash_combine(h, hash_operand(s->second));
+  }
+  default: break;
+  }
+  steve_unreachable(format("hashing non-canonical type '{}'", node_name(t)));
+}
+
+bool
+same_type(Type* a, Type* b) {
+  if (a->kind != b->kind)
+    return false;
+  switch (a->kind) {
+  case fn_type: {
+    Fn_type* f = as<Fn_type>(a);
+    Fn_type* g = as<Fn_type>(b);
+    return same_operand(f->first, g->first) 
+       and same_operand(f->second, g->second);
+  }
+  case range_type:
+    return same_operand(as<Range_type>(a)->first, as<Range_type>(b)->first);
+  case bitfield_type: {
+    Bitfield_type* x = as<Bitfield_type>(a);
+    Bitfield_type* y = as<Bitfield_type>(b);
+    return same_operand(x->first, y->first)
+       and same_operand(x->second, y->second)
+       and same_operand(x->third, y->third);
+  }
+  case net_str_type:
+    return same_operand(as<Net_str_type>(a)->first, as<Net_str_type>(b)->first);
+  case net_seq_type: {
+    Net_seq_type* x = as<Net_seq_type>(a);
+    Net_seq_type* y = as<Net_seq_type>(b);
+    return same_operand(x->first, y->first) 
+       and same_operand(x->second, y->second);
+  }
+  default: break;
+  }
+  steve_unreachable(format("comparing non-canonical type '{}'", node_name(a)));
+}
+
+struct type_hash {
+  std::size_t operator()(Type* t) const { return hash_type(t); }
+};
+
+struct type_eq {
+  bool operator()(Type* a, Type* b) const { return same_type(a, b); }
+};
+
+// The type table is shared by all threads, so every access is
+// serialized.
+struct Type_table {
+  std::mutex mutex;
+  std::unordered_set<Type*, type_hash, type_eq> types;
+  std::size_t lookups = 0;
+};
+
+Type_table&
+type_table() {
+  static Type_table tab;
+  return tab;
+}
+
+} // namespace
+
+// Returns true if t is of a kind that is hash-consed.
+bool
+is_canonical_type(Type* t) {
+  switch (t->kind) {
+  case fn_type:
+  case range_type:
+  case bitfield_type:
+  case net_str_type:
+  case net_seq_type:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Returns the canonical type that is the same as t, or nullptr if
+// there is no such type.
+Type*
+find_type(Type* t) {
+  Type_table& tab = type_table();
+  std::lock_guard<std::mutex> lock(tab.mutex);
+  ++tab.lookups;
+  auto iter = tab.types.find(t);
+  return iter != tab.types.end() ? *iter : nullptr;
+}
+
+// Make t the canonical type for its operands. If another thread has
+// already done so, that type is returned instead.
+Type*
+intern_type(Type* t) {
+  Type_table& tab = type_table();
+  std::lock_guard<std::mutex> lock(tab.mutex);
+  return *tab.types.insert(t).first;
+}
+
+// Remove the canonical types allocated in the arena a from the table.
+// This is done before the arena is released.
+void
+forget_types(const Arena& a) {
+  Type_table& tab = type_table();
+  std::lock_guard<std::mutex> lock(tab.mutex);
+  for (auto iter = tab.types.begin(); iter != tab.types.end(); ) {
+    if (a.owns(*iter))
+      iter = tab.types.erase(iter);
+    else
+      ++iter;
+  }
+}
+
+Type_table_stats
+type_table_stats() {
+  Type_table& tab = type_table();
+  std::lock_guard<std::mutex> lock(tab.mutex);
+  return {tab.lookups, tab.types.size()};
+}
+
+
 // -------------------------------------------------------------------------- //
 // Debug printing
 //
@@ -191,6 +420,29 @@ template<typename T>
 void
 debug_fn(Printer& p, Fn* e) { debug_ternary(p, e); }
 
+// Print the target of a call. A defined function is printed by the
+// name of its definition rather than inline, since its body may call
+// the function itself.
+void
+debug_callee(Printer& p, Expr* e) {
+  if (Fn* f = as<Fn>(e)) {
+    if (f->def_) {
+      sexpr s(p, node_name(decl_id));
+      debug_print(p, name(f->def_));
+      return;
+    }
+  }
+  debug_print(p, e);
+}
+
+void
+debug_call(Printer& p, Call* e) {
+  sexpr s(p, node_name(e));
+  debug_callee(p, e->first);
+  print_space(p);
+  debug_print(p, e->second);
+}
+
 // Decls
 
 template<typename T>
@@ -284,7 +536,7 @@ debug_print(Printer& p, Expr* e) {
   case default_term: return print(p, "default");
   case fn_term: return debug_fn(p, as<Fn>(e));
   case builtin_term: return print(p, "<builtin>");
-  case call_term: return debug_binary(p, as<Call>(e));
+  case call_term: return debug_call(p, as<Call>(e));
   case promo_term: return debug_binary(p, as<Promo>(e));
   case pred_term: return debug_binary(p, as<Pred>(e));
   case range_term: return debug_binary(p, as<Range>(e));
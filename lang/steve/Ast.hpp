@@ -561,6 +561,13 @@ struct Dep_type : Type, Kind_of<dep_type> {
 //
 // TODO: Consider having a different sequence of declarations for module
 // imports. 
+//
+// A module loaded from its saved image has no declarations until they
+// are first requested, at which point the image is read.
+struct Module;
+
+Decl_seq* load_decls(const Module*);
+
 struct Module : Type, Kind_of<module_type> {
   Module(const Path& p, Name* n, Decl_seq* e)
     : Type(Kind), path_(p), first(n), second(e) { }
@@ -569,7 +576,7 @@ struct Module : Type, Kind_of<module_type> {
 
   const Path path() const { return path_; }
   Name* name() const { return first; }
-  Decl_seq* decls() const { return second; }
+  Decl_seq* decls() const { return second ? second : load_decls(this); }
   
   Path path_;
   Name* first;
@@ -1104,6 +1111,41 @@ struct Using : Decl, Kind_of<using_decl> {
 template<typename T, typename... Args>
   T* make_expr(const Location&, Type*, Args&&...);
 
+// -------------------------------------------------------------------------- //
+// Canonical types
+//
+// A type whose identity is determined entirely by its operands (e.g.,
+// a bitfield or function type) is canonical: make_expr returns the
+// same node for every construction of that type with the same operands.
+// Builtin type operands are identified by their kind, and integer and
+// boolean operands by their values.
+//
+// Note that the canonical node keeps the location of the first
+// construction of the type. It has no definition, since any number of
+// definitions can name it; the name of an alias is that of its Def.
+
+template<typename T>
+  struct Is_canonical_type : std::false_type { };
+
+template<> struct Is_canonical_type<Fn_type> : std::true_type { };
+template<> struct Is_canonical_type<Range_type> : std::true_type { };
+template<> struct Is_canonical_type<Bitfield_type> : std::true_type { };
+template<> struct Is_canonical_type<Net_str_type> : std::true_type { };
+template<> struct Is_canonical_type<Net_seq_type> : std::true_type { };
+
+bool is_canonical_type(Type*);
+Type* find_type(Type*);
+Type* intern_type(Type*);
+void forget_types(const Arena&);
+
+// Statistics about the canonical type table.
+struct Type_table_stats {
+  std::size_t lookups; // Constructions of canonical types
+  std::size_t types;   // Distinct canonical types
+};
+
+Type_table_stats type_table_stats();
+
 // -------------------------------------------------------------------------- //
 // Queries
 
@@ -6,12 +6,32 @@ namespace steve {
 
 template<typename T, typename... Args>
   inline T* 
-  make_expr(const Location& l, Type* t, Args&&... args) {
+  make_expr(std::false_type, const Location& l, Type* t, Args&&... args) {
     T* r = new T(l, std::forward<Args>(args)...);
     r->type_ = t;
     return r;
   }
 
+// Return the canonical type with the given operands, creating it if
+// needed. The lookup is done with a temporary node so that nothing
+// is allocated for a type that already exists.
+template<typename T, typename... Args>
+  inline T* 
+  make_expr(std::true_type, const Location& l, Type* t, Args&&... args) {
+    T probe(l, args...);
+    if (Type* r = find_type(&probe))
+      return static_cast<T*>(r);
+    T* r = new T(l, std::forward<Args>(args)...);
+    r->type_ = t;
+    return static_cast<T*>(intern_type(r));
+  }
+
+template<typename T, typename... Args>
+  inline T* 
+  make_expr(const Location& l, Type* t, Args&&... args) {
+    return make_expr<T>(Is_canonical_type<T>(), l, t, std::forward<Args>(args)...);
+  }
+
 
 // -------------------------------------------------------------------------- //
 // Streaming
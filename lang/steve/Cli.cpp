@@ -6,11 +6,25 @@
 #include <steve/Extract.hpp>
 #include <steve/Module.hpp>
 #include <steve/String.hpp>
+#include <steve/Task.hpp>
 
 #include <cctype>
+#include <cerrno>
+#include <cstdlib>
 #include <cstring>
 #include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <mutex>
+#include <set>
+#include <sstream>
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 namespace steve {
 namespace cli {
@@ -132,7 +146,7 @@ Version_command::operator()(int arg, int argc, char** argv) {
     return false;
   }
 
-  std::cout << "Steve Programming Language v0.1\n";
+  std::cout << format("Steve Programming Language v{}\n", steve_version);
   std::cout << "Copyright (c) 2013-2015 Flowgrammable.org\n";
   return true; 
 }
@@ -162,6 +176,9 @@ Extract_command::operator()(int arg, int argc, char** argv) {
   std::string what = argv[arg++];
   std::string from = argv[arg++];
 
+  // Documentation is extracted from comments.
+  config().capture_comments = true;
+
   // Load the name.
   Expr* e = load_name(from);
   if (not e) {
@@ -191,8 +208,8 @@ Extract_command::operator()(int arg, int argc, char** argv) {
 //
 // TODO: Maybe rename this to 'dump' command... or define several?
 //
-// TODO: Allow multiple inputs? Maybe, but we need to fork() to
-// do that. Otherwise, we end up building a single input module.
+// Multiple inputs are checked by the batch command, which loads each
+// input in its own process.
 bool
 Test_command::operator()(int arg, int argc, char** argv) {
   Diagnostics diags;
@@ -217,5 +234,775 @@ Test_command::operator()(int arg, int argc, char** argv) {
   return mod ? true : false; 
 }
 
+
+// -------------------------------------------------------------------------- //
+// Batch command
+//
+// The batch command checks each Steve file in its inputs. For example:
+//
+//    steve batch tests lib
+//
+// checks every Steve file under the tests and lib directories. Files
+// are checked by a pool of threads (see Task_pool), one per job in the
+// configuration. Each thread loads its file in a child process, so that
+// files do not share modules, and collects the output of that process.
+// Outputs are written whole, in the order the files were given.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Msec = std::chrono::duration<double, std::milli>;
+
+// The result of checking a file.
+struct Batch_result {
+  std::string file;   // The file being checked
+  std::string output; // The diagnostics written while checking
+  bool done = false;  // True when the check has finished
+  bool ok = false;    // True if the file was loaded
+  double msec = 0;    // The time taken to check the file
+};
+
+// The state of a batch. A child process inherits the locks held by
+// the threads of its parent, so processes are only created while
+// holding the lock that guards output.
+struct Batch {
+  std::vector<Batch_result> results;
+  std::mutex mutex;         // Guards output and process creation
+  std::size_t written = 0;  // The number of results written
+};
+
+// Append the Steve files named by arg to files. Directories are
+// searched recursively.
+bool
+find_batch_files(const char* arg, std::vector<std::string>& files) {
+  Path p = arg;
+  if (fs::is_directory(p)) {
+    std::vector<std::string> found;
+    for (fs::recursive_directory_iterator i(p), end; i != end; ++i)
+      if (fs::is_regular_file(i->path()) and i->path().extension() == ".steve")
+        found.push_back(i->path().string());
+    std::sort(found.begin(), found.end());
+    files.insert(files.end(), found.begin(), found.end());
+    return true;
+  }
+  if (fs::exists(p)) {
+    files.push_back(arg);
+    return true;
+  }
+  error(no_location) << format("no such file or directory '{}'", arg);
+  return false;
+}
+
+// Load the file and all of its declarations, writing diagnostics to
+// the standard error. Returns the exit status of the process.
+int
+check_file(const std::string& file) {
+  Diagnostics diags;
+  Diagnostics_guard dg = diags;
+  Module* mod = load_file(file);
+  bool ok = mod and mod->decls();
+  std::cerr << diags;
+  return ok ? 0 : 1;
+}
+
+// Read from the descriptor fd until the end of file, appending the
+// data to s. Returns false if an error occurs.
+bool
+read_all(int fd, std::string& s) {
+  char buf[4096];
+  while (true) {
+    ssize_t n = ::read(fd, buf, sizeof(buf));
+    if (n > 0)
+      s.append(buf, n);
+    else if (n == 0)
+      return true;
+    else if (errno != EINTR)
+      return false;
+  }
+}
+
+// Record that the i-th file has been checked, and write the outputs
+// of the files that have been checked, up to the first that has not.
+void
+finish_batch_file(Batch& b, std::size_t i, bool ok, double msec) {
+  std::lock_guard<std::mutex> lock(b.mutex);
+  Batch_result& r = b.results[i];
+  r.done = true;
+  r.ok = ok;
+  r.msec = msec;
+  while (b.written < b.results.size() and b.results[b.written].done) {
+    Batch_result& w = b.results[b.written++];
+    if (not w.output.empty())
+      std::cerr << format("-- {}\n", w.file) << w.output;
+  }
+  std::cerr.flush();
+}
+
+// Check the i-th file in a child process. The standard output and
+// error of the child are read from a pipe.
+void
+run_batch_file(Batch& b, std::size_t i) {
+  Batch_result& r = b.results[i];
+  Clock::time_point start = Clock::now();
+  int fds[2];
+  pid_t pid = -1;
+  {
+    std::lock_guard<std::mutex> lock(b.mutex);
+    if (::pipe(fds) == 0) {
+      pid = ::fork();
+      if (pid == 0) {
+        ::close(fds[0]);
+        ::dup2(fds[1], 1);
+        ::dup2(fds[1], 2);
+        ::close(fds[1]);
+        config().jobs = 1;
+        int status = check_file(r.file);
+        std::cout.flush();
+        std::cerr.flush();
+        ::_exit(status);
+      }
+      ::close(fds[1]);
+      if (pid < 0)
+        ::close(fds[0]);
+    }
+  }
+  if (pid < 0) {
+    r.output = format("error: cannot check '{}': {}\n", r.file, std::strerror(errno));
+    finish_batch_file(b, i, false, 0);
+    return;
+  }
+
+  read_all(fds[0], r.output);
+  ::close(fds[0]);
+
+  int status = 0;
+  while (::waitpid(pid, &status, 0) < 0 and errno == EINTR)
+    ;
+  if (WIFSIGNALED(status))
+    r.output += format("error: checking '{}' was terminated by signal {}\n",
+                       r.file, WTERMSIG(status));
+  bool ok = WIFEXITED(status) and WEXITSTATUS(status) == 0;
+  finish_batch_file(b, i, ok, Msec(Clock::now() - start).count());
+}
+
+// Write the time taken to check each file, slowest first.
+void
+write_batch_summary(const Batch& b, double msec) {
+  std::vector<const Batch_result*> rs;
+  std::size_t failed = 0;
+  for (const Batch_result& r : b.results) {
+    rs.push_back(&r);
+    if (not r.ok)
+      ++failed;
+  }
+  std::stable_sort(rs.begin(), rs.end(), [](const Batch_result* x, const Batch_result* y) {
+    return x->msec > y->msec;
+  });
+  for (const Batch_result* r : rs)
+    std::cout << format("{:10.2f} ms  {:6}  {}\n", r->msec, r->ok ? "ok" : "failed", r->file);
+  std::cout << format("{} files, {} failed, {:.2f} ms with {} jobs\n",
+                      b.results.size(), failed, msec, config().jobs);
+}
+
+} // namespace
+
+bool
+Batch_command::operator()(int arg, int argc, char** argv) {
+  if (arg == argc) {
+    error(no_location) << "no input files\n";
+    return false;
+  }
+  std::vector<std::string> files;
+  bool found = true;
+  for (; arg != argc; ++arg)
+    if (not find_batch_files(argv[arg], files))
+      found = false;
+  if (not found)
+    return false;
+
+  Batch b;
+  b.results.resize(files.size());
+  for (std::size_t i = 0; i < files.size(); ++i)
+    b.results[i].file = files[i];
+
+  // Each thread runs the newest task in its queue first, so files are
+  // submitted in reverse order to be checked roughly in order.
+  std::cout.flush();
+  Clock::time_point start = Clock::now();
+  {
+    Task_pool pool(config().jobs);
+    for (std::size_t i = files.size(); i != 0; --i)
+      pool.submit([&b, i]() { run_batch_file(b, i - 1); });
+    pool.wait();
+  }
+  write_batch_summary(b, Msec(Clock::now() - start).count());
+
+  for (const Batch_result& r : b.results)
+    if (not r.ok)
+      return false;
+  return true;
+}
+
+
+// -------------------------------------------------------------------------- //
+// Watch command
+//
+// The watch command checks each Steve file in its inputs, as the batch
+// command does, and then waits for changes. For example:
+//
+//    steve watch specs
+//
+// The inputs, the current directory, the module path, and the
+// directories of all loaded files are watched with inotify. Changes
+// arrive in bursts (e.g., an editor saving a file may write, rename,
+// and change its attributes), so they are collected until none has
+// been seen for a short delay, and then handled at once.
+//
+// Files are checked in this process, so modules, strings, and the
+// caches of the evaluator are kept between checks. After a change,
+// refresh_modules rebuilds the modules whose sources changed, and
+// their dependents (see Depend.hpp). Only the inputs whose modules
+// were rebuilt or forgotten, new inputs, and inputs that failed are
+// checked again. Forgotten modules are released, so when the modules
+// are forgotten, every input is checked again.
+
+namespace {
+
+// The time to wait for a burst of changes to end, in milliseconds.
+constexpr int watch_delay = 100;
+
+// The state of a watched input file.
+struct Watched_file {
+  Decl_seq* decls = nullptr; // The declarations when last checked
+  bool ok = false;           // True if the file was loaded
+};
+
+// The state of a watch.
+struct Watch {
+  int fd = -1;                              // The inotify instance
+  std::vector<std::string> inputs;          // The inputs, as given
+  std::set<Path> dirs;                      // The watched directories
+  std::map<std::string, Watched_file> files; // The files being checked
+  std::size_t generation = 0;               // The generation of the modules
+};
+
+// Returns the declarations of the module loaded from the given file,
+// or nullptr if no such module is loaded.
+Decl_seq*
+loaded_decls(const std::string& file) {
+  try {
+    if (Module* m = get_module(fs::canonical(file)))
+      return m->second;
+  } catch (std::exception&) { }
+  return nullptr;
+}
+
+// Watch the directory p, if it is not already watched.
+void
+watch_dir(Watch& w, const Path& p) {
+  if (p.empty() or w.dirs.count(p) or not fs::is_directory(p))
+    return;
+  const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM
+                      | IN_CREATE | IN_DELETE | IN_ATTRIB;
+  if (::inotify_add_watch(w.fd, p.c_str(), mask) < 0)
+    std::cerr << format("warning: cannot watch '{}': {}\n", p.string(), std::strerror(errno));
+  w.dirs.insert(p);
+}
+
+// Watch the directories that may contain files affecting a check.
+// Input directories are watched recursively, so that new files are
+// found.
+void
+update_watches(Watch& w) {
+  for (const std::string& in : w.inputs) {
+    Path p = in;
+    if (fs::is_directory(p)) {
+      watch_dir(w, p);
+      for (fs::recursive_directory_iterator i(p), end; i != end; ++i)
+        if (fs::is_directory(i->path()))
+          watch_dir(w, i->path());
+    } else {
+      watch_dir(w, fs::absolute(p).parent_path());
+    }
+  }
+  watch_dir(w, fs::current_path());
+  for (const Path& p : config().module_path)
+    watch_dir(w, p);
+  for (const Path& p : loaded_files())
+    watch_dir(w, p.parent_path());
+}
+
+// Read the pending events of the watch. Returns true if any of them
+// may affect a check: a change to a Steve file or to a directory.
+bool
+read_events(Watch& w) {
+  alignas(inotify_event) char buf[4096];
+  bool relevant = false;
+  while (true) {
+    ssize_t n = ::read(w.fd, buf, sizeof(buf));
+    if (n <= 0)
+      break;
+    for (char* p = buf; p < buf + n; ) {
+      inotify_event* e = reinterpret_cast<inotify_event*>(p);
+      if (e->len != 0) {
+        Path name = e->name;
+        if ((e->mask & IN_ISDIR) or name.extension() == ".steve")
+          relevant = true;
+      }
+      p += sizeof(inotify_event) + e->len;
+    }
+  }
+  return relevant;
+}
+
+// Wait for a change that may affect a check, and then for changes to
+// stop arriving. Returns false if the watch fails.
+bool
+wait_for_changes(Watch& w) {
+  bool changed = false;
+  while (true) {
+    pollfd p {w.fd, POLLIN, 0};
+    int n = ::poll(&p, 1, changed ? watch_delay : -1);
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      std::cerr << format("error: cannot wait for changes: {}\n", std::strerror(errno));
+      return false;
+    }
+    if (n == 0)
+      return true;
+    if (read_events(w))
+      changed = true;
+  }
+}
+
+// Check the inputs that may have changed, or every input if all is
+// true, and write their diagnostics and a summary.
+void
+check_watched_files(Watch& w, bool all) {
+  std::vector<std::string> found;
+  {
+    Suppression_guard sg;
+    for (const std::string& in : w.inputs)
+      find_batch_files(in.c_str(), found);
+  }
+  std::map<std::string, Watched_file> files;
+  for (const std::string& f : found) {
+    auto iter = w.files.find(f);
+    files.emplace(f, iter != w.files.end() ? iter->second : Watched_file());
+  }
+
+  Clock::time_point start = Clock::now();
+  std::size_t checked = 0;
+  std::size_t failed = 0;
+  for (auto& x : files) {
+    Watched_file& wf = x.second;
+    if (all or not wf.ok or loaded_decls(x.first) != wf.decls) {
+      std::cerr << format("-- {}\n", x.first);
+      wf.ok = check_file(x.first) == 0;
+      wf.decls = loaded_decls(x.first);
+      ++checked;
+    }
+    if (not wf.ok)
+      ++failed;
+  }
+  w.files = std::move(files);
+
+  std::cerr.flush();
+  std::cout << format("{} of {} files checked, {} failed, {:.2f} ms\n",
+                      checked, w.files.size(), failed, 
+                      Msec(Clock::now() - start).count());
+  std::cout.flush();
+}
+
+// An RAII helper that closes the inotify instance of a watch.
+struct Watch_guard {
+  ~Watch_guard() { 
+    if (w.fd >= 0) 
+      ::close(w.fd); 
+  }
+  Watch& w;
+};
+
+} // namespace
+
+bool
+Watch_command::operator()(int arg, int argc, char** argv) {
+  if (arg == argc) {
+    error(no_location) << "no input files\n";
+    return false;
+  }
+  Watch w;
+  bool found = true;
+  std::vector<std::string> files;
+  for (; arg != argc; ++arg) {
+    if (not find_batch_files(argv[arg], files))
+      found = false;
+    w.inputs.push_back(argv[arg]);
+  }
+  if (not found)
+    return false;
+
+  w.fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (w.fd < 0) {
+    error(no_location) << format("cannot watch for changes: {}", std::strerror(errno));
+    return false;
+  }
+  Watch_guard wg {w};
+
+  w.generation = module_generation();
+  check_watched_files(w, true);
+  update_watches(w);
+  while (wait_for_changes(w)) {
+    try {
+      refresh_modules();
+    } catch (std::exception& ex) {
+      std::cerr << format("error: {}\n", ex.what());
+    }
+    bool forgotten = w.generation != module_generation();
+    w.generation = module_generation();
+    check_watched_files(w, forgotten);
+    update_watches(w);
+  }
+  return false;
+}
+
+
+// -------------------------------------------------------------------------- //
+// Serve command
+//
+// A client sends a request to the server by writing the client's
+// working directory and its command line (without the program name),
+// each terminated by a null character, and then shutting down its end
+// of the connection. A request with no command line stops the server.
+//
+// The server runs one request at a time. It responds with a sequence of
+// frames, each a tag character, the size of the frame's data in four
+// bytes (least significant first), and the data. The tags are:
+//
+//    - 'o' -- the standard output of the command;
+//    - 'e' -- the standard error of the command;
+//    - 'x' -- the exit status of the command, in decimal.
+//
+// The server uses its own configuration (e.g., its module path), not
+// that of the client.
+//
+// Commands that manage the server itself, and commands that do not
+// return a single response (watch runs until interrupted, and batch
+// forks workers), are never run by the server.
+
+namespace {
+
+// Returns the name of the command in the command line, following the
+// steve-arguments, or nullptr if there is no command.
+const char*
+command_name(int argc, char** argv) {
+  for (int i = 1; i < argc; ++i) {
+    if (not is_option(argv[i][0]))
+      return argv[i];
+  }
+  return nullptr;
+}
+
+// Returns true if the named command must run in the client's process.
+bool
+is_local_command(const char* cmd) {
+  return std::strcmp(cmd, "serve") == 0
+      or std::strcmp(cmd, "watch") == 0
+      or std::strcmp(cmd, "batch") == 0;
+}
+
+// Initialize the socket address for path. Returns false if the path
+// is too long.
+bool
+make_address(const char* path, sockaddr_un& addr) {
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (std::strlen(path) >= sizeof(addr.sun_path))
+    return false;
+  std::strcpy(addr.sun_path, path);
+  return true;
+}
+
+// Returns a connection to the server on the socket at path, or -1 if
+// no server is running.
+int
+connect_server(const char* path) {
+  sockaddr_un addr;
+  if (not make_address(path, addr))
+    return -1;
+  int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0)
+    return -1;
+  if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// Write the n characters in p to the socket fd. Returns false if an
+// error occurs (e.g., the peer has closed its connection).
+bool
+send_all(int fd, const char* p, std::size_t n) {
+  while (n != 0) {
+    ssize_t k = ::send(fd, p, n, MSG_NOSIGNAL);
+    if (k < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    p += k;
+    n -= k;
+  }
+  return true;
+}
+
+inline bool
+send_all(int fd, const std::string& s) { return send_all(fd, s.data(), s.size()); }
+
+// Send a frame with the given tag and data.
+bool
+send_frame(int fd, char tag, const std::string& s) {
+  std::uint32_t n = s.size();
+  char head[5] = {tag, char(n), char(n >> 8), char(n >> 16), char(n >> 24)};
+  return send_all(fd, head, 5) and send_all(fd, s);
+}
+
+// Split s into its null-terminated parts.
+std::vector<std::string>
+split_request(const std::string& s) {
+  std::vector<std::string> parts;
+  std::size_t first = 0;
+  while (first < s.size()) {
+    std::size_t last = s.find('\0', first);
+    if (last == std::string::npos)
+      last = s.size();
+    parts.emplace_back(s, first, last - first);
+    first = last + 1;
+  }
+  return parts;
+}
+
+// An RAII helper that redirects the output of a stream to the buffer
+// of another.
+struct Redirect_guard {
+  Redirect_guard(std::ostream& s, std::ostream& to)
+    : stream(s), saved(s.rdbuf(to.rdbuf())) { }
+  ~Redirect_guard() { stream.rdbuf(saved); }
+
+  std::ostream& stream;
+  std::streambuf* saved;
+};
+
+// Run the command line in args in the directory dir, writing its
+// output to out and err. Modules whose sources have changed since the
+// previous request are forgotten first, and the configuration is
+// restored afterwards.
+int
+run_request(Serve_command::Runner run, const std::string& dir,
+            std::vector<char*>& args, std::ostream& out, std::ostream& err) {
+  Redirect_guard og(std::cout, out);
+  Redirect_guard eg(std::cerr, err);
+  Path home = fs::current_path();
+  if (::chdir(dir.c_str()) < 0) {
+    err << format("error: cannot change to directory '{}': {}\n", dir, std::strerror(errno));
+    return -1;
+  }
+
+  bool comments = config().capture_comments;
+  int status;
+  try {
+    refresh_modules();
+    status = run(args.size() - 1, args.data());
+  } catch (std::exception& ex) {
+    err << format("error: {}\n", ex.what());
+    status = -1;
+  }
+  config().capture_comments = comments;
+
+  ::chdir(home.c_str());
+  return status;
+}
+
+// Serve the request of the client c. Returns false if the server
+// should stop.
+bool
+serve_request(Serve_command::Runner run, int c) {
+  std::string req;
+  if (not read_all(c, req))
+    return true;
+  std::vector<std::string> parts = split_request(req);
+  if (parts.empty())
+    return true;
+  if (parts.size() == 1) {
+    send_frame(c, 'x', "0");
+    return false;
+  }
+
+  std::string name = "steve";
+  std::vector<char*> args {&name[0]};
+  for (std::size_t i = 1; i < parts.size(); ++i)
+    args.push_back(&parts[i][0]);
+  args.push_back(nullptr);
+
+  const char* cmd = command_name(args.size() - 1, args.data());
+  if (cmd and is_local_command(cmd)) {
+    send_frame(c, 'e', format("error: the server cannot run '{}'\n", cmd));
+    send_frame(c, 'x', "-1");
+    return true;
+  }
+
+  std::stringstream out;
+  std::stringstream err;
+  int status = run_request(run, parts[0], args, out, err);
+  send_frame(c, 'o', out.str()) 
+    and send_frame(c, 'e', err.str()) 
+    and send_frame(c, 'x', std::to_string(status));
+  return true;
+}
+
+// Serve requests on the socket at path until stopped.
+bool
+run_server(Serve_command::Runner run, const char* path) {
+  sockaddr_un addr;
+  if (not make_address(path, addr)) {
+    error(no_location) << format("socket path '{}' is too long", path);
+    return false;
+  }
+
+  // Replace the socket of a server that is no longer running.
+  int probe = connect_server(path);
+  if (probe >= 0) {
+    ::close(probe);
+    error(no_location) << format("a server is already running on '{}'", path);
+    return false;
+  }
+  ::unlink(path);
+
+  int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0 
+      or ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0
+      or ::listen(fd, 16) < 0) {
+    error(no_location) << format("cannot serve on '{}': {}", path, std::strerror(errno));
+    if (fd >= 0)
+      ::close(fd);
+    return false;
+  }
+
+  bool serving = true;
+  while (serving) {
+    int c = ::accept4(fd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (c < 0) {
+      if (errno == EINTR)
+        continue;
+      error(no_location) << format("cannot accept a request: {}", std::strerror(errno));
+      break;
+    }
+    serving = serve_request(run, c);
+    ::close(c);
+  }
+  ::close(fd);
+  ::unlink(path);
+  return serving == false;
+}
+
+// Ask the server on the socket at path to stop.
+bool
+stop_server(const char* path) {
+  int fd = connect_server(path);
+  if (fd < 0) {
+    error(no_location) << format("no server is running on '{}'", path);
+    return false;
+  }
+  std::string req = fs::current_path().string();
+  req += '\0';
+  std::string resp;
+  bool ok = send_all(fd, req) and ::shutdown(fd, SHUT_WR) == 0 and read_all(fd, resp);
+  ::close(fd);
+  return ok;
+}
+
+} // namespace
+
+Serve_command::Serve_command(Runner r)
+  : run(r)
+{
+  parms = {
+    {"stop", {"stop", Value(false), "stop the server"}}
+  };
+}
+
+bool
+Serve_command::operator()(int arg, int argc, char** argv) {
+  Parser parse(parms, args);
+  arg = parse(arg, argc, argv);
+  if (arg < 0)
+    return false;
+  const char* path = arg != argc ? argv[arg] : std::getenv("STEVE_SERVER");
+  if (not path) {
+    error(no_location) << "no server socket given";
+    return false;
+  }
+  if (args.count("stop"))
+    return stop_server(path);
+  return run_server(run, path);
+}
+
+// Forward the command line to the server named by STEVE_SERVER and
+// write its response. Returns false if there is no such server, in
+// which case the command should be run locally. Commands that the
+// server cannot run are never forwarded.
+bool
+forward_command(int argc, char** argv, int& status) {
+  const char* path = std::getenv("STEVE_SERVER");
+  if (not path)
+    return false;
+  const char* cmd = command_name(argc, argv);
+  if (not cmd or is_local_command(cmd))
+    return false;
+  int fd = connect_server(path);
+  if (fd < 0)
+    return false;
+
+  std::string req = fs::current_path().string();
+  req += '\0';
+  for (int i = 1; i < argc; ++i) {
+    req += argv[i];
+    req += '\0';
+  }
+  std::string resp;
+  bool ok = send_all(fd, req) and ::shutdown(fd, SHUT_WR) == 0 and read_all(fd, resp);
+  ::close(fd);
+
+  // Write the output of the command as it was sent.
+  bool done = false;
+  std::size_t i = 0;
+  while (ok and i + 5 <= resp.size()) {
+    char tag = resp[i];
+    std::uint32_t n = 0;
+    for (int k = 4; k != 0; --k)
+      n = (n << 8) | static_cast<unsigned char>(resp[i + k]);
+    i += 5;
+    if (i + n > resp.size())
+      break;
+    std::string data(resp, i, n);
+    i += n;
+    if (tag == 'o')
+      std::cout << data;
+    else if (tag == 'e')
+      std::cerr << data;
+    else if (tag == 'x') {
+      status = std::atoi(data.c_str());
+      done = true;
+    }
+  }
+  if (not done) {
+    std::cerr << format("error: lost connection to the server on '{}'\n", path);
+    status = -1;
+  }
+  return true;
+}
+
 } // namespace cli
 } // namespace steve
@@ -119,6 +119,51 @@ struct Test_command : Command {
   bool operator()(int, int, char**);
 };
 
+// The batch command checks many inputs in parallel. Each input is a
+// Steve file or a directory containing Steve files. The diagnostics of
+// each file are written together, followed by a summary of the time
+// taken to check each file.
+struct Batch_command : Command {
+  bool operator()(int, int, char**);
+};
+
+// The watch command checks each Steve file in its inputs, and checks
+// them again when their sources, or the sources of the modules they
+// import, change. It runs until it is interrupted.
+//
+//    steve watch <dir>...
+struct Watch_command : Command {
+  bool operator()(int, int, char**);
+};
+
+// The serve command runs a compile server on a local socket. The server
+// keeps loaded modules, interned strings, and the caches of the
+// evaluator between requests. Each request is an ordinary command line,
+// forwarded by a client (see forward_command), and is run as if by a
+// new process.
+//
+// Requests are run in the server's own process, so a request that
+// crashes it (e.g., an evaluation that overflows the stack) takes all
+// of that state with it. The client reports a lost connection, and the
+// server must be started again.
+//
+//    steve serve [--stop] [<socket>]
+//
+// The socket defaults to the value of STEVE_SERVER.
+struct Serve_command : Command {
+  using Runner = int (*)(int, char**);
+
+  explicit Serve_command(Runner);
+
+  bool operator()(int, int, char**);
+
+  Runner run; // Runs a command line in this process
+};
+
+// If STEVE_SERVER names the socket of a running server, forward the
+// command line to that server and save its exit status.
+bool forward_command(int, char**, int&);
+
 
 } // namespace cli
 } // namespace steve
@@ -0,0 +1,396 @@
+
+#include <steve/Closure.hpp>
+#include <steve/Ast.hpp>
+#include <steve/Type.hpp>
+#include <steve/Intrinsic.hpp>
+#include <steve/Evaluator.hpp>
+#include <steve/Debug.hpp>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace steve {
+
+namespace {
+
+// -------------------------------------------------------------------------- //
+// Lowering context
+
+// The lowering context maps the parameters of the function being
+// lowered to their slots in the argument array.
+struct Lowering {
+  Lowering(Fn*);
+
+  Fn* fn;
+  std::unordered_map<Decl*, std::size_t> slots;
+};
+
+Lowering::Lowering(Fn* f)
+  : fn(f)
+{
+  std::size_t n = 0;
+  for (Decl* p : *f->parms())
+    slots.insert({p, n++});
+}
+
+using Code_seq = std::vector<Code>;
+
+Code lower(Lowering&, Expr*);
+
+// Lower each expression in s, returning false if any cannot be
+// lowered.
+template<typename T>
+  bool
+  lower_seq(Lowering& cxt, Seq<T>* s, Code_seq& codes) {
+    for (T* e : *s) {
+      Code c = lower(cxt, e);
+      if (not c)
+        return false;
+      codes.push_back(std::move(c));
+    }
+    return true;
+  }
+
+// Run each code in args, storing their values in vals.
+inline bool
+run_args(const Code_seq& args, const Value* frame, Value_seq& vals) {
+  vals.reserve(args.size());
+  for (const Code& a : args) {
+    Value v = unit;
+    if (not a(frame, v))
+      return false;
+    vals.push_back(std::move(v));
+  }
+  return true;
+}
+
+
+// -------------------------------------------------------------------------- //
+// Lowering rules
+
+// A value that does not depend on the parameters is computed once.
+Code
+lower_value(Value v) {
+  return [v](const Value*, Value& r) { r = v; return true; };
+}
+
+// A reference to a parameter loads its slot. A reference to a
+// definition is replaced by the definition's value, if it has one.
+Code
+lower_decl_id(Lowering& cxt, Decl_id* e) {
+  Decl* d = e->decl();
+  if (is<Parm>(d)) {
+    auto iter = cxt.slots.find(d);
+    if (iter == cxt.slots.end())
+      return nullptr;
+    std::size_t n = iter->second;
+    return [n](const Value* frame, Value& r) { r = frame[n]; return true; };
+  }
+  if (Def* def = as<Def>(d)) {
+    Eval v = eval(def->init());
+    if (is_value(v))
+      return lower_value(v.as_value());
+  }
+  return nullptr;
+}
+
+// A call to a known function. The function is compiled on its first
+// call, and the closure is saved in the call site.
+struct Callee {
+  explicit Callee(Fn* f) : fn(f), closure(nullptr) { }
+
+  Fn* fn;
+  std::atomic<const Closure*> closure;
+};
+
+Code
+lower_fn_call(Fn* fn, Code_seq&& args) {
+  std::shared_ptr<Callee> callee = std::make_shared<Callee>(fn);
+  return [callee, args](const Value* frame, Value& r) {
+    Value_seq vals;
+    if (not run_args(args, frame, vals))
+      return false;
+    const Closure* c = callee->closure.load(std::memory_order_acquire);
+    if (not c) {
+      c = get_closure(callee->fn);
+      callee->closure.store(c, std::memory_order_release);
+    }
+    if (not c->code or vals.size() != c->arity)
+      return false;
+    return c->code(vals.data(), r);
+  };
+}
+
+// A call to a function computed from the parameters.
+Code
+lower_indirect_call(Code&& tgt, Code_seq&& args) {
+  return [tgt, args](const Value* frame, Value& r) {
+    Value f = unit;
+    if (not tgt(frame, f) or not is_function(f))
+      return false;
+    Value_seq vals;
+    if (not run_args(args, frame, vals))
+      return false;
+    return eval_closure(f.as_function(), vals, r);
+  };
+}
+
+// Apply a builtin function that has no value-level implementation
+// by building its argument expressions.
+bool
+apply_builtin(Builtin* b, const Value_seq& vals, Value& r) {
+  Fn_type* ft = as<Fn_type>(b->type_);
+  Expr_seq args;
+  for (std::size_t i = 0; i < vals.size(); ++i)
+    args.push_back(to_expr(Eval(vals[i]), (*ft->parms())[i]));
+  Expr* e;
+  switch (b->arity()) {
+  case 1: e = b->fn().f1(args[0]); break;
+  case 2: e = b->fn().f2(args[0], args[1]); break;
+  case 3: e = b->fn().f3(args[0], args[1], args[2]); break;
+  default: return false;
+  }
+  Eval v = eval(e);
+  if (is_partial(v))
+    return false;
+  r = v.as_value();
+  return true;
+}
+
+Code
+lower_builtin_call(Builtin* b, Code_seq&& args) {
+  if (args.size() != std::size_t(b->arity()))
+    return nullptr;
+
+  // The logical operators do not evaluate their second operand
+  // unless it is needed.
+  if (is_builtin_and(b) or is_builtin_or(b)) {
+    bool stop = is_builtin_or(b);
+    return [stop, args](const Value* frame, Value& r) {
+      if (not args[0](frame, r))
+        return false;
+      if (r.as_bool() == stop)
+        return true;
+      return args[1](frame, r);
+    };
+  }
+
+  if (Value_op op = get_value_op(b)) {
+    return [op, args](const Value* frame, Value& r) {
+      Value_seq vals;
+      if (not run_args(args, frame, vals))
+        return false;
+      r = op(vals.data());
+      return true;
+    };
+  }
+
+  return [b, args](const Value* frame, Value& r) {
+    Value_seq vals;
+    if (not run_args(args, frame, vals))
+      return false;
+    return apply_builtin(b, vals, r);
+  };
+}
+
+// Returns the function or builtin that a call target refers to, if
+// it is known without evaluation.
+Term*
+get_known_target(Expr* e) {
+  if (Decl_id* id = as<Decl_id>(e))
+    if (Def* def = as<Def>(id->decl()))
+      e = def->init();
+  if (is<Fn>(e) or is<Builtin>(e))
+    return as<Term>(e);
+  return nullptr;
+}
+
+template<typename S>
+  Code
+  lower_call(Lowering& cxt, Expr* tgt, S* s) {
+    Code_seq args;
+    if (not lower_seq(cxt, s, args))
+      return nullptr;
+    if (Term* t = get_known_target(tgt)) {
+      if (Fn* fn = as<Fn>(t))
+        return lower_fn_call(fn, std::move(args));
+      return lower_builtin_call(as<Builtin>(t), std::move(args));
+    }
+    Code f = lower(cxt, tgt);
+    if (not f)
+      return nullptr;
+    return lower_indirect_call(std::move(f), std::move(args));
+  }
+
+Code
+lower_binary(Lowering& cxt, Binary* e) {
+  Expr_seq args {e->left(), e->right()};
+  return lower_call(cxt, e->fn(), &args);
+}
+
+// A promotion that does not fit in its type is left to the partial
+// evaluator, which diagnoses it.
+Code
+lower_promo(Lowering& cxt, Promo* e) {
+  Code c = lower(cxt, e->expr());
+  if (not c)
+    return nullptr;
+  Integer size = size_in_bits(e->type());
+  return [c, size](const Value* frame, Value& r) {
+    if (not c(frame, r))
+      return false;
+    return r.as_integer().bits() <= size;
+  };
+}
+
+Code
+lower_pred(Lowering& cxt, Pred* e) {
+  Code c = lower(cxt, e->expr());
+  if (not c)
+    return nullptr;
+  return [c](const Value* frame, Value& r) {
+    if (not c(frame, r))
+      return false;
+    if (is_integer(r))
+      r = r.as_integer() != 0;
+    return is_bool(r);
+  };
+}
+
+Code
+lower_if(Lowering& cxt, If* e) {
+  Code c = lower(cxt, e->cond());
+  Code t = lower(cxt, e->pass());
+  Code f = lower(cxt, e->fail());
+  if (not c or not t or not f)
+    return nullptr;
+  return [c, t, f](const Value* frame, Value& r) {
+    if (not c(frame, r))
+      return false;
+    return r.as_bool() ? t(frame, r) : f(frame, r);
+  };
+}
+
+// A block evaluates its statements up to and including the first
+// return statement.
+Code
+lower_block(Lowering& cxt, Block* e) {
+  Code_seq stmts;
+  for (Stmt* s : *e->stmts()) {
+    Code c = lower(cxt, s);
+    if (not c)
+      return nullptr;
+    stmts.push_back(std::move(c));
+    if (is<Return>(s))
+      break;
+  }
+  return [stmts](const Value* frame, Value& r) {
+    r = unit;
+    for (const Code& s : stmts)
+      if (not s(frame, r))
+        return false;
+    return true;
+  };
+}
+
+// Types are values, except for dependent types, which are computed
+// by calling their type constructor.
+Code
+lower_type(Lowering& cxt, Type* t) {
+  if (Dep_type* d = as<Dep_type>(t))
+    return lower_call(cxt, d->fn(), d->args());
+  if (is<Dep_variant_type>(t))
+    return nullptr;
+  return lower_value(t);
+}
+
+Code
+lower(Lowering& cxt, Expr* e) {
+  if (Type* t = as<Type>(e))
+    return lower_type(cxt, t);
+
+  switch (e->kind) {
+  // Names
+  case decl_id: return lower_decl_id(cxt, as<Decl_id>(e));
+  // Terms
+  case unit_term: return lower_value(unit);
+  case bool_term: return lower_value(as<Bool>(e)->value());
+  case int_term: return lower_value(as<Int>(e)->value());
+  // Misc terms
+  case fn_term: return lower_value(as<Fn>(e));
+  case call_term: return lower_call(cxt, as<Call>(e)->fn(), as<Call>(e)->args());
+  case promo_term: return lower_promo(cxt, as<Promo>(e));
+  case pred_term: return lower_pred(cxt, as<Pred>(e));
+  case binary_term: return lower_binary(cxt, as<Binary>(e));
+  case if_term: return lower_if(cxt, as<If>(e));
+  // Statements
+  case block_stmt: return lower_block(cxt, as<Block>(e));
+  case return_stmt: return lower(cxt, as<Return>(e)->value());
+  default: break;
+  }
+  return nullptr;
+}
+
+
+// -------------------------------------------------------------------------- //
+// Closure table
+
+// The closure table is shared by all threads. A function is never
+// lowered while the table is locked, since lowering may evaluate
+// other definitions. If two threads lower the same function, the
+// first closure is kept.
+struct Closure_table {
+  std::mutex mutex;
+  std::unordered_map<Fn*, std::unique_ptr<Closure>> closures;
+};
+
+Closure_table&
+closure_table() {
+  static Closure_table tab;
+  return tab;
+}
+
+} // namespace
+
+// Returns the compiled form of f, lowering it if needed.
+const Closure*
+get_closure(Fn* f) {
+  Closure_table& tab = closure_table();
+  {
+    std::lock_guard<std::mutex> lock(tab.mutex);
+    auto iter = tab.closures.find(f);
+    if (iter != tab.closures.end())
+      return iter->second.get();
+  }
+
+  Lowering cxt(f);
+  std::unique_ptr<Closure> c(new Closure{f->parms()->size(), lower(cxt, f->body())});
+
+  std::lock_guard<std::mutex> lock(tab.mutex);
+  auto ins = tab.closures.emplace(f, std::move(c));
+  return ins.first->second.get();
+}
+
+// Discard every compiled function. This is done when the functions
+// are released.
+void
+clear_closures() {
+  Closure_table& tab = closure_table();
+  std::lock_guard<std::mutex> lock(tab.mutex);
+  tab.closures.clear();
+}
+
+// Evaluate the call of f with the given arguments, storing the value
+// of the call in r. Returns false if the call cannot be evaluated by
+// compiled code.
+bool
+eval_closure(Fn* f, const Value_seq& args, Value& r) {
+  const Closure* c = get_closure(f);
+  if (not c->code or args.size() != c->arity)
+    return false;
+  return c->code(args.data(), r);
+}
+
+} // namespace steve
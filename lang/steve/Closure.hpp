@@ -0,0 +1,40 @@
+
+#ifndef STEVE_CLOSURE_HPP
+#define STEVE_CLOSURE_HPP
+
+#include <steve/Value.hpp>
+
+#include <functional>
+
+// This module defines the compiled evaluation engine. A function is
+// lowered, once, into a tree of closures that refer to its parameters
+// by slot, and the tree is run directly over values. No expressions
+// are allocated while evaluating a compiled function.
+//
+// Compiled evaluation only computes values. When a function cannot be
+// lowered (e.g., it constructs a dependent variant), or when a call
+// does not produce a value (e.g., a promotion overflows), evaluation
+// fails and the caller falls back to the partial evaluator.
+
+namespace steve {
+
+// Compiled code. Running the code with the argument values of its
+// function stores the result in the given value, returning false
+// if no value can be computed.
+using Code = std::function<bool(const Value*, Value&)>;
+
+// A compiled function. If the function could not be lowered, its
+// code is empty.
+struct Closure {
+  std::size_t arity;
+  Code code;
+};
+
+const Closure* get_closure(Fn*);
+void clear_closures();
+
+bool eval_closure(Fn*, const Value_seq&, Value&);
+
+} // namespace steve
+
+#endif
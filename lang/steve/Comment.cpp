@@ -1,6 +1,7 @@
-
 #include <steve/Comment.hpp>
+#include <steve/File.hpp>
 
+#include <algorithm>
 #include <sstream>
 
 namespace steve {
@@ -10,12 +11,6 @@ namespace {
 // The global comment manager.
 Comment_manager cm_;
 
-// Remove the terminator from the comment block, if present.
-void strip(Comment_block& b) {
-  if (b.last_location() == no_location)
-    b.pop_back();
-}
-
 } // namespace
 
 
@@ -30,52 +25,56 @@ Comment_block::text() const {
   return ss.str();
 }
 
-// Initialize
+// Save the comment. The comment is added to the last block if that
+// block is still open and the comment is on the next line, in the same
+// column. Otherwise, the comment starts a new block.
 void
-Comment_manager::init(const Location& loc, String text) {
-    blocks.emplace_back();
-    append(loc, text);
+Comment_manager::save(const Location& loc, String text) {
+  File* f = loc.file();
+  Source_position p = f->position(loc.offset());
+  Comment_block_list& bs = files_[f];
+  if (open_ and last_ == &bs) {
+    Comment_block& b = bs.back();
+    if (b.col == p.col and b.last_line() + 1 == p.line) {
+      b.emplace_back(loc, text);
+      return;
+    }
+  }
+  bs.emplace_back(p.line, p.col);
+  bs.back().emplace_back(loc, text);
+  last_ = &bs;
+  open_ = true;
 }
 
+// Close the last comment block. The next comment will start a new
+// block, even if it is adjacent to the last.
 void
-Comment_manager::append(const Location& loc, String text) {
-  blocks.back().emplace_back(loc, text);
-}
+Comment_manager::reset() { open_ = false; }
 
+// Discard the comments saved for the file f.
 void
-Comment_manager::save(const Location& loc, String text) {
-  // If there are not yet any blocks, create the first one and
-  // add the comment to that.
-  if (blocks.empty())
-    init(loc, text);
-
-  // Determine if the comment belongs to the current block
-  // or if we should create a new block. Note that the current
-  // block is never empty.
-  Comment_block& block = blocks.back();
-  if (adjacent(block.last_location(), loc)) {
-    append(loc, text);
-  }
-  else {
-    strip(block);
-    init(loc, text);
-  }
+Comment_manager::clear(File* f) {
+  auto iter = files_.find(f);
+  if (iter == files_.end())
+    return;
+  if (last_ == &iter->second)
+    last_ = nullptr;
+  files_.erase(iter);
 }
 
-// Add a terminator to the last comment (if present). This will
-// force the next 
-void
-Comment_manager::reset() {
-  if (blocks.empty())
-    return;
-  Comment_block& b = blocks.back();
-  if (b.last_location() != no_location)
-    save(no_location, String());
+// Returns the comment blocks of the file f, or nullptr if no comments
+// have been saved for that file.
+const Comment_block_list*
+Comment_manager::blocks(File* f) const {
+  auto iter = files_.find(f);
+  if (iter != files_.end())
+    return &iter->second;
+  return nullptr;
 }
 
-// Returns true if the comment block appertains to the entity
-// at the given location. A comment appertains to a declaration
-// if they are in the same file, and
+// Find the comment block that appertains to the entity at the given
+// location. A comment appertains to a declaration if they are in the
+// same file, and
 //
 //    1. the declaration appears on the same line as the beginning
 //       of the comment block, or
@@ -97,34 +96,26 @@ Comment_manager::reset() {
 //    // appertains to f because of rule 3.
 //    { return x; }
 //  
+// Blocks within a file do not overlap and are sorted by line, so the
+// block can be found by binary search.
+//
 // TODO: Re-think rule 3 for cases where the declaration spans multiple
 // lines and allow the column to be indented.
 //
-// TOOD: Implement rule 3.
-bool
-appertains(const Comment_block& b, const Location& l) {
-  if (b.file() != l.file)
-    return false;
-  if (above(b.last_location(), l))
-    return true;
-  else
-    return false;
-}
-
-// Find the nearest comment block associated with a location.
-//
-// TODO: This is wildly inefficient. We should be mapping comments
-// by file and we should have a data structure that optimizes
-// location-based lookup.
+// TODO: Implement rules 1 and 3.
 Comment_block*
 Comment_manager::find(const Location& loc) {
-  for (Comment_block& b : blocks) {
-    if (appertains(b, loc))
-      return &b;
-  }
+  File* f = loc.file();
+  auto iter = files_.find(f);
+  if (iter == files_.end())
+    return nullptr;
+  Comment_block_list& bs = iter->second;
+  int line = loc.line();
+  auto b = std::lower_bound(bs.begin(), bs.end(), line - 1, 
+    [](const Comment_block& b, int n) { return b.last_line() < n; });
+  if (b != bs.end() and b->last_line() == line - 1)
+    return &*b;
   return nullptr;
 }
 
 } // namespace steve
-
-
@@ -4,20 +4,22 @@
 
 #include <steve/Token.hpp>
 
+#include <unordered_map>
 #include <vector>
 
 namespace steve {
 
 // A comment is token that documents some aspect of a program. 
-// Comments are reprensented as tokens, having a source location
-// and associated text.
+// Comments have a source location and associated text. Note that
+// comments are not stored in the token stream.
 struct Comment {
   Comment(const Location&, String);
 
   String text() const;
   const Location& location() const;
 
-  Token tok;
+  Location loc;
+  String   str;
 };
 
 using Comment_list = std::vector<Comment>;
@@ -35,11 +37,19 @@ using Comment_list = std::vector<Comment>;
 //
 // is two contiguous comment blocks.
 struct Comment_block : Comment_list {
+  Comment_block(int, int);
+
   std::string text() const;
   
   File* file() const;
   const Location& first_location() const;
   const Location& last_location() const;
+
+  int first_line() const;
+  int last_line() const;
+
+  int line; // The line of the first comment
+  int col;  // The column of every comment
 };
 
 
@@ -48,19 +58,24 @@ using Comment_block_list = std::vector<Comment_block>;
 
 
 // The comment manager is a facility that groups comments into
-// comment blocks.
+// comment blocks. Blocks are indexed by file and are ordered by
+// their lines within each file.
+//
+// Note that comments are only saved when the lexer is asked to
+// capture them (see Lexer::capture_comments).
 class Comment_manager {
 public:
   void save(const Location&, String);
   void reset();
+  void clear(File*);
 
   Comment_block* find(const Location& loc);
-
-  Comment_block_list blocks;
+  const Comment_block_list* blocks(File*) const;
 
 private:
-  void init(const Location&, String);
-  void append(const Location&, String);
+  std::unordered_map<File*, Comment_block_list> files_;
+  Comment_block_list* last_ = nullptr; // Blocks of the last saved comment
+  bool open_ = false;                  // True if the last block is open
 };
 
 Comment_manager& comments();
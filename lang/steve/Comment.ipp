@@ -3,16 +3,20 @@ namespace steve {
 
 inline
 Comment::Comment(const Location& l, String s)
-  : tok(l, comment_tok, s) { }
+  : loc(l), str(s) { }
 
 inline String
-Comment::text() const { return tok.text; }
+Comment::text() const { return str; }
 
 inline const Location&
-Comment::location() const { return tok.loc; }
+Comment::location() const { return loc; }
+
+inline
+Comment_block::Comment_block(int l, int c)
+  : line(l), col(c) { }
 
 inline File*
-Comment_block::file() const { return first_location().file; }
+Comment_block::file() const { return first_location().file(); }
 
 inline const Location&
 Comment_block::first_location() const { return front().location(); }
@@ -20,4 +24,11 @@ Comment_block::first_location() const { return front().location(); }
 inline const Location&
 Comment_block::last_location() const { return back().location(); }
 
+inline int
+Comment_block::first_line() const { return line; }
+
+// The comments in a block are on contiguous lines.
+inline int
+Comment_block::last_line() const { return line + size() - 1; }
+
 } // namespace steve
@@ -3,6 +3,7 @@
 #include <steve/Debug.hpp>
 
 #include <cstdlib>
+#include <thread>
 
 namespace steve {
 
@@ -49,11 +50,35 @@ get_env_module_path() {
   return paths;
 }
 
+// Get the module cache directory from the environment.
+Path
+get_env_module_cache() {
+  const char* var = getenv("STEVE_MODULE_CACHE");
+  if (not var)
+    return Path{};
+  return var;
+}
+
+// Get the number of threads used to load modules from the environment.
+// If not given, use one per processor.
+unsigned
+get_env_jobs() {
+  if (const char* var = getenv("STEVE_JOBS")) {
+    int n = std::atoi(var);
+    if (n > 0)
+      return n;
+  }
+  unsigned n = std::thread::hardware_concurrency();
+  return n ? n : 1;
+}
+
 } // namespace
 
 Configuration::Configuration() {
   init_conf(this);
   module_path = get_env_module_path();
+  module_cache = get_env_module_cache();
+  jobs = get_env_jobs();
 }
 
 Configuration::~Configuration() {
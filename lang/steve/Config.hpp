@@ -12,6 +12,9 @@
 
 namespace steve {
 
+// The version of the compiler.
+constexpr const char* steve_version = "0.1";
+
 // The configuration class maintains configuration data for the
 // Steve Programming Language compiler. In particular, the following
 // information is maintained:
@@ -22,6 +25,16 @@ namespace steve {
 //    - input file list -- The sequence of files given an input for
 //      some translation command.
 //
+//    - comment capture -- Whether comments are saved when modules are
+//      loaded. This is only needed by tools that extract documentation.
+//
+//    - module cache -- The directory in which the elaborated images of
+//      file modules are saved. If empty, modules are always elaborated
+//      from source.
+//
+//    - jobs -- The number of threads used to load modules. By default,
+//      this is the number of processors.
+//
 // TODO: Actually make configuration options!
 struct Configuration {
   Configuration();
@@ -29,6 +42,9 @@ struct Configuration {
 
   Path_list module_path; // The list of paths searched for modules
   Path_list input_files; // The list of files provided as input to a command
+  bool capture_comments = false; // True if comments are saved when lexing
+  Path module_cache;             // The directory of module images
+  unsigned jobs;                 // The number of threads used to load modules
 };
 
 Configuration& config();
@@ -56,7 +56,7 @@ do_convert(Expr* e, Type* t) {
   if (Expr* c = predicate(e, t))
     return c;
 
-  error(e->loc) << format("no known conversion from {} to '{}'", 
+  error(e->loc) << message("no known conversion from {} to '{}'", 
                           typed(e), 
                           debug(t));
 
@@ -0,0 +1,203 @@
+
+#include <steve/Depend.hpp>
+#include <steve/Decl.hpp>
+#include <steve/Debug.hpp>
+#include <steve/Image.hpp>
+#include <steve/Syntax.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace steve {
+
+// Returns the spelling of the name of the declaration d. Note that a
+// using declaration is named by the declaration it uses.
+String
+decl_spelling(Decl* d) {
+  Name* n = is<Using>(d) ? as<Using>(d)->name() : name(d);
+  if (Basic_id* id = as<Basic_id>(n))
+    return id->value();
+  if (Operator_id* id = as<Operator_id>(n))
+    return id->op();
+  steve_unreachable(format("unhandled name '{}'", node_name(n)));
+}
+
+namespace {
+
+// Add the 32-bit word w to the FNV-1a hash h.
+inline std::uint64_t
+hash_word(std::uint64_t h, std::uint32_t w) {
+  for (int i = 0; i < 4; ++i) {
+    h ^= (w >> (8 * i)) & 0xff;
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+} // namespace
+
+// Returns the source of each top-level declaration of the module t,
+// whose tokens are toks. The tokens of a declaration are those from
+// its first token up to the first token of the next declaration.
+std::vector<Decl_source>
+decl_sources(const Tokens& toks, Tree* t) {
+  Tree_seq* ds = as<Top_tree>(t)->first;
+  std::vector<Decl_source> srcs;
+  srcs.reserve(ds->size());
+  auto iter = toks.begin();
+  for (std::size_t i = 0; i < ds->size(); ++i) {
+    Source_offset first = (*ds)[i]->loc.offset();
+    Source_offset last = i + 1 < ds->size()
+      ? (*ds)[i + 1]->loc.offset()
+      : std::numeric_limits<Source_offset>::max();
+    std::uint64_t h = 14695981039346656037ull;
+    for (; iter != toks.end() and iter->offset() < last; ++iter) {
+      h = hash_word(h, iter->symbol());
+      h = hash_word(h, iter->offset() - first);
+    }
+    if (iter == toks.end() and not toks.empty())
+      last = toks.back().offset() + 1;
+    srcs.push_back({h, first, last});
+  }
+  return srcs;
+}
+
+
+// -------------------------------------------------------------------------- //
+// Dependency tracking
+
+// Create a tracker for the first elaboration of a module, whose
+// top-level declarations have the given sources.
+Dep_tracker::Dep_tracker(std::vector<Decl_source>&& ss)
+  : sources_(std::move(ss)), prev_(nullptr), changed_(nullptr),
+    match_(sources_.size(), -1)
+{ }
+
+// Create a tracker to rebuild a module whose previous dependencies
+// are prev. Each declaration is matched with the first unmatched
+// previous declaration having the same fingerprint. The names of the
+// previous declarations that have no match are changed. Reused import
+// declarations do not load their modules again, so the previous imports
+// are kept.
+Dep_tracker::Dep_tracker(std::vector<Decl_source>&& ss, Module_deps* prev, Name_set* changed)
+  : sources_(std::move(ss)), prev_(prev), changed_(changed),
+    match_(sources_.size(), -1)
+{
+  deps.imports = prev->imports;
+
+  std::unordered_multimap<std::uint64_t, int> index;
+  for (std::size_t i = 0; i < prev->decls.size(); ++i)
+    index.emplace(prev->decls[i].source.print, i);
+
+  std::vector<bool> matched(prev->decls.size(), false);
+  for (std::size_t i = 0; i < sources_.size(); ++i) {
+    auto range = index.equal_range(sources_[i].print);
+    for (auto iter = range.first; iter != range.second; ++iter) {
+      if (not matched[iter->second] and (match_[i] < 0 or iter->second < match_[i]))
+        match_[i] = iter->second;
+    }
+    if (match_[i] >= 0)
+      matched[match_[i]] = true;
+  }
+  for (std::size_t i = 0; i < matched.size(); ++i) {
+    if (not matched[i])
+      changed_->insert(decl_spelling(prev->decls[i].decl));
+  }
+}
+
+// Returns true if the record r refers to a declaration whose name
+// has changed.
+bool
+Dep_tracker::stale(const Decl_record& r) const {
+  for (Decl* d : r.uses) {
+    if (changed_->count(decl_spelling(d)))
+      return true;
+  }
+  return false;
+}
+
+// Returns the previous declaration that can be reused as the i-th
+// declaration of the module, or nullptr if the declaration must be
+// elaborated. A declaration that is elaborated again changes its name.
+// The locations of a reused declaration are moved to its new source.
+Decl*
+Dep_tracker::reuse(std::size_t i) {
+  if (match_[i] < 0)
+    return nullptr;
+  const Decl_record& r = prev_->decls[match_[i]];
+  if (stale(r)) {
+    changed_->insert(decl_spelling(r.decl));
+    return nullptr;
+  }
+  const Decl_source& s = sources_[i];
+  if (s.first != r.source.first) {
+    std::int64_t delta = std::int64_t(s.first) - r.source.first;
+    relocate_decl(r.decl, r.source.first, r.source.last, delta);
+  }
+  deps.decls.push_back({r.decl, s, r.uses});
+  return r.decl;
+}
+
+// Record that the i-th declaration of the module was elaborated as d,
+// with the uses noted since the previous declaration. When rebuilding,
+// a new declaration changes its name.
+void
+Dep_tracker::record(std::size_t i, Decl* d) {
+  std::sort(uses_.begin(), uses_.end());
+  uses_.erase(std::unique(uses_.begin(), uses_.end()), uses_.end());
+  deps.decls.push_back({d, sources_[i], std::move(uses_)});
+  uses_.clear();
+  built.push_back(d);
+  if (changed_ and match_[i] < 0)
+    changed_->insert(decl_spelling(d));
+}
+
+// Note a use of the declaration d. Parameters are local to the
+// declaration that uses them, so they are not recorded.
+void
+Dep_tracker::use(Decl* d) {
+  if (not is<Parm>(d))
+    uses_.push_back(d);
+}
+
+// Note that the module imports the file module m.
+void
+Dep_tracker::import(Module* m) {
+  if (std::find(deps.imports.begin(), deps.imports.end(), m) == deps.imports.end())
+    deps.imports.push_back(m);
+}
+
+namespace {
+
+// The tracker of the module being elaborated by this thread.
+thread_local Dep_tracker* tracker_ = nullptr;
+
+} // namespace
+
+// Returns the tracker of the module being elaborated, if any.
+Dep_tracker*
+current_tracker() { return tracker_; }
+
+// Note a use of d by the declaration being elaborated.
+void
+note_use(Decl* d) {
+  if (tracker_)
+    tracker_->use(d);
+}
+
+// Note that the module being elaborated imports m.
+void
+note_import(Module* m) {
+  if (tracker_)
+    tracker_->import(m);
+}
+
+Tracker_guard::Tracker_guard(Dep_tracker* t)
+  : saved(tracker_)
+{
+  tracker_ = t;
+}
+
+Tracker_guard::~Tracker_guard() { tracker_ = saved; }
+
+} // namespace steve
@@ -0,0 +1,110 @@
+
+#ifndef STEVE_DEPEND_HPP
+#define STEVE_DEPEND_HPP
+
+#include <steve/Ast.hpp>
+#include <steve/Token.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// This module defines the dependencies used to rebuild modules
+// incrementally. While a file module is elaborated, each of its
+// top-level declarations records a fingerprint of its source and the
+// declarations to which it refers (i.e., those found by lookup), and
+// the module records the file modules that it imports.
+//
+// When a module is rebuilt, a top-level declaration is reused if the
+// fingerprint of its source has not changed and none of the names to
+// which it refers have changed. The names that have changed are those
+// of declarations that were removed, edited, or elaborated again. Names
+// are compared, not declarations, so that a new declaration that would
+// be found by an existing lookup (e.g., a new overload) also causes
+// that lookup to be elaborated again.
+//
+// A fingerprint is computed from the symbols of a declaration's tokens
+// and their offsets from its first token, so moving a declaration does
+// not change it, but changing its layout does. The locations of a
+// reused declaration that moved are moved with it, so its tokens are
+// found at the same offsets in the new source. Fingerprints are only
+// meaningful within a single process.
+
+namespace steve {
+
+struct Tree;
+
+// The source of a top-level declaration.
+struct Decl_source {
+  std::uint64_t print;      // The fingerprint of its tokens
+  Source_offset first;      // The offset of its first token
+  Source_offset last;       // The offset past its last token
+};
+
+// The record of a top-level declaration.
+struct Decl_record {
+  Decl* decl;               // The declaration
+  Decl_source source;       // Its source
+  std::vector<Decl*> uses;  // The declarations it refers to
+};
+
+// The dependencies of a file module.
+struct Module_deps {
+  std::vector<Decl_record> decls;
+  std::vector<Module*> imports;
+};
+
+using Name_set = std::unordered_set<String>;
+
+String decl_spelling(Decl*);
+
+std::vector<Decl_source> decl_sources(const Tokens&, Tree*);
+
+
+// -------------------------------------------------------------------------- //
+// Dependency tracking
+
+// The dependency tracker records the dependencies of a module while it
+// is elaborated. When the module is rebuilt, the tracker is given its
+// previous dependencies and the set of changed names, which it updates
+// as declarations are reused or elaborated again.
+struct Dep_tracker {
+  explicit Dep_tracker(std::vector<Decl_source>&&);
+  Dep_tracker(std::vector<Decl_source>&&, Module_deps*, Name_set*);
+
+  Decl* reuse(std::size_t);
+  void record(std::size_t, Decl*);
+  void use(Decl*);
+  void import(Module*);
+
+  Module_deps deps;          // The new dependencies
+  std::vector<Decl*> built;  // The declarations that were elaborated
+
+private:
+  bool stale(const Decl_record&) const;
+
+  std::vector<Decl_source> sources_;
+  Module_deps* prev_;
+  Name_set* changed_;
+  std::vector<int> match_;    // The previous record of each declaration
+  std::vector<Decl*> uses_;   // The uses of the current declaration
+};
+
+Dep_tracker* current_tracker();
+
+void note_use(Decl*);
+void note_import(Module*);
+
+// An RAII helper that makes a tracker current for the duration of
+// an elaboration. A nested module is elaborated with its own tracker.
+struct Tracker_guard {
+  explicit Tracker_guard(Dep_tracker*);
+  ~Tracker_guard();
+
+  Dep_tracker* saved;
+};
+
+} // namespace steve
+
+#endif
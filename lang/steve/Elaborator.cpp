@@ -3,6 +3,7 @@
 #include <steve/Evaluator.hpp>
 #include <steve/Syntax.hpp>
 #include <steve/Ast.hpp>
+#include <steve/Depend.hpp>
 #include <steve/Scope.hpp>
 #include <steve/Type.hpp>
 #include <steve/Conv.hpp>
@@ -36,7 +37,7 @@ template<typename T>
     if (T* d = as<T>(e))
       return d;
 
-    error(t->loc) << format("expected a {} but got '{}'", kind, debug(e));
+    error(t->loc) << message("expected a {} but got '{}'", kind, debug(e));
     return nullptr;
   }
 
@@ -62,7 +63,7 @@ elab_as_parm(Tree* t) {
   }
   Parm* parm = as<Parm>(id->decl());
   if (not parm) {
-    error(t->loc) << format("'{}' does not name a parameter", debug(id));
+    error(t->loc) << message("'{}' does not name a parameter", debug(id));
   }
   return parm;
 }
@@ -93,7 +94,7 @@ elab_type(Tree* t) {
   // If the elaboration refers to a type function, then evaluate it.
   if (Call *call = as<Call>(e)) {
     if (not is_same(type(call), get_typename_type())) {
-      error(call->loc) << format("'{}' does not yield a type", debug(call));
+      error(call->loc) << message("'{}' does not yield a type", debug(call));
       return nullptr;
     }
     e = reduce(e);
@@ -103,7 +104,7 @@ elab_type(Tree* t) {
   if (Type* r = as<Type>(e))
     return r;
   
-  error(t->loc) << format("expected a type but got '{}'", debug(e));
+  error(t->loc) << message("expected a type but got '{}'", debug(e));
   return nullptr;
 }
 
@@ -145,10 +146,12 @@ elab_id(Id_tree* t) {
   // Lookup the name.
   //
   // TODO: Change to lookup(n) when we want to support overloading.
-  if (Decl* d = lookup_single(n))
+  if (Decl* d = lookup_single(n)) {
+    note_use(d);
     return make_expr<Decl_id>(t->loc, type(d), n, d);
-  else
+  } else {
     return nullptr;
+  }
 }
 
 
@@ -165,7 +168,7 @@ elab_unit(Lit_tree* t, const Token* k) {
 // the 'true' and 'false' tokens. A boolean literal has type 'bool'.
 Expr*
 elab_bool(Lit_tree* t, const Token* k) {
-  return make_expr<Bool>(t->loc, get_bool_type(), (k->text == "true"));
+  return make_expr<Bool>(t->loc, get_bool_type(), (k->text() == "true"));
 }
 
 // Returns an elaborated integer literal.
@@ -198,7 +201,7 @@ elab_int(Lit_tree* t, const Token* k) {
 Expr*
 elab_lit(Lit_tree* t) {
   const Token* k = t->value();
-  switch (k->kind) {
+  switch (k->kind()) {
   case typename_tok: return make_typename_type(t->loc);
   case bool_tok: return make_bool_type(t->loc);
   case nat_tok: return make_nat_type(t->loc);
@@ -243,7 +246,7 @@ check_same_type(Expr* e1, Expr* e2) {
   Type* t2 = type(e2);
   if (is_same(t1, t2))
     return t1;
-  error(e2->loc) << format("{} does not have the same type as {}",
+  error(e2->loc) << message("{} does not have the same type as {}",
                            typed(e2), 
                            typed(e1));
   return nullptr;
@@ -272,7 +275,7 @@ check_constant(Expr* e) {
   Eval v = eval(e);
   if (is_value(v))
     return to_expr(v, e);
-  error(e->loc) << format("'{}' is not a constant expression", debug(e));
+  error(e->loc) << message("'{}' is not a constant expression", debug(e));
   return nullptr;
 }
 
@@ -282,7 +285,7 @@ check_boolean(Term* e) {
   Type* t = type(e);
   if (is_same(t, get_bool_type())) 
     return e;
-  error(e->loc) << format("'{}' is not a boolean term", debug(e));
+  error(e->loc) << message("'{}' is not a boolean term", debug(e));
   return nullptr;
 }
 
@@ -321,7 +324,7 @@ check_arguments(Call_tree* t, Def* fn, Expr_seq* args, Type_seq* parms) {
   //
   // TODO: This is where would would instantiate default arguments.
   if (first1 == last1 and first2 != last2) {
-    error(t->loc) << format("too few arguments for '{}'", debug(fn->name()));
+    error(t->loc) << message("too few arguments for '{}'", debug(fn->name()));
     return nullptr;
   }
 
@@ -330,7 +333,7 @@ check_arguments(Call_tree* t, Def* fn, Expr_seq* args, Type_seq* parms) {
   // TODO: Unless the last argument is variadic, then all remaining
   // arguments would be placed into an argument pack.
   if (first2 == last2 and first1 != last1) {
-    error(t->loc) << format("too many arguments for '{}'", debug(fn->name()));
+    error(t->loc) << message("too many arguments for '{}'", debug(fn->name()));
     return nullptr;
   }
 
@@ -347,10 +350,10 @@ elab_variant_binding(Call_tree* t, Dep_variant_type* type) {
   Tree_seq* exprs = t->args();
   if (exprs->size() != 1) {
     if (exprs->size() == 0)
-      error(t->loc) << format("too few arguments for descriminated "
+      error(t->loc) << message("too few arguments for descriminated "
                               "variant type '{}'", debug(type));
     else
-      error(t->loc) << format("too many arguments for descriminated "
+      error(t->loc) << message("too many arguments for descriminated "
                               "variant type '{}'", debug(type));
     return nullptr;
   }
@@ -385,7 +388,7 @@ Expr*
 elab_type_call(Call_tree* t, Type* target) {
   if (Dep_variant_type* v = as<Dep_variant_type>(target))
     return elab_variant_binding(t, v);
-  error (t->loc) << format("cannot call the type '{}'", debug(target));
+  error (t->loc) << message("cannot call the type '{}'", debug(target));
   return nullptr;
 }
 
@@ -445,7 +448,7 @@ elab_call(Call_tree* t) {
 
   // Make sure we have a callable expression.
   if (not fn or not fn_type) {
-    error(t->fn()->loc) << format("'{}' is not callable", debug(tgt));
+    error(t->fn()->loc) << message("'{}' is not callable", debug(tgt));
     return nullptr;
   }
 
@@ -478,7 +481,7 @@ Type*
 elab_array_type(Index_tree* t, Type* type, Expr* e) {
   Term* bound = as<Term>(e);
   if (not bound) {
-    error(e->loc) << format("ill-formed array bound '{}'", debug(e));
+    error(e->loc) << message("ill-formed array bound '{}'", debug(e));
     return nullptr;
   }
 
@@ -490,7 +493,7 @@ elab_array_type(Index_tree* t, Type* type, Expr* e) {
   // Array subscripts must be fully reduced.
   bound = reduce(bound);
   if (!is_value(bound)) {
-    error(e->loc) << format("array bound '{}' is not constant", debug(e));
+    error(e->loc) << message("array bound '{}' is not constant", debug(e));
     return nullptr;
   }
 
@@ -554,7 +557,7 @@ elab_dot(Dot_tree* t) {
   if (not s)
     return nullptr;
   if (not defines_scope(s)) {
-    error(t->loc) << format("'{}' does not define a scope", debug(s)) << '\n';
+    error(t->loc) << message("'{}' does not define a scope", debug(s)) << '\n';
     return nullptr;
   }
 
@@ -573,7 +576,7 @@ elab_dot(Dot_tree* t) {
 // Create a new operator from the given token.
 Name*
 elab_operator(const Token* k) {
-  return new Operator_id(k->loc, k->text);
+  return new Operator_id(k->loc(), k->text());
 }
 
 Expr*
@@ -595,7 +598,7 @@ elab_binary(Binary_tree* t) {
 
   // TODO: List candidates.
   if (not res.is_unique()) {
-    error(t->loc) << format("no matching function for '{}' with arguments "
+    error(t->loc) << message("no matching function for '{}' with arguments "
                             "{} and {}", 
                             debug(name), 
                             typed(left), 
@@ -608,6 +611,7 @@ elab_binary(Binary_tree* t) {
   }
 
   Decl* decl = res.solution();
+  note_use(decl);
   Term* fn = as<Term>(as<Def>(decl)->init()); // FIXME: Gross
   Type* result = as<Fn_type>(type(fn))->result();
 
@@ -920,7 +924,7 @@ elab_enum_ctor(Tree* t, Enum_type* type) {
   if (Range_tree* r = as<Range_tree>(t))
     return elab_range_ctor(r, type);
   if (Binary_tree* b = as<Binary_tree>(t))
-    if (b->op()->kind == equal_tok)
+    if (b->op()->kind() == equal_tok)
       return elab_named_ctor(b, type);
 
   // FIXME: This should probably be an assertion.
@@ -1127,8 +1131,12 @@ elab_const_or_fn(Def_tree* t) {
 Def*
 bind_definition(Def* def) {
   Expr* init = def->init();
-  if (Type* t = as<Type>(init))
-    t->def_ = def;
+  if (Type* t = as<Type>(init)) {
+    // A canonical type is shared by every definition that names it,
+    // so it is not bound to any of them.
+    if (not is_canonical_type(t))
+      t->def_ = def;
+  }
   else if (Term* t = as<Term>(init))
     t->def_ = def;
   else
@@ -1178,7 +1186,7 @@ elab_def(Def_tree* t) {
 
 bool
 elab_module_id(Module*& first, Module*& current, Id_tree* t) {
-  Module* mod = load_module(t->loc, current, t->value()->text);
+  Module* mod = load_module(t->loc, current, t->value()->text());
   if (not mod)
     return false;
   current = mod;
@@ -1277,7 +1285,7 @@ elab_using(Using_tree* t) {
     return nullptr;
   Decl_id* id = as<Decl_id>(expr);
   if (not id) {
-    error(t->loc) << format("using target '{}' does not refer to a "
+    error(t->loc) << message("using target '{}' does not refer to a "
                             "declaration", debug(expr));
     return nullptr;
   }
@@ -1391,8 +1399,7 @@ elab_return(Return_tree* t) {
 // occuring as part of the id.
 Expr*
 elab_load(Load_tree* t) {
-  Diagnostics diags;
-  Diagnostics_guard guard(diags);
+  Suppression_guard guard;
 
   // Try to elaborate the name as a module. If we succeed,
   // the we don't need to do anything else.
@@ -1424,15 +1431,42 @@ elab_load(Load_tree* t) {
 // ---------------------------------------------------------------------------//
 // Miscellaneous expressions
 
+// Declare the reused declaration d again. Its context is the one in
+// which it was first declared.
+bool
+redeclare(Decl* d) {
+  Expr* cxt = d->cxt_;
+  Overload* ovl = is<Using>(d)
+    ? declare(as<Using>(d)->name(), as<Using>(d)->decl())
+    : declare(d);
+  d->cxt_ = cxt;
+  return ovl;
+}
+
+// Elaborate the i-th declaration of a module. When the module is
+// being rebuilt, a declaration that is unchanged is reused instead.
+Decl*
+elab_top_decl(Tree* t, std::size_t i) {
+  Dep_tracker* deps = current_tracker();
+  if (not deps)
+    return elab_decl(t);
+  if (Decl* d = deps->reuse(i))
+    return redeclare(d) ? d : nullptr;
+  Decl* d = elab_decl(t);
+  if (d)
+    deps->record(i, d);
+  return d;
+}
+
 // Elaborate each declaration in turn. Note that declarations are
 // never replaced. The elaboration operates in-place.
 Expr*
 elab_top(Top_tree* t) {
   Scope_guard scope(module_scope);
   Decl_seq* ds = new Decl_seq();
-  for (Tree* d1 : *t->first) {
-    if (Decl* d2 = elab_decl(d1))
-      ds->push_back(d2);
+  for (std::size_t i = 0; i < t->first->size(); ++i) {
+    if (Decl* d = elab_top_decl((*t->first)[i], i))
+      ds->push_back(d);
     else
       return nullptr;
   }
@@ -9,26 +9,75 @@ namespace steve {
 
 namespace {
 
-// The global diagnostics pointer.
-Diagnostics* diags_ = nullptr;
+// The current diagnostics pointer. Each thread (e.g., one parsing an
+// imported module in the background) has its own diagnostics.
+thread_local Diagnostics* diags_ = nullptr;
+
+// The number of diagnostics emitted, including those suppressed.
+thread_local std::size_t count_ = 0;
+
+// True when diagnostics are suppressed.
+thread_local bool suppressed_ = false;
 
 // Register a diagnostic with the diagnostic list.
 template<typename D>
   inline Diagnostic*
   make_diag(Diagnostics& ds, const Location& loc) {
+    ++count_;
     D* d = new D(loc);
     ds.push_back(d);
     return d;
   }
 
-// Make sure that diagnostics are installed.
-inline void
-check_diagnostics() {
-  steve_assert(diags_, "diagnostics not initialized");
+// Register a diagnostic with the current diagnostics. If diagnostics
+// are suppressed, the diagnostic is only counted.
+template<typename D>
+  inline Diagnostic*
+  make_diag(const Location& loc) {
+    if (suppressed_) {
+      ++count_;
+      return nullptr;
+    }
+    steve_assert(diags_, "diagnostics not initialized");
+    return make_diag<D>(*diags_, loc);
+  }
+
+// Append text to the message of d. If part of the message has been
+// deferred, the text is deferred too, so that the parts of the
+// message remain in order.
+void
+append(Diagnostic* d, const std::string& s) {
+  if (not d)
+    return;
+  if (d->rest)
+    defer(d, [s](std::string& m) { m += s; });
+  else
+    d->msg += s;
 }
 
 } // namespace
 
+// Returns the text of the message, formatting any deferred parts.
+std::string
+Diagnostic::message() const {
+  std::string s = msg;
+  if (rest)
+    rest(s);
+  return s;
+}
+
+// Defer part of the message of d. The function f appends its part to
+// the formatted message.
+void
+defer(Diagnostic* d, Diagnostic::Deferred f) {
+  if (d->rest) {
+    Diagnostic::Deferred prev = std::move(d->rest);
+    d->rest = [prev, f](std::string& s) { prev(s); f(s); };
+  } else {
+    d->rest = std::move(f);
+  }
+}
+
 // Returns a pointer to the current diagnostics.
 Diagnostics*
 current_diagnostics() { return diags_; }
@@ -43,64 +92,82 @@ use_diagnostics(Diagnostics& ds) { diags_ = &ds; }
 void
 reset_diagnostics() { diags_ = nullptr; }
 
+// Returns the number of diagnostics emitted so far, including those
+// that were suppressed. Comparing counts determines if an operation
+// emitted any diagnostic.
+std::size_t
+diagnostic_count() { return count_; }
+
+// Returns true if diagnostics are suppressed.
+bool
+diagnostics_suppressed() { return suppressed_; }
+
+// Enable or disable the suppression of diagnostics.
+void
+suppress_diagnostics(bool b) { suppressed_ = b; }
+
 // -------------------------------------------------------------------------- //
 // Streaming
 
 
 Diagnostic_stream
 operator<<(Diagnostic_stream ds, char c) {
-  ds.diag->msg += c;
+  append(ds.diag, std::string(1, c));
   return ds;
 }
 
 Diagnostic_stream
 operator<<(Diagnostic_stream ds, const char* msg) {
-  ds.diag->msg += msg;
+  append(ds.diag, msg);
   return ds;
 }
 
 Diagnostic_stream
 operator<<(Diagnostic_stream ds, const std::string& msg) {
-  ds.diag->msg += msg;
+  append(ds.diag, msg);
   return ds;
 }
 
 Diagnostic_stream
 operator<<(Diagnostic_stream ds, String msg) {
-  ds.diag->msg += msg.str();
+  if (ds.diag)
+    append(ds.diag, msg.str());
   return ds;
 }
 
 Diagnostic_stream
 operator<<(Diagnostic_stream ds, int n) {
-  std::stringstream ss;
-  ss << n;
-  ds.diag->msg += ss.str();
+  if (ds.diag) {
+    std::stringstream ss;
+    ss << n;
+    append(ds.diag, ss.str());
+  }
   return ds;
 }
 
 Diagnostic_stream
 operator<<(Diagnostic_stream ds, Integer n) {
-  std::stringstream ss;
-  ss << n;
-  ds.diag->msg += ss.str();
+  if (ds.diag) {
+    std::stringstream ss;
+    ss << n;
+    append(ds.diag, ss.str());
+  }
   return ds;
 }
 
 Diagnostic_stream
 operator<<(Diagnostic_stream ds, debug_node d) {
-  std::stringstream ss;
-  ss << d;
-  ds.diag->msg += ss.str();
+  if (ds.diag) {
+    std::stringstream ss;
+    ss << d;
+    append(ds.diag, ss.str());
+  }
   return ds;
 }
 
 // Create a new error diagnostic.
 Diagnostic_stream
-error(const Location& loc) { 
-  check_diagnostics();
-  return {make_diag<Error>(*diags_, loc)};
-}
+error(const Location& loc) { return {make_diag<Error>(loc)}; }
 
 // Create a new error diagnostic.
 Diagnostic_stream
@@ -110,10 +177,7 @@ error(Diagnostics& ds, const Location& loc) {
 
 // Create a new warning diagnostic.
 Diagnostic_stream
-warn(const Location& loc) { 
-  check_diagnostics();
-  return warn(*diags_, loc); 
-}
+warn(const Location& loc) { return {make_diag<Warning>(loc)}; }
 
 // Create a new warning diagnostic.
 Diagnostic_stream
@@ -123,10 +187,7 @@ warn(Diagnostics& ds, const Location& loc) {
 
 // Create a new note diagnostic.
 Diagnostic_stream
-note(const Location& loc) { 
-  check_diagnostics();
-  return note(*diags_, loc); 
-}
+note(const Location& loc) { return {make_diag<Note>(loc)}; }
 
 // Create a new note diagnostic.
 Diagnostic_stream
@@ -136,10 +197,7 @@ note(Diagnostics& ds, const Location& loc) {
 
 // Create a new sorry diagnostic.
 Diagnostic_stream
-sorry(const Location& loc) { 
-  check_diagnostics();
-  return sorry(*diags_, loc); 
-}
+sorry(const Location& loc) { return {make_diag<Sorry>(loc)}; }
 
 // Create a new sorry diagnostic.
 Diagnostic_stream
@@ -172,7 +230,7 @@ emit(std::ostream& os, const Diagnostics& ds) {
   for (const Diagnostic* d : ds) {
     os << diagnostic_name(d) << ": " ;
     os << d->loc << ": ";
-    os << d->msg << "\n";
+    os << d->message() << "\n";
   }
 }
 
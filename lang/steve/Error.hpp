@@ -2,12 +2,16 @@
 #ifndef STEVE_ERROR_HPP
 #define STEVE_ERROR_HPP
 
+#include <steve/Meta.hpp>
 #include <steve/Memory.hpp>
+#include <steve/Format.hpp>
 #include <steve/Location.hpp>
 #include <steve/Debug.hpp>
 
 #include <cerrno>
+#include <functional>
 #include <iosfwd>
+#include <tuple>
 #include <vector>
 #include <system_error>
 
@@ -32,6 +36,7 @@ class String;
 class Integer;
 class Location;
 struct debug_node;
+struct debug_tree;
 
 // An error code.
 using Error_code = std::error_code;
@@ -106,16 +111,28 @@ enum Diagnostic_kind {
 // This structure is not dissimilar from the AST structure defined
 // for the language. In particular, certain kinds of diagnostics
 // may contain sub-messages that provide additional information.
-struct Diagnostic : Gc {
+//
+// Note that diagnostics are allocated on the heap, not in the current
+// arena: they are frequently reported after the phase that created
+// them has finished.
+//
+// Part of the message may be deferred (see Message below). The full
+// text of the message is formatted only when it is requested.
+struct Diagnostic {
+  using Deferred = std::function<void(std::string&)>;
+
   Diagnostic(Diagnostic_kind k, Location l)
     : kind(k), loc(l), msg() { }
 
   Diagnostic(Diagnostic_kind k, Location l, const std::string& m)
     : kind(k), loc(l), msg(m) { }
 
+  std::string message() const;
+
   Diagnostic_kind kind;
   Location loc;
-  std::string msg;
+  std::string msg;  // The formatted part of the message
+  Deferred rest;    // The deferred part of the message, if any
 };
 
 // An error is emitted to diagnost a lexical, syntactic, or semantic
@@ -152,7 +169,7 @@ struct Sorry : Diagnostic {
 // Diagnostic management
 
 // The diagnostics class defines a sequence of diagnostic failures.
-using Diagnostics = std::vector<Diagnostic*, Gc_allocator<Diagnostic*>>;
+using Diagnostics = std::vector<Diagnostic*>;
 
 // A diagnostic stream is a small object that supports
 // stream-based construction of diagnostic messages.
@@ -162,11 +179,33 @@ using Diagnostics = std::vector<Diagnostic*, Gc_allocator<Diagnostic*>>;
 // underlying stringstream, but that's a little harder to manage:
 // we'd need to track it with a shared or unique pointer or
 // something like that. 
+//
+// When diagnostics are suppressed, the stream has no diagnostic, and
+// writing to it has no effect.
 struct Diagnostic_stream {
   Diagnostic_stream(const Diagnostic_stream&) = default;
   Diagnostic* diag;
 };
 
+// A message is a format string and its arguments. Writing a message
+// to a diagnostic stream defers its formatting until the diagnostic
+// is reported, so messages of diagnostics that are discarded (e.g.,
+// those of candidates rejected by overload resolution) are never
+// formatted.
+//
+// The arguments are copied into the message. They must not refer to
+// parse trees, which may be released before a diagnostic is reported.
+template<typename... Args>
+  struct Message {
+    const char* fmt;
+    std::tuple<Args...> args;
+  };
+
+template<typename... Args>
+  Message<Args...> message(const char*, const Args&...);
+
+void defer(Diagnostic*, Diagnostic::Deferred);
+
 Diagnostic_stream operator<<(Diagnostic_stream, char);
 Diagnostic_stream operator<<(Diagnostic_stream, const char*);
 Diagnostic_stream operator<<(Diagnostic_stream, const std::string&);
@@ -175,6 +214,9 @@ Diagnostic_stream operator<<(Diagnostic_stream, int);
 Diagnostic_stream operator<<(Diagnostic_stream, Integer);
 Diagnostic_stream operator<<(Diagnostic_stream, debug_node);
 
+template<typename... Args>
+  Diagnostic_stream operator<<(Diagnostic_stream, const Message<Args...>&);
+
 Diagnostic_stream error();
 Diagnostic_stream error(const Location&);
 Diagnostic_stream error(Diagnostics&, const Location&);
@@ -195,9 +237,15 @@ Diagnostic_stream sorry(Diagnostics&, const Location&);
 Diagnostics* current_diagnostics();
 void use_diagnostics(Diagnostics&);
 void reset_diagnostics();
+std::size_t diagnostic_count();
+
+// Diagnostic suppression
+bool diagnostics_suppressed();
+void suppress_diagnostics(bool);
 
 // An RAII helper that replaces the current diagnostics with
-// an empty set.
+// an empty set. Diagnostics are not suppressed within the guard,
+// even if they were suppressed outside of it.
 struct Diagnostics_guard {
   Diagnostics_guard();
   Diagnostics_guard(Diagnostics&);
@@ -205,6 +253,19 @@ struct Diagnostics_guard {
 
   Diagnostics* saved;   // The previous diagnostics
   Diagnostics* current; // The current diagnostics
+  bool suppressed;      // The previous suppression
+};
+
+// An RAII helper that suppresses diagnostics. Within the guard,
+// diagnostics emitted into the current diagnostics are counted, but
+// they are neither recorded nor formatted. This is used when checking
+// alternatives whose diagnostics are never reported (e.g., overload
+// candidates).
+struct Suppression_guard {
+  Suppression_guard();
+  ~Suppression_guard();
+
+  bool saved; // The previous suppression
 };
 
 
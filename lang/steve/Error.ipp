@@ -94,13 +94,21 @@ inline
 Diagnostics_guard::Diagnostics_guard()
   : saved(current_diagnostics())
   , current(nullptr)
-{ reset_diagnostics(); }
+  , suppressed(diagnostics_suppressed())
+{ 
+  reset_diagnostics(); 
+  suppress_diagnostics(false);
+}
 
 inline
 Diagnostics_guard::Diagnostics_guard(Diagnostics& diags)
   : saved(current_diagnostics())
   , current(&diags)
-{ use_diagnostics(diags); }
+  , suppressed(diagnostics_suppressed())
+{ 
+  use_diagnostics(diags); 
+  suppress_diagnostics(false);
+}
 
 inline
 Diagnostics_guard::~Diagnostics_guard() {
@@ -108,8 +116,60 @@ Diagnostics_guard::~Diagnostics_guard() {
     use_diagnostics(*saved);
   else
     reset_diagnostics();
+  suppress_diagnostics(suppressed);
 }
 
+inline
+Suppression_guard::Suppression_guard()
+  : saved(diagnostics_suppressed())
+{ suppress_diagnostics(true); }
+
+inline
+Suppression_guard::~Suppression_guard() { suppress_diagnostics(saved); }
+
+
+// -------------------------------------------------------------------------- //
+// Messages
+
+template<typename... Args>
+  inline Message<Args...>
+  message(const char* fmt, const Args&... args) {
+    return {fmt, std::tuple<Args...>(args...)};
+  }
+
+template<typename... Args, std::size_t... N>
+  inline std::string
+  format_message(const Message<Args...>& m, Indices<N...>) {
+    return format(m.fmt, std::get<N>(m.args)...);
+  }
+
+template<typename... Args>
+  inline std::string
+  format_message(const Message<Args...>& m) {
+    using Seq = typename Make_indices<sizeof...(Args)>::type;
+    return format_message(m, Seq());
+  }
+
+// True when no argument type refers to a parse tree.
+template<typename... Args>
+  struct Is_deferrable : std::true_type { };
+
+template<typename T, typename... Args>
+  struct Is_deferrable<T, Args...>
+    : std::integral_constant<bool, not std::is_same<T, debug_tree>::value
+                                   and Is_deferrable<Args...>::value> 
+  { };
+
+template<typename... Args>
+  inline Diagnostic_stream
+  operator<<(Diagnostic_stream ds, const Message<Args...>& m) {
+    static_assert(Is_deferrable<Args...>::value, 
+                  "cannot defer the formatting of a parse tree");
+    if (ds.diag)
+      defer(ds.diag, [m](std::string& s) { s += format_message(m); });
+    return ds;
+  }
+
 
 template<typename C, typename T>
   inline std::basic_ostream<C, T>& 
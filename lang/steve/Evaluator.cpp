@@ -1,11 +1,16 @@
 
 #include <steve/Evaluator.hpp>
+#include <steve/Closure.hpp>
 #include <steve/Ast.hpp>
 #include <steve/Type.hpp>
 #include <steve/Subst.hpp>
 #include <steve/Error.hpp>
 #include <steve/Debug.hpp>
 
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
 namespace steve {
 
 // Declarations
@@ -40,7 +45,10 @@ inline Eval
 value(bool b) { return Value(b); }
 
 inline Eval
-value(Integer n) { return Value(n); }
+value(const Integer& n) { return Value(n); }
+
+inline Eval
+value(Integer&& n) { return Value(std::move(n)); }
 
 inline Eval
 value(Fn* f) { return Value(f); }
@@ -98,11 +106,129 @@ eval_args(Expr_seq* args) {
   return result;
 }
 
+// -------------------------------------------------------------------------- //
+// Call cache
+//
+// Functions are pure, so a call whose arguments are all values always
+// evaluates to the same result. Calls are cached by their target and
+// the values of their arguments. Types are compared by address, which
+// is exact for canonical types. Only calls that produce a value without
+// emitting diagnostics are cached, so that a cached call never hides
+// an error.
+
+// Evaluation modes.
+bool cache_calls_ = true;
+bool compile_calls_ = true;
+
+struct Call_key {
+  Fn* fn;
+  Value_seq args;
+};
+
+inline std::size_t
+hash_combine(std::size_t h, std::size_t v) {
+  return h ^ (v + 0x9e3779b9 + (h << 6) + (h >> 2));
+}
+
+std::size_t
+hash_value(const Value& v) {
+  std::size_t h = v.kind;
+  switch (v.kind) {
+  case unit_value: return h;
+  case bool_value: return hash_combine(h, v.as_bool());
+  case integer_value: return hash_combine(h, v.as_integer().gets());
+  case function_value: return hash_combine(h, std::hash<Fn*>()(v.as_function()));
+  case type_value: return hash_combine(h, std::hash<Type*>()(v.as_type()));
+  }
+  steve_unreachable("unhandled value kind");
+}
+
+bool
+same_value(const Value& a, const Value& b) {
+  if (a.kind != b.kind)
+    return false;
+  switch (a.kind) {
+  case unit_value: return true;
+  case bool_value: return a.as_bool() == b.as_bool();
+  case integer_value: return a.as_integer() == b.as_integer();
+  case function_value: return a.as_function() == b.as_function();
+  case type_value: return a.as_type() == b.as_type();
+  }
+  steve_unreachable("unhandled value kind");
+}
+
+struct call_hash {
+  std::size_t operator()(const Call_key& k) const {
+    std::size_t h = std::hash<Fn*>()(k.fn);
+    for (const Value& v : k.args)
+      h = hash_combine(h, hash_value(v));
+    return h;
+  }
+};
+
+struct call_eq {
+  bool operator()(const Call_key& a, const Call_key& b) const {
+    return a.fn == b.fn 
+       and a.args.size() == b.args.size()
+       and std::equal(a.args.begin(), a.args.end(), b.args.begin(), same_value);
+  }
+};
+
+// The call cache is shared by all threads, but a call is never
+// evaluated while the cache is locked: evaluation is recursive.
+struct Call_cache {
+  std::mutex mutex;
+  std::unordered_map<Call_key, Value, call_hash, call_eq> calls;
+  std::size_t hits = 0;
+  std::size_t misses = 0;
+};
+
+Call_cache&
+call_cache() {
+  static Call_cache cache;
+  return cache;
+}
+
+// Evaluate the call of fn. The values of the arguments are given by
+// evals. If the function can be compiled, its compiled code computes
+// the value of the call. Otherwise, the arguments are substituted
+// into its definition, which is then partially evaluated.
 Eval
-eval_fn_call(Fn* fn, Expr_seq* args) {
+eval_fn_call(Fn* fn, const Eval_seq& evals, Expr_seq* args) {
+  Call_key key {fn, {}};
+  key.args.reserve(evals.size());
+  for (const Eval& e : evals)
+    key.args.push_back(e.as_value());
+
+  Call_cache& cache = call_cache();
+  if (cache_calls_) {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    auto iter = cache.calls.find(key);
+    if (iter != cache.calls.end()) {
+      ++cache.hits;
+      return iter->second;
+    }
+    ++cache.misses;
+  }
+
+  Value v = unit;
+  if (compile_calls_ and eval_closure(fn, key.args, v)) {
+    if (cache_calls_) {
+      std::lock_guard<std::mutex> lock(cache.mutex);
+      cache.calls.emplace(std::move(key), v);
+    }
+    return std::move(v);
+  }
+
+  std::size_t diags = diagnostic_count();
   Subst s {fn->parms(), args};
   Expr* r = subst(fn, s);
-  return eval_expr(r);
+  Eval result = eval_expr(r);
+  if (cache_calls_ and is_value(result) and diagnostic_count() == diags) {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.calls.emplace(std::move(key), result.as_value());
+  }
+  return result;
 }
 
 Eval
@@ -143,7 +269,7 @@ eval_call(Call* e) {
   if (all_values(evals)) {
     // We can compile-time evaluate this function.
     if (Fn* f = as<Fn>(fn))
-      return eval_fn_call(f, args);
+      return eval_fn_call(f, evals, args);
     if (Builtin* b = as<Builtin>(fn))
       return eval_builtin_call(b, args);
     steve_unreachable(format("{}: evalutaion failure: invalid call target", e->loc));
@@ -173,7 +299,7 @@ eval_call(Call* e) {
 void
 check_overflow(const Integer& n, Type* t, Expr* e) {
   if (n.bits() > size_in_bits(t))
-    error(e->loc) << format("promotion of '{}' exceeds size of '{}'",
+    error(e->loc) << message("promotion of '{}' exceeds size of '{}'",
                              n, debug(t));
 }
 
@@ -236,7 +362,7 @@ eval_binary(Binary* e) {
   // the partially evaluated results.
   if (all_values(evals)) {
     if (Fn* fn = as<Fn>(tgt))
-      return eval_fn_call(fn, args);
+      return eval_fn_call(fn, evals, args);
     if (Builtin* b = as<Builtin>(tgt))
       return eval_builtin_call(b, args);
     steve_unreachable(format("{}: evalutaion failure: invalid call target"));
@@ -362,6 +488,30 @@ reduce(Term* t) {
   return as<Term>(e);
 }
 
+Call_cache_stats
+call_cache_stats() {
+  Call_cache& cache = call_cache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  return {cache.hits, cache.misses};
+}
+
+// Discard every cached call. This is done when the functions and
+// types to which the cache refers are released.
+void
+clear_call_cache() {
+  Call_cache& cache = call_cache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  cache.calls.clear();
+}
+
+// Enable or disable the call cache.
+void
+use_call_cache(bool b) { cache_calls_ = b; }
+
+// Enable or disable compiled evaluation of function calls.
+void
+use_compiled_evaluation(bool b) { compile_calls_ = b; }
+
 // Evaluate t, expecting a boolean value. Behavior is undefined if
 // t does not result in a boolean value.
 bool
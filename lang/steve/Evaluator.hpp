@@ -26,6 +26,21 @@ Term* reduce(Term*);
 bool eval_boolean(Term*);
 Integer eval_integer(Term*);
 
+// Statistics about the cache of compile-time function calls. A call
+// is cached when each of its arguments is a value.
+struct Call_cache_stats {
+  std::size_t hits;   // Calls answered from the cache
+  std::size_t misses; // Calls that were evaluated
+};
+
+Call_cache_stats call_cache_stats();
+void clear_call_cache();
+
+// Evaluation modes. By default, calls are cached and functions are
+// evaluated by compiled code when possible.
+void use_call_cache(bool);
+void use_compiled_evaluation(bool);
+
 } // namespace steve
 
 #endif
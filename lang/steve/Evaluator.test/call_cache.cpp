@@ -0,0 +1,108 @@
+// This program checks that a compile-time function call whose
+// arguments are values is evaluated once: a repeated call, even with
+// new argument nodes, is answered from the call cache and produces the
+// same value. Calls are checked with compiled evaluation and with
+// evaluation by substitution.
+//
+//    eval_call_cache
+
+#include <fstream>
+#include <iostream>
+
+#include <unistd.h>
+
+#include <steve/Config.hpp>
+#include <steve/Error.hpp>
+#include <steve/Evaluator.hpp>
+#include <steve/Language.hpp>
+#include <steve/Module.hpp>
+#include <steve/Type.hpp>
+
+using namespace steve;
+
+const char* fns_steve =
+  "def f(n : int) -> int = { return n * n + 1; }\n";
+
+// Returns the function defined with the given name in m.
+Fn*
+find_fn(Module* m, const char* name) {
+  for (Decl* d : *m->decls()) {
+    Def* def = as<Def>(d);
+    if (not def)
+      continue;
+    Basic_id* id = as<Basic_id>(def->name());
+    if (id and id->value() == String(name))
+      return as<Fn>(def->init());
+  }
+  return nullptr;
+}
+
+// Evaluate the call fn(n), whose argument is a new node, and check that
+// its value is expect and that it was a cache hit or a miss, as given.
+bool
+check_call(const char* step, Fn* fn, int n, int expect, bool hit) {
+  Expr* arg = make_expr<Int>(no_location, get_int_type(), Integer(n));
+  Expr* call = make_expr<Call>(no_location, fn->result(), fn, new Expr_seq {arg});
+
+  Call_cache_stats before = call_cache_stats();
+  Value v = eval(call).as_value();
+  Call_cache_stats after = call_cache_stats();
+  std::size_t hits = after.hits - before.hits;
+  std::size_t misses = after.misses - before.misses;
+
+  std::cout << step << ": " << v.as_integer() << ", "
+            << hits << " hits, " << misses << " misses\n";
+  bool ok = v.as_integer() == Integer(expect);
+  if (hit)
+    ok = ok and hits == 1 and misses == 0;
+  else
+    ok = ok and hits == 0 and misses == 1;
+  if (not ok)
+    std::cerr << "error: expected " << expect << " from a cache "
+              << (hit ? "hit" : "miss") << '\n';
+  return ok;
+}
+
+int
+main() {
+  char dir[] = "/tmp/steve-call-cache-XXXXXX";
+  if (not ::mkdtemp(dir) or ::chdir(dir) < 0) {
+    std::cerr << "error: cannot create a temporary directory\n";
+    return 1;
+  }
+  {
+    std::ofstream f("fns.steve");
+    f << fns_steve;
+  }
+
+  Configuration cfg;
+  Language lang;
+  Diagnostics diags;
+  Diagnostics_guard dg = diags;
+
+  Module* m = load_file("fns.steve");
+  Fn* f = m ? find_fn(m, "f") : nullptr;
+  if (not f) {
+    std::cerr << diags << "error: cannot load f\n";
+    return 1;
+  }
+
+  bool ok = true;
+  for (bool compiled : {true, false}) {
+    use_compiled_evaluation(compiled);
+    clear_call_cache();
+    std::cout << (compiled ? "compiled\n" : "substituted\n");
+    ok &= check_call("f(7)", f, 7, 50, false);
+    ok &= check_call("f(7) again", f, 7, 50, true);
+    ok &= check_call("f(8)", f, 8, 65, false);
+    ok &= check_call("f(7) after f(8)", f, 7, 50, true);
+  }
+
+  // Clearing the cache evaluates the next call again.
+  clear_call_cache();
+  ok &= check_call("f(7) after clear", f, 7, 50, false);
+
+  ::unlink("fns.steve");
+  ::rmdir(dir);
+  return ok ? 0 : 1;
+}
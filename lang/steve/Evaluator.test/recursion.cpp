@@ -0,0 +1,129 @@
+
+// This program compares compiled evaluation with evaluation by
+// substitution on a recursive compile-time function. The function
+// is a definition in the given module that takes a single integer
+// argument, such as fib in tests/lang/recursion-1.steve.
+//
+// The call cache is disabled so that every recursive call is
+// evaluated. The program also reports the number of heap allocations
+// made by each call.
+//
+//    eval_recursion <file> <function> <argument> [<iterations>]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#include <steve/Config.hpp>
+#include <steve/Error.hpp>
+#include <steve/Evaluator.hpp>
+#include <steve/Language.hpp>
+#include <steve/Module.hpp>
+#include <steve/Type.hpp>
+#include <steve/Value.hpp>
+
+using namespace steve;
+
+using Clock = std::chrono::steady_clock;
+
+// Allocation counter. This is updated by the replacement of the
+// global allocation function below.
+std::size_t allocs_ = 0;
+
+void*
+operator new(std::size_t n) {
+  ++allocs_;
+  if (void* p = std::malloc(n ? n : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void
+operator delete(void* p) noexcept { std::free(p); }
+
+void
+operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// Returns the function defined with the given name in m.
+Fn*
+find_fn(Module* m, const char* name) {
+  for (Decl* d : *m->decls()) {
+    Def* def = as<Def>(d);
+    if (not def)
+      continue;
+    Basic_id* id = as<Basic_id>(def->name());
+    if (id and id->value() == String(name))
+      return as<Fn>(def->init());
+  }
+  return nullptr;
+}
+
+// Statistics about the evaluation of a call.
+struct Run {
+  double time;          // Time per call, in microseconds
+  std::size_t allocs;   // Allocations per call
+};
+
+// Evaluate the call n times.
+Run
+run(Expr* call, int n, Value& result) {
+  std::size_t allocs = allocs_;
+  Clock::time_point start = Clock::now();
+  for (int i = 0; i < n; ++i)
+    result = eval(call).as_value();
+  Clock::duration time = Clock::now() - start;
+  using Usec = std::chrono::duration<double, std::micro>;
+  return {
+    std::chrono::duration_cast<Usec>(time).count() / n, 
+    (allocs_ - allocs) / n
+  };
+}
+
+int
+main(int argc, char* argv[]) {
+  if (argc < 4 or argc > 5) {
+    std::cerr << "usage: eval_recursion <file> <function> <argument> [<iterations>]\n";
+    return 1;
+  }
+  int iters = argc == 5 ? std::atoi(argv[4]) : 10;
+
+  Configuration cfg;
+  Language lang;
+  Diagnostics diags;
+  Diagnostics_guard dg = diags;
+
+  Module* m = load_file(argv[1]);
+  if (not m) {
+    std::cerr << "failed to load " << argv[1] << '\n';
+    return 1;
+  }
+  Fn* fn = find_fn(m, argv[2]);
+  if (not fn) {
+    std::cerr << "no function named " << argv[2] << '\n';
+    return 1;
+  }
+
+  Expr* arg = make_expr<Int>(no_location, get_int_type(), Integer(std::atol(argv[3])));
+  Expr_seq* args = new Expr_seq {arg};
+  Expr* call = make_expr<Call>(no_location, fn->result(), fn, args);
+
+  use_call_cache(false);
+  Value r1 = unit;
+  Value r2 = unit;
+  use_compiled_evaluation(true);
+  Run compiled = run(call, iters, r1);
+  use_compiled_evaluation(false);
+  Run substituted = run(call, iters, r2);
+
+  std::cout << argv[2] << '(' << argv[3] << ") = " << r1.as_integer() << '\n'
+            << "compiled:    " << compiled.time << " us/call, " 
+            << compiled.allocs << " allocations/call\n"
+            << "substituted: " << substituted.time << " us/call, " 
+            << substituted.allocs << " allocations/call\n";
+  if (r1.as_integer() != r2.as_integer()) {
+    std::cerr << "error: substitution computed " << r2.as_integer() << '\n';
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,70 @@
+
+// This program checks that substitutions map each parameter of a
+// function to its argument, for arities stored in place and for
+// those that use the hash table, and that building a substitution
+// for a small arity does not allocate.
+//
+//    eval_subst
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#include <steve/Language.hpp>
+#include <steve/Subst.hpp>
+
+using namespace steve;
+
+// Allocation counter. This is updated by the replacement of the
+// global allocation function below.
+std::size_t allocs_ = 0;
+
+void*
+operator new(std::size_t n) {
+  ++allocs_;
+  if (void* p = std::malloc(n ? n : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void
+operator delete(void* p) noexcept { std::free(p); }
+
+void
+operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// Check the substitution of n arguments for n parameters.
+bool
+check(std::size_t n) {
+  Decl_seq parms;
+  Expr_seq args;
+  for (std::size_t i = 0; i < n; ++i) {
+    parms.push_back(new Parm(new Basic_id("p"), nullptr, nullptr));
+    args.push_back(new Int(Integer(i)));
+  }
+  Decl* other = new Parm(new Basic_id("q"), nullptr, nullptr);
+
+  std::size_t allocs = allocs_;
+  Subst s {&parms, &args};
+  allocs = allocs_ - allocs;
+
+  bool ok = s.size() == n and not s.get(other);
+  for (std::size_t i = 0; i < n; ++i)
+    ok = ok and s.get(parms[i]) == args[i];
+  s.insert(parms.empty() ? other : parms[0], nullptr);
+  ok = ok and (n == 0 or s.get(parms[0]) == args[0]);
+  if (n <= 8)
+    ok = ok and allocs == 0;
+  if (not ok)
+    std::cerr << "substitution of " << n << " parameters failed\n";
+  return ok;
+}
+
+int
+main() {
+  Language lang;
+  bool ok = true;
+  for (std::size_t n = 0; n <= 40; ++n)
+    ok = check(n) and ok;
+  return ok ? 0 : 1;
+}
@@ -1,38 +1,195 @@
 
 #include <steve/File.hpp>
+#include <steve/Comment.hpp>
 #include <steve/Error.hpp>
+#include <steve/Scan.hpp>
 
-#include <fstream>
-#include <iterator>
+#include <algorithm>
+#include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace steve {
 
 // -------------------------------------------------------------------------- //
 // File
 
+namespace {
+
+// Throw the current system error.
+[[noreturn]] inline void
+throw_system_error() {
+  throw std::system_error(errno, std::generic_category());
+}
+
+// Returns the modification time of a file in nanoseconds.
+inline std::int64_t
+get_mtime(const struct stat& st) {
+  return std::int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+}
+
+// An RAII helper that closes a file descriptor.
+struct Descriptor_guard {
+  ~Descriptor_guard() { ::close(fd); }
+  int fd;
+};
+
+// The files that have reserved source offsets, ordered by their
+// base offsets. Files may be loaded by several threads at once, so
+// the offsets are guarded by a lock.
+std::vector<File*> sources_;
+std::mutex sources_mutex_;
+
+// The first unreserved source offset.
+Source_offset next_offset_ = 1;
+
+// Reserve n source offsets for the file f, storing the first in base.
+// The base is assigned before f is published, since other threads may
+// search the files as soon as it is.
+void
+reserve_offsets(File* f, std::size_t n, Source_offset& base) {
+  std::lock_guard<std::mutex> lock(sources_mutex_);
+  if (n >= std::numeric_limits<Source_offset>::max() - next_offset_)
+    throw std::length_error("source offset space exhausted");
+  base = next_offset_;
+  next_offset_ += n;
+  sources_.push_back(f);
+}
+
+// Release the source offsets reserved for the file f. Note that
+// offsets are never reused.
+void
+release_offsets(File* f) {
+  std::lock_guard<std::mutex> lock(sources_mutex_);
+  auto iter = std::find(sources_.begin(), sources_.end(), f);
+  if (iter != sources_.end())
+    sources_.erase(iter);
+}
+
+} // namespace
+
 // Initialize the file. This sets the path of the file to its
-// canonical 
-inline
-File::File(const Path& p)
-  : path_(fs::canonical(p)) 
+// canonical name and brings its text into memory according to
+// the requested mode.
+//
+// Only non-empty regular files are mapped. Everything else (empty
+// files, pipes, devices, etc.) is read into a buffer.
+File::File(const Path& p, File_mode m)
+  : path_(fs::canonical(p)), mode_(m), text_(nullptr), size_(0), mtime_(0)
 { 
-  using Iter = std::istreambuf_iterator<char>;
+  int fd = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    throw_system_error();
+  Descriptor_guard guard {fd};
+
+  struct stat st;
+  if (::fstat(fd, &st) < 0)
+    throw_system_error();
 
-  // Open the inpout file.
-  std::ifstream fs(path_.c_str());
-  if (not fs)
-    throw std::system_error(errno, std::generic_category());
+  mtime_ = get_mtime(st);
+  bool regular = S_ISREG(st.st_mode);
+  if (mode_ == mapped_file and regular and st.st_size > 0)
+    map(fd, st.st_size);
+  else
+    read(fd, regular ? st.st_size : 0);
 
-  // Copy the text to be returned.
-  //
-  // BUG: There's a libstdc++ bug that causes exceptions to be thrown
-  // when they aren't expected (e.g., underflow errors). 
+  // Reserve an offset for each character and one for the end of file.
+  // The destructor is not run if this fails, so unmap the text here.
   try {
-    text_ = std::string(Iter{fs}, Iter{});
-  } catch (...) { 
-    // This is probably not an error.
+    reserve_offsets(this, size_ + 1, base_);
+  } catch (...) {
+    if (mode_ == mapped_file)
+      ::munmap(const_cast<char*>(text_), size_);
+    throw;
+  }
+}
+
+// Returns true if the file has been modified or removed since it
+// was loaded. Note that only the modification time and size of the
+// file are compared.
+bool
+File::changed() const {
+  struct stat st;
+  if (::stat(path_.c_str(), &st) < 0)
+    return true;
+  return get_mtime(st) != mtime_ or std::size_t(st.st_size) != size_;
+}
+
+File::~File() {
+  release_offsets(this);
+  if (mode_ == mapped_file)
+    ::munmap(const_cast<char*>(text_), size_);
+}
+
+// Map the n bytes of the file into memory. The mapping remains valid
+// after the descriptor is closed. If the mapping fails, fall back to
+// reading the file.
+void
+File::map(int fd, std::size_t n) {
+  void* p = ::mmap(nullptr, n, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (p == MAP_FAILED) {
+    read(fd, n);
+    return;
+  }
+
+  // The lexer makes a single forward pass over the text.
+  ::madvise(p, n, MADV_SEQUENTIAL);
+  ::madvise(p, n, MADV_WILLNEED);
+  text_ = static_cast<const char*>(p);
+  size_ = n;
+}
+
+// Read the text of the file into a buffer. When the size n of the
+// file is known, this is a single bulk read. Note that we reserve an
+// extra byte so that end of file is detected without growing the
+// buffer. Otherwise, the buffer grows until the end of the input is
+// reached.
+void
+File::read(int fd, std::size_t n) {
+  mode_ = read_file;
+  buf_.resize(n ? n + 1 : 4096);
+  std::size_t len = 0;
+  while (true) {
+    if (len == buf_.size())
+      buf_.resize(2 * buf_.size());
+    ssize_t k = ::read(fd, &buf_[len], buf_.size() - len);
+    if (k < 0) {
+      if (errno == EINTR)
+        continue;
+      throw_system_error();
+    }
+    if (k == 0)
+      break;
+    len += k;
   }
+  buf_.resize(len);
+  text_ = buf_.data();
+  size_ = len;
+}
+
+// Returns the line and column of the source offset n, which must
+// be in the range of offsets reserved for this file. The first call
+// builds the line table for the file.
+Source_position
+File::position(Source_offset n) const {
+  steve_assert(base_ <= n and n <= base_ + size_, "offset not in file");
+  std::call_once(lines_once_, [this]() {
+    lines_.push_back(0);
+    for (const char* p = begin(); (p = find_newline(p, end())) != end(); )
+      lines_.push_back(++p - begin());
+  });
+  std::uint32_t k = n - base_;
+  auto iter = std::upper_bound(lines_.begin(), lines_.end(), k);
+  int line = iter - lines_.begin();
+  int col = k - *std::prev(iter) + 1;
+  return {line, col};
 }
 
 // -------------------------------------------------------------------------- //
@@ -44,18 +201,90 @@ using File_set = std::map<Path, File*>;
 
 // The set of loaded files.
 File_set files_;
+std::mutex files_mutex_;
+
+// Files that have been forgotten but not yet released.
+std::vector<File*> forgotten_;
 
 } // namespace
 
 // Get the file corresponding to the given path name. Each unique
-// path corresponds to a unique File object.
+// path corresponds to a unique File object. The mode m is used only
+// when the file is first loaded.
+//
+// The file is loaded without holding the lock, so that threads can
+// load different files at the same time. If two threads load the
+// same file, the first one to finish wins and the other's copy is
+// discarded.
 File*
-get_file(const Path& p) {
-  auto iter = files_.find(p);
-  if (iter == files_.end()) 
-    return files_.insert({p, new File(p)}).first->second;
-  else
-    return iter->second;
+get_file(const Path& p, File_mode m) {
+  {
+    std::lock_guard<std::mutex> lock(files_mutex_);
+    auto iter = files_.find(p);
+    if (iter != files_.end())
+      return iter->second;
+  }
+  std::unique_ptr<File> f(new File(p, m));
+  std::lock_guard<std::mutex> lock(files_mutex_);
+  auto ins = files_.insert({p, f.get()});
+  if (ins.second)
+    f.release();
+  return ins.first->second;
+}
+
+// Forget the file f, so that the next request for its path loads
+// the file again. The file is not destroyed, since locations in its
+// text may still be in use (see release_files).
+void
+forget_file(File* f) {
+  std::lock_guard<std::mutex> lock(files_mutex_);
+  for (auto iter = files_.begin(); iter != files_.end(); ) {
+    if (iter->second == f)
+      iter = files_.erase(iter);
+    else
+      ++iter;
+  }
+  forgotten_.push_back(f);
+}
+
+// Destroy the forgotten files, along with their comments. No location
+// in their text shall be in use.
+void
+release_files() {
+  std::vector<File*> fs;
+  {
+    std::lock_guard<std::mutex> lock(files_mutex_);
+    fs.swap(forgotten_);
+  }
+  for (File* f : fs) {
+    comments().clear(f);
+    delete f;
+  }
+}
+
+// Returns the paths of the loaded files.
+std::vector<Path>
+loaded_files() {
+  std::lock_guard<std::mutex> lock(files_mutex_);
+  std::vector<Path> paths;
+  for (auto& x : files_)
+    paths.push_back(x.first);
+  return paths;
+}
+
+// Returns the file whose reserved offsets include n, or nullptr
+// if there is no such file.
+File*
+find_file(Source_offset n) {
+  std::lock_guard<std::mutex> lock(sources_mutex_);
+  auto iter = std::upper_bound(sources_.begin(), sources_.end(), n, 
+    [](Source_offset n, const File* f) { return n < f->base(); });
+  if (iter == sources_.begin())
+    return nullptr;
+  File* f = *std::prev(iter);
+  if (n > f->base() + f->size())
+    return nullptr;
+  return f;
 }
 
 } // namespace steve
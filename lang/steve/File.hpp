@@ -10,6 +10,9 @@
 // codes between two different systems. It's fine for now, but not
 // ideal.
 
+#include <steve/Location.hpp>
+
+#include <mutex>
 #include <vector>
 
 #include <boost/filesystem.hpp>
@@ -34,31 +37,87 @@ using Path_list = std::vector<Path>;
 // -------------------------------------------------------------------------- //
 // Files
 
+// The file mode determines how the text of a file is brought into
+// memory.
+//
+//    - mapped_file -- The pages of the file are mapped directly into
+//      the address space of the program. The lexer iterates over those
+//      pages; no copy of the text is made. If the file cannot be mapped
+//      (e.g., it is a pipe or a character device), the file is read as
+//      if read_file had been given.
+//
+//    - read_file -- The text of the file is read into a single buffer
+//      owned by the file object.
+enum File_mode {
+  mapped_file,
+  read_file
+};
+
 // A file is a container of input source of a program and are
 // represented by a path to that file in the operating system.
 //
 // Note that files need not contain Steve programs; they can also
 // represent other input files to the system.
 //
+// The text of a file is an immutable, contiguous sequence of
+// characters in [begin(), end()). Note that the text is not
+// null terminated.
+//
 // TODO: What if I want an output file? Do I actually need file
 // modes or different kinds of file?
 class File {
 public:
-  File(const Path&);
+  using iterator = const char*;
+
+  File(const Path&, File_mode = mapped_file);
+  ~File();
+
+  File(const File&) = delete;
+  File& operator=(const File&) = delete;
 
   const Path& path() const;
-  const std::string& text() const;
+  File_mode mode() const;
+  bool changed() const;
+
+  // Text
+  const char* data() const;
+  std::size_t size() const;
+  iterator begin() const;
+  iterator end() const;
+
+  // Source offsets
+  Source_offset base() const;
+  Source_offset offset(iterator) const;
+  Source_position position(Source_offset) const;
 
 private:
-  Path        path_;
-  std::string text_;
+  void map(int, std::size_t);
+  void read(int, std::size_t);
+
+  Path          path_;
+  File_mode     mode_;
+  const char*   text_;
+  std::size_t   size_;
+  std::string   buf_;
+  Source_offset base_;
+  std::int64_t  mtime_; // The modification time when loaded, in ns
+
+  // The offsets of the first character of each line, relative
+  // to base_. This is computed on demand, possibly by several
+  // threads at once.
+  mutable std::vector<std::uint32_t> lines_;
+  mutable std::once_flag             lines_once_;
 };
 
 
 // -------------------------------------------------------------------------- //
 // File set
 
-File* get_file(const Path&);
+File* get_file(const Path&, File_mode = mapped_file);
+File* find_file(Source_offset);
+void forget_file(File*);
+void release_files();
+std::vector<Path> loaded_files();
 
 } // namespace steve
 
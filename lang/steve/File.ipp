@@ -4,7 +4,29 @@ namespace steve {
 inline const Path&
 File::path() const { return path_; }
 
-inline const std::string&
-File::text() const { return text_; }
+// Returns the mode in which the file was actually loaded. Note that
+// a file requested as mapped_file may have been read instead.
+inline File_mode
+File::mode() const { return mode_; }
+
+inline const char*
+File::data() const { return text_; }
+
+inline std::size_t
+File::size() const { return size_; }
+
+inline File::iterator
+File::begin() const { return text_; }
+
+inline File::iterator
+File::end() const { return text_ + size_; }
+
+// Returns the first offset reserved for the file.
+inline Source_offset
+File::base() const { return base_; }
+
+// Returns the source offset of the character at the position p.
+inline Source_offset
+File::offset(iterator p) const { return base_ + (p - text_); }
 
 } // namespace steve
@@ -0,0 +1,117 @@
+
+// This program compares the cost of loading source files into memory.
+// For each load strategy, a child process loads every .steve file
+// under the given directory (repeatedly), touches every byte, and
+// reports its elapsed time and peak resident set size.
+//
+//    file_load <dir> [<iterations>]
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <steve/File.hpp>
+
+using namespace steve;
+
+using Clock = std::chrono::steady_clock;
+using Paths = std::vector<Path>;
+
+// Collect the source files under the directory d.
+Paths
+find_sources(const Path& d) {
+  Paths ps;
+  for (fs::recursive_directory_iterator i(d), e; i != e; ++i)
+    if (i->path().extension() == ".steve")
+      ps.push_back(i->path());
+  return ps;
+}
+
+// Touch every byte in [first, last) so that pages are actually faulted
+// in for mapped files.
+std::size_t
+touch(const char* first, const char* last) {
+  std::size_t n = 0;
+  for (; first != last; ++first)
+    n += *first;
+  return n;
+}
+
+// Load files by copying them through a stream buffer. This is how
+// source text was loaded before files could be mapped.
+std::size_t
+load_stream(const Paths& ps) {
+  std::vector<std::string> texts;
+  std::size_t n = 0;
+  for (const Path& p : ps) {
+    std::ifstream f(p.string());
+    std::istreambuf_iterator<char> first(f), last;
+    texts.emplace_back(first, last);
+    n += touch(texts.back().data(), texts.back().data() + texts.back().size());
+  }
+  return n;
+}
+
+// Load files through the File class using the mode m.
+std::size_t
+load_file(const Paths& ps, File_mode m) {
+  std::vector<std::unique_ptr<File>> files;
+  std::size_t n = 0;
+  for (const Path& p : ps) {
+    files.emplace_back(new File(p, m));
+    n += touch(files.back()->begin(), files.back()->end());
+  }
+  return n;
+}
+
+// Run a single load strategy in a child process so that its peak
+// RSS is not polluted by the others.
+void
+run(const char* name, const Paths& ps, int iters, int strategy) {
+  std::cout.flush();
+  auto start = Clock::now();
+  pid_t pid = fork();
+  if (pid == 0) {
+    // Hold on to every iteration's files, so the RSS reflects the
+    // cost of keeping sources alive.
+    std::size_t n = 0;
+    for (int i = 0; i < iters; ++i) {
+      switch (strategy) {
+      case 0: n += load_stream(ps); break;
+      case 1: n += load_file(ps, read_file); break;
+      case 2: n += load_file(ps, mapped_file); break;
+      }
+    }
+    _exit(n == 0);
+  }
+
+  int status;
+  rusage ru;
+  wait4(pid, &status, 0, &ru);
+  auto stop = Clock::now();
+  auto ms = std::chrono::duration<double, std::milli>(stop - start).count();
+  std::cout << name << ": " << ms << " ms, "
+            << ru.ru_maxrss << " KB peak RSS\n";
+}
+
+int
+main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::cerr << "usage: file_load <dir> [<iterations>]\n";
+    return 1;
+  }
+  Paths ps = find_sources(argv[1]);
+  int iters = argc > 2 ? std::atoi(argv[2]) : 100;
+  std::cout << ps.size() << " files, " << iters << " iterations\n";
+  run("stream", ps, iters, 0);
+  run("read  ", ps, iters, 1);
+  run("mapped", ps, iters, 2);
+}
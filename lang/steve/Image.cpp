@@ -0,0 +1,1384 @@
+
+#include <steve/Image.hpp>
+#include <steve/Config.hpp>
+#include <steve/Intrinsic.hpp>
+#include <steve/Meta.hpp>
+#include <steve/Module.hpp>
+#include <steve/Type.hpp>
+#include <steve/Debug.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace steve {
+
+namespace {
+
+// -------------------------------------------------------------------------- //
+// Image layout
+
+// The format of images. This changes whenever the layout of an image
+// or the representation of a node changes.
+constexpr std::uint32_t image_format = 2;
+
+constexpr char image_magic[8] = {'S', 'T', 'E', 'V', 'E', 'M', 'O', 'D'};
+
+// The header of an image. Tables are given by their offset, in words,
+// from the start of the image and their number of entries.
+struct Image_header {
+  char magic[8];
+  std::uint32_t format;
+  std::uint32_t version;  // The compiler version (a string)
+  std::uint64_t hash;     // The hash of the module's source
+  std::uint64_t key;      // The module's key
+  std::uint32_t strings;  // The string table
+  std::uint32_t nstrings;
+  std::uint32_t deps;     // The dependency table
+  std::uint32_t ndeps;
+  std::uint32_t externs;  // The external reference table
+  std::uint32_t nexterns;
+  std::uint32_t nodes;    // The node table
+  std::uint32_t nnodes;
+  std::uint32_t root;     // The module's declarations
+  std::uint32_t size;     // The size of the image, in words
+};
+
+constexpr std::size_t header_words = sizeof(Image_header) / 4;
+
+// A string is its byte offset in the image and its size. The
+// characters are null terminated.
+constexpr std::size_t string_words = 2;
+
+// A dependency is its path, its name, its parent, whether it is a
+// directory, and the low and high words of its key.
+constexpr std::size_t dep_words = 6;
+
+// An external reference is a domain and the index of a node in that
+// domain. Domain 0 is the builtin declarations, and domain n is the
+// dependency n - 1. An index of none refers to the module itself.
+constexpr std::size_t extern_words = 2;
+
+// A record starts with its kind, its location, and references to its
+// type, definition, and context. A sequence starts with its kind, the
+// class of its elements, and its size.
+constexpr std::size_t record_words = 5;
+constexpr std::size_t seq_words = 3;
+
+constexpr std::uint32_t none = 0xffffffff;
+
+// The low two bits of a reference give its tag. A local reference
+// stores the (zigzag encoded) difference between the index of its
+// node and that of the referring record.
+enum Ref_tag : std::uint32_t {
+  special_ref,
+  local_ref,
+  extern_ref
+};
+
+enum Special_ref : std::uint32_t {
+  null_ref,
+  typename_ref,
+  unit_ref,
+  bool_ref,
+  nat_ref,
+  int_ref,
+  char_ref,
+  self_ref
+};
+
+inline std::uint32_t
+make_ref(Ref_tag t, std::uint32_t n) { return n << 2 | t; }
+
+inline Ref_tag
+get_ref_tag(std::uint32_t r) { return Ref_tag(r & 3); }
+
+inline std::uint32_t
+get_ref_value(std::uint32_t r) { return r >> 2; }
+
+// The class of the elements of a sequence.
+enum Elem_class : std::uint32_t {
+  expr_elem,
+  name_elem,
+  type_elem,
+  term_elem,
+  stmt_elem,
+  decl_elem
+};
+
+template<typename T> struct Elem_of;
+template<> struct Elem_of<Expr> : std::integral_constant<Elem_class, expr_elem> { };
+template<> struct Elem_of<Name> : std::integral_constant<Elem_class, name_elem> { };
+template<> struct Elem_of<Type> : std::integral_constant<Elem_class, type_elem> { };
+template<> struct Elem_of<Term> : std::integral_constant<Elem_class, term_elem> { };
+template<> struct Elem_of<Stmt> : std::integral_constant<Elem_class, stmt_elem> { };
+template<> struct Elem_of<Decl> : std::integral_constant<Elem_class, decl_elem> { };
+
+// Returns true if n is a node of the class T.
+inline bool
+is_a(const Node* n, Expr*) {
+  Node_class c = get_node_class(n->kind);
+  return name_class <= c and c <= decl_class;
+}
+
+inline bool
+is_a(const Node* n, Name*) { return is_name_node(n->kind); }
+
+inline bool
+is_a(const Node* n, Type*) { return is_type_node(n->kind); }
+
+inline bool
+is_a(const Node* n, Term*) {
+  Node_class c = get_node_class(n->kind);
+  return term_class <= c and c <= decl_class;
+}
+
+inline bool
+is_a(const Node* n, Stmt*) {
+  Node_class c = get_node_class(n->kind);
+  return stmt_class <= c and c <= decl_class;
+}
+
+inline bool
+is_a(const Node* n, Decl*) { return is_decl_node(n->kind); }
+
+// Returns true if n is a canonical type. Canonical types are always
+// saved by value, and read by finding or creating the same type.
+inline bool
+is_canonical(const Node* n) {
+  switch (n->kind) {
+  case fn_type:
+  case range_type:
+  case bitfield_type:
+  case net_str_type:
+  case net_seq_type:
+    return true;
+  default:
+    return false;
+  }
+}
+
+
+// -------------------------------------------------------------------------- //
+// Node operands
+//
+// The operands of each kind of node, in the order of its constructor.
+// Every expression also has a type, and types and terms may have a
+// definition, and declarations a context.
+
+inline std::tuple<String&> fields(Basic_id* n) { return std::tie(n->first); }
+inline std::tuple<String&> fields(Operator_id* n) { return std::tie(n->first); }
+inline std::tuple<Type*&, Name*&> fields(Scoped_id* n) { return std::tie(n->first, n->second); }
+inline std::tuple<Term*&, Expr_seq*&> fields(Indexed_id* n) { return std::tie(n->first, n->second); }
+inline std::tuple<Name*&, Decl*&> fields(Decl_id* n) { return std::tie(n->first, n->second); }
+
+inline std::tuple<> fields(Typename_type*) { return {}; }
+inline std::tuple<> fields(Unit_type*) { return {}; }
+inline std::tuple<> fields(Bool_type*) { return {}; }
+inline std::tuple<> fields(Nat_type*) { return {}; }
+inline std::tuple<> fields(Int_type*) { return {}; }
+inline std::tuple<> fields(Char_type*) { return {}; }
+inline std::tuple<Type_seq*&, Type*&> fields(Fn_type* n) { return std::tie(n->first, n->second); }
+inline std::tuple<Type*&> fields(Range_type* n) { return std::tie(n->first); }
+inline std::tuple<Type*&, Term*&, Term*&> fields(Bitfield_type* n) { return std::tie(n->first, n->second, n->third); }
+inline std::tuple<Decl_seq*&> fields(Record_type* n) { return std::tie(n->first); }
+inline std::tuple<Decl_seq*&> fields(Variant_type* n) { return std::tie(n->first); }
+inline std::tuple<Decl*&, Decl_seq*&> fields(Dep_variant_type* n) { return std::tie(n->first, n->second); }
+inline std::tuple<Type*&, Expr_seq*&> fields(Enum_type* n) { return std::tie(n->first, n->second); }
+inline std::tuple<Type*&, Term*&> fields(Array_type* n) { return std::tie(n->first, n->second); }
+inline std::tuple<Term*&, Expr_seq*&> fields(Dep_type* n) { return std::tie(n->first, n->second); }
+inline std::tuple<Term*&> fields(Net_str_type* n) { return std::tie(n->first); }
+inline std::tuple<Type*&, Term*&> fields(Net_seq_type* n) { return std::tie(n->first, n->second); }
+
+inline std::tuple<> fields(Unit*) { return {}; }
+inline std::tuple<bool&> fields(Bool* n) { return std::tie(n->first); }
+inline std::tuple<Integer&> fields(Int* n) { return std::tie(n->first); }
+inline std::tuple<> fields(Default*) { return {}; }
+inline std::tuple<Decl_seq*&, Type*&, Expr*&> fields(Fn* n) { return std::tie(n->first, n->second, n->third); }
+inline std::tuple<Term*&, Expr_seq*&> fields(Call* n) { return std::tie(n->first, n->second); }
+inline std::tuple<Expr*&, Type*&> fields(Promo* n) { return std::tie(n->first, n->second); }
+inline std::tuple<Expr*&, Type*&> fields(Pred* n) { return std::tie(n->first, n->second); }
+inline std::tuple<Term*&, Term*&> fields(Range* n) { return std::tie(n->first, n->second); }
+inline std::tuple<Expr*&, Term*&> fields(Variant* n) { return std::tie(n->first, n->second); }
+inline std::tuple<Decl*&, Expr*&> fields(Unary* n) { return std::tie(n->first, n->second); }
+inline std::tuple<Term*&, Expr*&, Expr*&> fields(Binary* n) { return std::tie(n->first, n->second, n->third); }
+inline std::tuple<Term*&, Expr*&, Expr*&> fields(If* n) { return std::tie(n->first, n->second, n->third); }
+
+inline std::tuple<Stmt_seq*&> fields(Block* n) { return std::tie(n->first); }
+inline std::tuple<Expr*&> fields(Return* n) { return std::tie(n->first); }
+inline std::tuple<Term*&, Stmt*&> fields(While* n) { return std::tie(n->first, n->second); }
+inline std::tuple<> fields(Break*) { return {}; }
+inline std::tuple<> fields(Continue*) { return {}; }
+inline std::tuple<Expr*&, Stmt*&> fields(Switch* n) { return std::tie(n->first, n->second); }
+inline std::tuple<Expr*&, Expr*&> fields(Case* n) { return std::tie(n->first, n->second); }
+
+inline std::tuple<Name*&, Type*&, Expr*&> fields(Def* n) { return std::tie(n->first, n->second, n->third); }
+inline std::tuple<Name*&, Type*&, Expr*&> fields(Parm* n) { return std::tie(n->first, n->second, n->third); }
+inline std::tuple<Name*&, Type*&, Term*&> fields(Field* n) { return std::tie(n->first, n->second, n->third); }
+inline std::tuple<Expr*&, Type*&> fields(Alt* n) { return std::tie(n->first, n->second); }
+inline std::tuple<Name*&, Expr*&> fields(Enum* n) { return std::tie(n->first, n->second); }
+inline std::tuple<Name*&, Type*&> fields(Import* n) { return std::tie(n->first, n->second); }
+inline std::tuple<Name*&, Decl*&> fields(Using* n) { return std::tie(n->first, n->second); }
+
+template<typename T>
+  using Fields = decltype(fields(static_cast<T*>(nullptr)));
+
+// The number of words used to store an operand.
+template<typename T>
+  struct Field_words : std::integral_constant<std::size_t, 1> { };
+
+template<>
+  struct Field_words<Integer&> : std::integral_constant<std::size_t, 2> { };
+
+template<typename T>
+  struct Record_words;
+
+template<>
+  struct Record_words<std::tuple<>>
+    : std::integral_constant<std::size_t, record_words> { };
+
+template<typename F, typename... Fs>
+  struct Record_words<std::tuple<F, Fs...>>
+    : std::integral_constant<std::size_t,
+        Field_words<F>::value + Record_words<std::tuple<Fs...>>::value> { };
+
+// The operands of a node, by value.
+template<typename T>
+  struct Values_of;
+
+template<typename... Fs>
+  struct Values_of<std::tuple<Fs&...>> { using type = std::tuple<Fs...>; };
+
+// Allocate a node of type T with a location and empty operands.
+template<typename T, typename... Fs>
+  inline T*
+  make_shell(const Location& l, std::tuple<Fs&...>*) { return new T(l, Fs()...); }
+
+template<typename T, typename... Vs, std::size_t... Is>
+  inline T*
+  make_canonical(const Location& l, Type* t, std::tuple<Vs...>& vs, Indices<Is...>) {
+    return make_expr<T>(l, t, std::get<Is>(vs)...);
+  }
+
+inline Decl* get_def(Expr*) { return nullptr; }
+inline Decl* get_def(Type* t) { return t->def_; }
+inline Decl* get_def(Term* t) { return t->def_; }
+
+inline Expr* get_cxt(Expr*) { return nullptr; }
+inline Expr* get_cxt(Decl* d) { return d->cxt_; }
+
+// Note that a canonical type is not bound to a definition.
+inline void set_def(Expr*, Decl*) { }
+inline void set_def(Type* t, Decl* d) { if (not is_canonical_type(t)) t->def_ = d; }
+inline void set_def(Term* t, Decl* d) { t->def_ = d; }
+
+inline void set_cxt(Expr*, Expr*) { }
+inline void set_cxt(Decl* d, Expr* e) { d->cxt_ = e; }
+
+// Call f with n converted to the node class of kind k. Returns false
+// if nodes of that kind are not saved in images.
+template<typename F>
+  bool
+  dispatch(Node_kind k, Node* n, F& f) {
+    switch (k) {
+    // Names
+    case basic_id: return f(static_cast<Basic_id*>(n));
+    case operator_id: return f(static_cast<Operator_id*>(n));
+    case scoped_id: return f(static_cast<Scoped_id*>(n));
+    case indexed_id: return f(static_cast<Indexed_id*>(n));
+    case decl_id: return f(static_cast<Decl_id*>(n));
+    // Types
+    case typename_type: return f(static_cast<Typename_type*>(n));
+    case unit_type: return f(static_cast<Unit_type*>(n));
+    case bool_type: return f(static_cast<Bool_type*>(n));
+    case nat_type: return f(static_cast<Nat_type*>(n));
+    case int_type: return f(static_cast<Int_type*>(n));
+    case char_type: return f(static_cast<Char_type*>(n));
+    case fn_type: return f(static_cast<Fn_type*>(n));
+    case range_type: return f(static_cast<Range_type*>(n));
+    case bitfield_type: return f(static_cast<Bitfield_type*>(n));
+    case record_type: return f(static_cast<Record_type*>(n));
+    case variant_type: return f(static_cast<Variant_type*>(n));
+    case dep_variant_type: return f(static_cast<Dep_variant_type*>(n));
+    case enum_type: return f(static_cast<Enum_type*>(n));
+    case array_type: return f(static_cast<Array_type*>(n));
+    case dep_type: return f(static_cast<Dep_type*>(n));
+    case net_str_type: return f(static_cast<Net_str_type*>(n));
+    case net_seq_type: return f(static_cast<Net_seq_type*>(n));
+    // Terms
+    case unit_term: return f(static_cast<Unit*>(n));
+    case bool_term: return f(static_cast<Bool*>(n));
+    case int_term: return f(static_cast<Int*>(n));
+    case default_term: return f(static_cast<Default*>(n));
+    case fn_term: return f(static_cast<Fn*>(n));
+    case builtin_term: return f(static_cast<Builtin*>(n));
+    case call_term: return f(static_cast<Call*>(n));
+    case promo_term: return f(static_cast<Promo*>(n));
+    case pred_term: return f(static_cast<Pred*>(n));
+    case range_term: return f(static_cast<Range*>(n));
+    case variant_term: return f(static_cast<Variant*>(n));
+    case unary_term: return f(static_cast<Unary*>(n));
+    case binary_term: return f(static_cast<Binary*>(n));
+    case if_term: return f(static_cast<If*>(n));
+    // Statements
+    case block_stmt: return f(static_cast<Block*>(n));
+    case return_stmt: return f(static_cast<Return*>(n));
+    case while_stmt: return f(static_cast<While*>(n));
+    case break_stmt: return f(static_cast<Break*>(n));
+    case continue_stmt: return f(static_cast<Continue*>(n));
+    case switch_stmt: return f(static_cast<Switch*>(n));
+    case case_stmt: return f(static_cast<Case*>(n));
+    // Declarations
+    case def_decl: return f(static_cast<Def*>(n));
+    case parm_decl: return f(static_cast<Parm*>(n));
+    case field_decl: return f(static_cast<Field*>(n));
+    case alt_decl: return f(static_cast<Alt*>(n));
+    case enum_decl: return f(static_cast<Enum*>(n));
+    case import_decl: return f(static_cast<Import*>(n));
+    case using_decl: return f(static_cast<Using*>(n));
+    default: return false;
+    }
+  }
+
+// Returns the 64-bit FNV-1a hash of the n bytes in p.
+std::uint64_t
+hash_bytes(const char* p, std::size_t n) {
+  std::uint64_t h = 14695981039346656037ull;
+  for (std::size_t i = 0; i < n; ++i) {
+    h ^= static_cast<unsigned char>(p[i]);
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+
+// -------------------------------------------------------------------------- //
+// Node tables
+//
+// The node table of each module that has been saved or read, and the
+// node table of the builtin declarations. A node that appears in one
+// of these tables is referred to by other images through that table.
+
+struct Module_info {
+  std::uint64_t hash = 0;  // The hash of the module's source
+  std::uint64_t key = 0;   // The hash of its source and its imports
+  std::vector<Node*> nodes; // The module's node table
+};
+
+std::unordered_map<const Module*, Module_info> modules_;
+
+// The table, and index in that table, of a node. The module is null
+// for the builtin declarations.
+struct Extern {
+  const Module* mod;
+  std::uint32_t index;
+};
+
+std::unordered_map<const Node*, Extern> externs_;
+
+// Record the node table of the module m.
+void
+register_nodes(const Module* m, std::vector<Node*>&& nodes) {
+  for (std::size_t i = 0; i < nodes.size(); ++i)
+    externs_.emplace(nodes[i], Extern{m, std::uint32_t(i)});
+  if (m)
+    modules_[m].nodes = std::move(nodes);
+}
+
+
+// -------------------------------------------------------------------------- //
+// Image writer
+//
+// Nodes are added to the table when they are first referred to, and
+// their records are written in the order of the table.
+
+struct Image_writer {
+  Image_writer(Module*, Arena*, const File*);
+
+  bool run(Decl_seq*);
+  void image(std::uint64_t, std::uint64_t, std::vector<std::uint32_t>&);
+
+  std::uint32_t fail();
+  std::uint32_t ref(Node*);
+  std::uint32_t local(Node*);
+  std::uint32_t external(std::uint32_t, std::uint32_t);
+  std::uint32_t dep(Module*);
+  std::uint32_t string(String);
+  std::uint32_t location(const Location&);
+
+  template<typename T> void put(T*);
+  template<typename T> void put(Seq<T>*);
+  void put(String);
+  void put(bool);
+  void put(const Integer&);
+
+  template<typename F, std::size_t... Is>
+    void put_all(F&&, Indices<Is...>);
+
+  void emit(Node*);
+  template<typename T> void emit_seq(Seq<T>*);
+
+  template<typename T> bool operator()(T*);
+  bool operator()(Builtin*);
+
+  Module* mod;       // The module being saved, null for the builtins
+  Arena* arena;      // The arena of the module
+  const File* file;  // The source of the module
+  bool ok;
+  std::uint32_t self;
+
+  std::vector<Node*> nodes;
+  std::unordered_map<const Node*, std::uint32_t> index;
+  std::unordered_map<const Node*, Elem_class> seqs;
+  std::vector<std::uint32_t> offsets;
+  std::vector<std::uint32_t> records;
+
+  std::vector<String> strings;
+  std::unordered_map<String, std::uint32_t> string_index;
+  std::vector<std::uint32_t> deps;
+  std::unordered_map<const Module*, std::uint32_t> dep_index;
+  std::vector<std::uint32_t> externs;
+  std::map<std::pair<std::uint32_t, std::uint32_t>, std::uint32_t> extern_index;
+};
+
+Image_writer::Image_writer(Module* m, Arena* a, const File* f)
+  : mod(m), arena(a), file(f), ok(true), self(0)
+{ }
+
+// Number and write the nodes reachable from the declarations ds.
+bool
+Image_writer::run(Decl_seq* ds) {
+  put(ds);
+  for (self = 0; self < nodes.size() and ok; ++self)
+    emit(nodes[self]);
+  return ok;
+}
+
+std::uint32_t
+Image_writer::fail() {
+  ok = false;
+  return 0;
+}
+
+// Returns a reference to the node n.
+//
+// A declaration can only be saved by the module that owns it, so a
+// reference to a declaration in another module that is not in that
+// module's table cannot be saved.
+std::uint32_t
+Image_writer::ref(Node* n) {
+  if (not n)
+    return make_ref(special_ref, null_ref);
+  if (n == get_typename_type())
+    return make_ref(special_ref, typename_ref);
+  if (n == get_unit_type())
+    return make_ref(special_ref, unit_ref);
+  if (n == get_bool_type())
+    return make_ref(special_ref, bool_ref);
+  if (n == get_nat_type())
+    return make_ref(special_ref, nat_ref);
+  if (n == get_int_type())
+    return make_ref(special_ref, int_ref);
+  if (n == get_char_type())
+    return make_ref(special_ref, char_ref);
+  if (Module* m = as<Module>(n)) {
+    if (m == mod)
+      return make_ref(special_ref, self_ref);
+    return external(dep(m) + 1, none);
+  }
+  if (is_canonical(n))
+    return local(n);
+
+  auto iter = externs_.find(n);
+  if (iter != externs_.end() and iter->second.mod != mod) {
+    const Extern& x = iter->second;
+    return external(x.mod ? dep(const_cast<Module*>(x.mod)) + 1 : 0, x.index);
+  }
+  if (arena and is_decl_node(n->kind) and not arena->owns(n))
+    return fail();
+  return local(n);
+}
+
+std::uint32_t
+Image_writer::local(Node* n) {
+  auto ins = index.emplace(n, nodes.size());
+  if (ins.second)
+    nodes.push_back(n);
+  std::int64_t d = std::int64_t(ins.first->second) - self;
+  std::uint64_t z = d >= 0 ? 2 * d : -2 * d - 1;
+  if (z >= (1u << 30))
+    return fail();
+  return make_ref(local_ref, z);
+}
+
+std::uint32_t
+Image_writer::external(std::uint32_t d, std::uint32_t n) {
+  auto ins = extern_index.emplace(std::make_pair(d, n), extern_index.size());
+  if (ins.second) {
+    externs.push_back(d);
+    externs.push_back(n);
+  }
+  return make_ref(extern_ref, ins.first->second);
+}
+
+// Returns the index of the dependency on the module m. A module that
+// was loaded as part of a directory module depends on that directory.
+std::uint32_t
+Image_writer::dep(Module* m) {
+  auto iter = dep_index.find(m);
+  if (iter != dep_index.end())
+    return iter->second;
+
+  Basic_id* id = as<Basic_id>(m->name());
+  if (not id)
+    return fail();
+  bool dir = fs::is_directory(m->path());
+  std::uint64_t key = 0;
+  if (not dir) {
+    auto info = modules_.find(m);
+    if (info == modules_.end() or not info->second.key)
+      return fail();
+    key = info->second.key;
+  }
+  std::uint32_t parent = none;
+  if (Module* p = get_module(m->path().parent_path()))
+    if (p != mod and fs::is_directory(p->path()))
+      parent = dep(p);
+
+  std::uint32_t n = dep_index.size();
+  dep_index.emplace(m, n);
+  deps.push_back(string(m->path().string()));
+  deps.push_back(string(id->value()));
+  deps.push_back(parent);
+  deps.push_back(dir);
+  deps.push_back(key);
+  deps.push_back(key >> 32);
+  return n;
+}
+
+std::uint32_t
+Image_writer::string(String s) {
+  if (not s)
+    return none;
+  auto ins = string_index.emplace(s, strings.size());
+  if (ins.second)
+    strings.push_back(s);
+  return ins.first->second;
+}
+
+// Locations are saved relative to the start of the module's source.
+// Locations in other files are not saved.
+std::uint32_t
+Image_writer::location(const Location& l) {
+  Source_offset n = l.offset();
+  if (file and file->base() <= n and n <= file->base() + file->size())
+    return n - file->base() + 1;
+  return 0;
+}
+
+template<typename T>
+  inline void
+  Image_writer::put(T* p) { records.push_back(ref(p)); }
+
+template<typename T>
+  inline void
+  Image_writer::put(Seq<T>* s) {
+    if (s)
+      seqs.emplace(s, Elem_of<T>::value);
+    records.push_back(ref(s));
+  }
+
+inline void
+Image_writer::put(String s) { records.push_back(string(s)); }
+
+inline void
+Image_writer::put(bool b) { records.push_back(b); }
+
+// An integer is saved as its digits in its own base.
+void
+Image_writer::put(const Integer& n) {
+  int base = n.base();
+  Integer::Mpz_view z = n.data();
+  std::string s(mpz_sizeinbase(z, base) + 2, '\0');
+  mpz_get_str(&s[0], base, z);
+  s.resize(std::strlen(s.c_str()));
+  records.push_back(string(s));
+  records.push_back(base);
+}
+
+template<typename F, std::size_t... Is>
+  inline void
+  Image_writer::put_all(F&& fs, Indices<Is...>) {
+    using Expand = int[];
+    (void)Expand{0, (put(std::get<Is>(fs)), 0)...};
+  }
+
+void
+Image_writer::emit(Node* n) {
+  offsets.push_back(records.size());
+  if (n->kind != seq_node) {
+    if (not dispatch(n->kind, n, *this))
+      ok = false;
+    return;
+  }
+  auto iter = seqs.find(n);
+  if (iter == seqs.end()) {
+    ok = false;
+    return;
+  }
+  switch (iter->second) {
+  case expr_elem: return emit_seq(static_cast<Expr_seq*>(n));
+  case name_elem: return emit_seq(static_cast<Seq<Name>*>(n));
+  case type_elem: return emit_seq(static_cast<Type_seq*>(n));
+  case term_elem: return emit_seq(static_cast<Term_seq*>(n));
+  case stmt_elem: return emit_seq(static_cast<Stmt_seq*>(n));
+  case decl_elem: return emit_seq(static_cast<Decl_seq*>(n));
+  }
+}
+
+template<typename T>
+  void
+  Image_writer::emit_seq(Seq<T>* s) {
+    records.push_back(seq_node);
+    records.push_back(Elem_of<T>::value);
+    records.push_back(s->size());
+    for (T* e : *s)
+      put(e);
+  }
+
+template<typename T>
+  bool
+  Image_writer::operator()(T* n) {
+    records.push_back(Node_kind(T::Kind));
+    records.push_back(location(n->loc));
+    records.push_back(ref(n->type_));
+    records.push_back(ref(get_def(n)));
+    records.push_back(ref(get_cxt(n)));
+    using Size = std::tuple_size<Fields<T>>;
+    put_all(fields(n), typename Make_indices<Size::value>::type());
+    return true;
+  }
+
+// Builtin functions are only numbered in the table of builtin
+// declarations. Every other reference to one is external.
+bool
+Image_writer::operator()(Builtin* n) {
+  records.push_back(builtin_term);
+  records.push_back(0);
+  records.push_back(ref(n->type_));
+  records.push_back(ref(n->def_));
+  records.push_back(0);
+  return not mod;
+}
+
+// Assemble the image of a module with the given hash and key.
+void
+Image_writer::image(std::uint64_t hash, std::uint64_t key, std::vector<std::uint32_t>& img) {
+  std::uint32_t version = string(steve_version);
+
+  std::size_t strings_at = header_words;
+  std::size_t deps_at = strings_at + strings.size() * string_words;
+  std::size_t externs_at = deps_at + deps.size();
+  std::size_t nodes_at = externs_at + externs.size();
+  std::size_t records_at = nodes_at + offsets.size();
+  std::size_t chars_at = records_at + records.size();
+
+  std::vector<std::uint32_t> table;
+  std::string chars;
+  for (String s : strings) {
+    table.push_back(chars_at * 4 + chars.size());
+    table.push_back(s.size());
+    chars.append(s.data(), s.size());
+    chars.push_back('\0');
+  }
+
+  img.assign(chars_at + (chars.size() + 3) / 4, 0);
+  Image_header h;
+  std::memcpy(h.magic, image_magic, sizeof(h.magic));
+  h.format = image_format;
+  h.version = version;
+  h.hash = hash;
+  h.key = key;
+  h.strings = strings_at;
+  h.nstrings = strings.size();
+  h.deps = deps_at;
+  h.ndeps = deps.size() / dep_words;
+  h.externs = externs_at;
+  h.nexterns = externs.size() / extern_words;
+  h.nodes = nodes_at;
+  h.nnodes = offsets.size();
+  h.root = make_ref(local_ref, 0);
+  h.size = img.size();
+  std::memcpy(img.data(), &h, sizeof(h));
+
+  std::copy(table.begin(), table.end(), img.begin() + strings_at);
+  std::copy(deps.begin(), deps.end(), img.begin() + deps_at);
+  std::copy(externs.begin(), externs.end(), img.begin() + externs_at);
+  for (std::size_t i = 0; i < offsets.size(); ++i)
+    img[nodes_at + i] = records_at + offsets[i];
+  std::copy(records.begin(), records.end(), img.begin() + records_at);
+  std::memcpy(img.data() + chars_at, chars.data(), chars.size());
+}
+
+// Returns the node table of the builtin declarations, numbering them
+// if needed. This must be done before any other table is registered.
+const std::vector<Node*>&
+builtin_nodes() {
+  static bool init = false;
+  static std::vector<Node*> nodes;
+  if (not init) {
+    init = true;
+    Image_writer w(nullptr, nullptr, nullptr);
+    w.run(get_builtins());
+    nodes = w.nodes;
+    register_nodes(nullptr, std::move(w.nodes));
+  }
+  return nodes;
+}
+
+// Write the image to the file at path p. The image is written to a
+// temporary file which then replaces p, so that an image is never
+// read while it is partially written.
+bool
+write_image(const Path& p, const std::vector<std::uint32_t>& img) {
+  boost::system::error_code ec;
+  fs::create_directories(p.parent_path(), ec);
+  Path tmp = p;
+  tmp += format(".{}", getpid());
+  {
+    std::ofstream os(tmp.string(), std::ios::binary);
+    os.write(reinterpret_cast<const char*>(img.data()), img.size() * 4);
+    if (not os) {
+      fs::remove(tmp, ec);
+      return false;
+    }
+  }
+  fs::rename(tmp, p, ec);
+  if (ec) {
+    fs::remove(tmp, ec);
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+
+// -------------------------------------------------------------------------- //
+// Images
+
+struct Image {
+  ~Image();
+
+  void* map;                   // The mapped file
+  std::size_t bytes;           // The size of the file
+  const std::uint32_t* words;  // The words of the image
+  const Image_header* header;
+  std::vector<Image_dep> deps;
+};
+
+Image::~Image() {
+  if (map)
+    ::munmap(map, bytes);
+}
+
+namespace {
+
+// Thrown when an image cannot be read.
+struct Bad_image { };
+
+// Computes the size of a record.
+struct Record_size {
+  template<typename T>
+    bool operator()(T*) {
+      size = Record_words<Fields<T>>::value;
+      return true;
+    }
+
+  bool operator()(Builtin*) { return false; }
+
+  std::size_t size;
+};
+
+// Returns the string at index n of the image, or an empty string if
+// n is none.
+String
+get_string(const Image& img, std::uint32_t n) {
+  if (n == none)
+    return String();
+  if (n >= img.header->nstrings)
+    throw Bad_image();
+  const std::uint32_t* s = img.words + img.header->strings + n * string_words;
+  const char* p = reinterpret_cast<const char*>(img.words) + s[0];
+  return String(p, s[1]);
+}
+
+// Check that each table of the image is in bounds, and that each
+// record is a known node of the right size.
+bool
+check_image(Image& img, std::uint64_t hash) {
+  const Image_header& h = *img.header;
+  std::size_t size = img.bytes / 4;
+  if (std::memcmp(h.magic, image_magic, sizeof(h.magic)) != 0)
+    return false;
+  if (h.format != image_format or h.hash != hash or h.size != size)
+    return false;
+  auto in_bounds = [size](std::size_t first, std::size_t n, std::size_t k) {
+    return first <= size and n <= (size - first) / k;
+  };
+  if (not in_bounds(h.strings, h.nstrings, string_words) or
+      not in_bounds(h.deps, h.ndeps, dep_words) or
+      not in_bounds(h.externs, h.nexterns, extern_words) or
+      not in_bounds(h.nodes, h.nnodes, 1) or
+      h.nnodes == 0)
+    return false;
+
+  // Strings.
+  const char* chars = reinterpret_cast<const char*>(img.words);
+  for (std::size_t i = 0; i < h.nstrings; ++i) {
+    const std::uint32_t* s = img.words + h.strings + i * string_words;
+    if (s[0] >= img.bytes or s[1] >= img.bytes - s[0] or chars[s[0] + s[1]])
+      return false;
+  }
+
+  try {
+    if (get_string(img, h.version) != steve_version)
+      return false;
+
+    // Dependencies.
+    for (std::size_t i = 0; i < h.ndeps; ++i) {
+      const std::uint32_t* d = img.words + h.deps + i * dep_words;
+      if (d[2] != none and d[2] >= i)
+        return false;
+      Image_dep dep;
+      dep.path = get_string(img, d[0]).str();
+      dep.id = get_string(img, d[1]);
+      dep.parent = d[2] == none ? -1 : int(d[2]);
+      dep.dir = d[3];
+      dep.key = d[4] | std::uint64_t(d[5]) << 32;
+      img.deps.push_back(dep);
+    }
+  } catch (Bad_image&) {
+    return false;
+  }
+
+  // External references.
+  for (std::size_t i = 0; i < h.nexterns; ++i) {
+    const std::uint32_t* x = img.words + h.externs + i * extern_words;
+    if (x[0] > h.ndeps or (x[0] == 0 and x[1] == none))
+      return false;
+  }
+
+  // Records.
+  for (std::size_t i = 0; i < h.nnodes; ++i) {
+    std::uint32_t n = img.words[h.nodes + i];
+    if (n >= size or size - n < seq_words)
+      return false;
+    const std::uint32_t* r = img.words + n;
+    if (r[0] == seq_node) {
+      if (r[1] > decl_elem or r[2] > size - n - seq_words)
+        return false;
+    } else {
+      Record_size rs;
+      if (not dispatch(r[0], nullptr, rs) or rs.size > size - n)
+        return false;
+    }
+  }
+  return true;
+}
+
+
+// -------------------------------------------------------------------------- //
+// Image reader
+//
+// Nodes are read on demand, starting from the module's declarations.
+// A node (other than a canonical type) is allocated before its operands
+// are read, so references may be cyclic.
+
+struct Image_reader {
+  Image_reader(Image&, Module*, const File&, const std::vector<Module*>&);
+
+  const std::uint32_t* record(std::uint32_t);
+  Node* node(std::uint32_t);
+  Node* resolve(std::uint32_t);
+  std::uint32_t local(std::uint32_t);
+  String string(std::uint32_t);
+  Location location(std::uint32_t);
+
+  template<typename T> T* ptr(std::uint32_t);
+  template<typename T> Seq<T>* seq(std::uint32_t);
+
+  template<typename T> void get(T*&, const std::uint32_t*&);
+  template<typename T> void get(Seq<T>*&, const std::uint32_t*&);
+  void get(String&, const std::uint32_t*&);
+  void get(bool&, const std::uint32_t*&);
+  void get(Integer&, const std::uint32_t*&);
+
+  template<typename F, std::size_t... Is>
+    void get_all(F&&, const std::uint32_t*, Indices<Is...>);
+
+  template<typename T> Node* load_seq(const std::uint32_t*);
+  template<typename T> void load(std::false_type);
+  template<typename T> void load(std::true_type);
+
+  template<typename T> bool operator()(T*);
+  bool operator()(Builtin*) { return false; }
+
+  Image& img;
+  Module* mod;
+  const File& file;
+  const std::vector<Module*>& deps;
+  std::uint32_t self;   // The record being read
+  std::vector<Node*> nodes;
+  std::vector<bool> busy;
+  std::vector<String> strings;
+};
+
+Image_reader::Image_reader(Image& i, Module* m, const File& f, const std::vector<Module*>& ds)
+  : img(i), mod(m), file(f), deps(ds), self(0)
+  , nodes(i.header->nnodes), busy(i.header->nnodes), strings(i.header->nstrings)
+{ }
+
+inline const std::uint32_t*
+Image_reader::record(std::uint32_t n) { return img.words + img.words[img.header->nodes + n]; }
+
+// Returns the node at index n, reading it if needed.
+Node*
+Image_reader::node(std::uint32_t n) {
+  if (Node* p = nodes[n])
+    return p;
+  if (busy[n])
+    throw Bad_image();
+  std::uint32_t saved = self;
+  self = n;
+  const std::uint32_t* r = record(n);
+  if (r[0] == seq_node) {
+    switch (r[1]) {
+    case expr_elem: load_seq<Expr>(r); break;
+    case name_elem: load_seq<Name>(r); break;
+    case type_elem: load_seq<Type>(r); break;
+    case term_elem: load_seq<Term>(r); break;
+    case stmt_elem: load_seq<Stmt>(r); break;
+    case decl_elem: load_seq<Decl>(r); break;
+    }
+  } else {
+    dispatch(r[0], nullptr, *this);
+  }
+  self = saved;
+  return nodes[n];
+}
+
+// Returns the index of the node to which the local reference r refers.
+std::uint32_t
+Image_reader::local(std::uint32_t r) {
+  std::uint32_t z = get_ref_value(r);
+  std::int64_t n = self + (z & 1 ? -std::int64_t(z >> 1) - 1 : std::int64_t(z >> 1));
+  if (n < 0 or n >= std::int64_t(nodes.size()))
+    throw Bad_image();
+  return n;
+}
+
+Node*
+Image_reader::resolve(std::uint32_t r) {
+  switch (get_ref_tag(r)) {
+  case special_ref:
+    switch (get_ref_value(r)) {
+    case null_ref: return nullptr;
+    case typename_ref: return get_typename_type();
+    case unit_ref: return get_unit_type();
+    case bool_ref: return get_bool_type();
+    case nat_ref: return get_nat_type();
+    case int_ref: return get_int_type();
+    case char_ref: return get_char_type();
+    case self_ref: return mod;
+    default: throw Bad_image();
+    }
+  case local_ref:
+    return node(local(r));
+  case extern_ref: {
+    std::uint32_t n = get_ref_value(r);
+    if (n >= img.header->nexterns)
+      throw Bad_image();
+    const std::uint32_t* x = img.words + img.header->externs + n * extern_words;
+    if (x[0] == 0) {
+      const std::vector<Node*>& tab = builtin_nodes();
+      if (x[1] >= tab.size())
+        throw Bad_image();
+      return tab[x[1]];
+    }
+    Module* m = deps[x[0] - 1];
+    if (x[1] == none)
+      return m;
+    m->decls();
+    auto iter = modules_.find(m);
+    if (iter == modules_.end() or x[1] >= iter->second.nodes.size())
+      throw Bad_image();
+    return iter->second.nodes[x[1]];
+  }
+  default:
+    throw Bad_image();
+  }
+}
+
+String
+Image_reader::string(std::uint32_t n) {
+  if (n == none)
+    return String();
+  if (n >= strings.size())
+    throw Bad_image();
+  if (not strings[n])
+    strings[n] = get_string(img, n);
+  return strings[n];
+}
+
+Location
+Image_reader::location(std::uint32_t n) {
+  if (n == 0)
+    return Location();
+  if (n - 1 > file.size())
+    throw Bad_image();
+  return Location(file.base() + n - 1);
+}
+
+template<typename T>
+  T*
+  Image_reader::ptr(std::uint32_t r) {
+    Node* n = resolve(r);
+    if (n and not is_a(n, static_cast<T*>(nullptr)))
+      throw Bad_image();
+    return static_cast<T*>(n);
+  }
+
+template<typename T>
+  Seq<T>*
+  Image_reader::seq(std::uint32_t r) {
+    if (get_ref_tag(r) == local_ref and record(local(r))[1] != Elem_of<T>::value)
+      throw Bad_image();
+    Node* n = resolve(r);
+    if (n and n->kind != seq_node)
+      throw Bad_image();
+    return static_cast<Seq<T>*>(n);
+  }
+
+template<typename T>
+  inline void
+  Image_reader::get(T*& p, const std::uint32_t*& w) { p = ptr<T>(*w++); }
+
+template<typename T>
+  inline void
+  Image_reader::get(Seq<T>*& p, const std::uint32_t*& w) { p = seq<T>(*w++); }
+
+inline void
+Image_reader::get(String& s, const std::uint32_t*& w) { s = string(*w++); }
+
+inline void
+Image_reader::get(bool& b, const std::uint32_t*& w) { b = *w++; }
+
+void
+Image_reader::get(Integer& n, const std::uint32_t*& w) {
+  String s = string(*w++);
+  int base = *w++;
+  if (not s or base < 2 or base > 36)
+    throw Bad_image();
+  mpz_t z;
+  bool ok = mpz_init_set_str(z, s.data(), base) == 0;
+  mpz_clear(z);
+  if (not ok)
+    throw Bad_image();
+  n = Integer(s, base);
+}
+
+template<typename F, std::size_t... Is>
+  inline void
+  Image_reader::get_all(F&& fs, const std::uint32_t* w, Indices<Is...>) {
+    using Expand = int[];
+    (void)Expand{0, (get(std::get<Is>(fs), w), 0)...};
+  }
+
+template<typename T>
+  Node*
+  Image_reader::load_seq(const std::uint32_t* r) {
+    Seq<T>* s = new Seq<T>();
+    nodes[self] = s;
+    s->reserve(r[2]);
+    for (std::uint32_t i = 0; i < r[2]; ++i)
+      s->push_back(ptr<T>(r[seq_words + i]));
+    return s;
+  }
+
+template<typename T>
+  bool
+  Image_reader::operator()(T*) {
+    load<T>(Is_canonical_type<T>());
+    return true;
+  }
+
+template<typename T>
+  void
+  Image_reader::load(std::false_type) {
+    const std::uint32_t* r = record(self);
+    T* n = make_shell<T>(location(r[1]), static_cast<Fields<T>*>(nullptr));
+    nodes[self] = n;
+    n->type_ = ptr<Type>(r[2]);
+    set_def(n, ptr<Decl>(r[3]));
+    set_cxt(n, ptr<Expr>(r[4]));
+    using Size = std::tuple_size<Fields<T>>;
+    get_all(fields(n), r + record_words, typename Make_indices<Size::value>::type());
+  }
+
+// A canonical type is found or created once its operands have been
+// read. Its operands cannot refer back to it.
+template<typename T>
+  void
+  Image_reader::load(std::true_type) {
+    const std::uint32_t* r = record(self);
+    busy[self] = true;
+    Type* t = ptr<Type>(r[2]);
+    using Size = std::tuple_size<Fields<T>>;
+    using Is = typename Make_indices<Size::value>::type;
+    typename Values_of<Fields<T>>::type vals;
+    get_all(vals, r + record_words, Is());
+    T* n = make_canonical<T>(location(r[1]), t, vals, Is());
+    nodes[self] = n;
+    busy[self] = false;
+    set_def(n, ptr<Decl>(r[3]));
+  }
+
+} // namespace
+
+
+// -------------------------------------------------------------------------- //
+// Module images
+
+// Returns the hash of the text of the source file f.
+std::uint64_t
+hash_source(const File& f) { return hash_bytes(f.data(), f.size()); }
+
+// Record the hash of the source of the file module m.
+void
+note_source(Module* m, std::uint64_t h) { modules_[m].hash = h; }
+
+// Returns the hash of the source of m, or 0 if m is not a file module.
+std::uint64_t
+source_hash(Module* m) {
+  auto iter = modules_.find(m);
+  return iter != modules_.end() ? iter->second.hash : 0;
+}
+
+// Record the key of the file module m, which imports the file modules
+// in imports. The key is the hash of the module's source and of the
+// keys of its imports, so that it changes whenever any module that m
+// imports, directly or not, changes. This must be done after the
+// modules that m imports have their keys.
+void
+note_imports(Module* m, const std::vector<Module*>& imports) {
+  std::vector<std::uint64_t> hs {source_hash(m)};
+  for (Module* i : imports)
+    if (i != m)
+      hs.push_back(module_key(i));
+  const char* p = reinterpret_cast<const char*>(hs.data());
+  modules_[m].key = hash_bytes(p, hs.size() * sizeof(std::uint64_t));
+}
+
+// Record the key of the file module m, which was read from img.
+void
+note_image(Module* m, const Image* img) { modules_[m].key = img->header->key; }
+
+// Returns the key of m, or 0 if m is not a file module.
+std::uint64_t
+module_key(Module* m) {
+  auto iter = modules_.find(m);
+  return iter != modules_.end() ? iter->second.key : 0;
+}
+
+// Returns the path of the image of the module whose source is at p.
+Path
+image_path(const Path& p) {
+  const std::string& s = p.string();
+  std::uint64_t h = hash_bytes(s.data(), s.size());
+  return config().module_cache / format("{}-{:016x}.stevemod", p.stem().string(), h);
+}
+
+// Save the image of the elaborated module m, whose source is f, to the
+// file at path p. The module must have been allocated in the current
+// arena. Returns false if the module cannot be saved.
+//
+// The image depends on each module that m imports, even if none of its
+// nodes refer to that module. A value computed from an imported
+// declaration is saved as is, and must be recomputed when that
+// declaration changes.
+//
+// Note that even when the image cannot be written, the module's node
+// table is kept so that images of modules that import it can be saved.
+bool
+save_image(const Path& p, Module* m, const File& f, const std::vector<Module*>& imports) {
+  builtin_nodes();
+  Image_writer w(m, current_arena(), &f);
+  for (Module* i : imports)
+    if (i != m)
+      w.dep(i);
+  if (not w.run(m->decls()))
+    return false;
+  std::vector<std::uint32_t> img;
+  w.image(source_hash(m), module_key(m), img);
+  register_nodes(m, std::move(w.nodes));
+  return write_image(p, img);
+}
+
+// Map the image at path p. Returns nullptr if there is no such image,
+// or if it is malformed or stale.
+Image*
+open_image(const Path& p, std::uint64_t hash) {
+  int fd = ::open(p.c_str(), O_RDONLY);
+  if (fd < 0)
+    return nullptr;
+  struct stat st;
+  if (::fstat(fd, &st) != 0 or
+      std::size_t(st.st_size) < sizeof(Image_header) or
+      st.st_size % 4 != 0 or
+      st.st_size / 4 > none) {
+    ::close(fd);
+    return nullptr;
+  }
+  void* map = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED)
+    return nullptr;
+
+  Image* img = new Image();
+  img->map = map;
+  img->bytes = st.st_size;
+  img->words = static_cast<const std::uint32_t*>(map);
+  img->header = static_cast<const Image_header*>(map);
+  if (not check_image(*img, hash)) {
+    delete img;
+    return nullptr;
+  }
+  return img;
+}
+
+// Returns the modules on which the image depends.
+const std::vector<Image_dep>&
+image_deps(const Image* img) { return img->deps; }
+
+// Read the declarations of the module m from its image. The modules
+// in deps are those on which the image depends, in order. Returns
+// nullptr if the image cannot be read.
+Decl_seq*
+read_image(Image* img, Module* m, const File& f, const std::vector<Module*>& deps) {
+  builtin_nodes();
+  if (deps.size() != img->deps.size())
+    return nullptr;
+  try {
+    Image_reader r(*img, m, f, deps);
+    Decl_seq* ds = r.seq<Decl>(img->header->root);
+    for (std::uint32_t i = 0; i < r.nodes.size(); ++i)
+      r.node(i);
+    register_nodes(m, std::move(r.nodes));
+    return ds;
+  } catch (Bad_image&) {
+    return nullptr;
+  }
+}
+
+// Release the image.
+void
+close_image(Image* img) { delete img; }
+
+// Forget the node tables and source hashes of every module. The node
+// table of the builtin declarations is kept. This is done when the
+// nodes of the modules are released.
+void
+forget_images() {
+  modules_.clear();
+  for (auto iter = externs_.begin(); iter != externs_.end(); ) {
+    if (iter->second.mod)
+      iter = externs_.erase(iter);
+    else
+      ++iter;
+  }
+}
+
+
+// -------------------------------------------------------------------------- //
+// Node locations
+
+namespace {
+
+// Moves the locations in the range [first, last) by delta. Nodes are
+// reached through their operands, types, definitions, and contexts,
+// but not through nodes located outside the range, which belong to
+// other declarations.
+struct Relocator {
+  bool moves(Node* n) {
+    if (not n or not seen.insert(n).second)
+      return false;
+    if (n->loc.is_internal())
+      return true;
+    Source_offset k = n->loc.offset();
+    if (k < first or last <= k)
+      return false;
+    n->loc = Location(k + delta);
+    return true;
+  }
+
+  void visit(Node* n) {
+    if (moves(n))
+      dispatch(n->kind, n, *this);
+  }
+
+  template<typename T>
+    void visit(Seq<T>* s) {
+      if (moves(s))
+        for (T* e : *s)
+          visit(e);
+    }
+
+  void visit(String) { }
+  void visit(bool) { }
+  void visit(const Integer&) { }
+
+  template<typename F, std::size_t... Is>
+    void visit_all(F&& fs, Indices<Is...>) {
+      using Expand = int[];
+      (void)Expand{0, (visit(std::get<Is>(fs)), 0)...};
+    }
+
+  template<typename T>
+    bool operator()(T* n) {
+      visit(n->type_);
+      visit(get_def(n));
+      visit(get_cxt(n));
+      using Size = std::tuple_size<Fields<T>>;
+      visit_all(fields(n), typename Make_indices<Size::value>::type());
+      return true;
+    }
+
+  bool operator()(Builtin*) { return true; }
+
+  Source_offset first;
+  Source_offset last;
+  std::int64_t delta;
+  std::unordered_set<Node*> seen;
+};
+
+} // namespace
+
+// Move the locations of the declaration d, and of the nodes that it
+// owns, from the range [first, last) by delta. This is done when d is
+// reused by a module whose source has changed, and d's source moved.
+void
+relocate_decl(Decl* d, Source_offset first, Source_offset last, std::int64_t delta) {
+  Relocator r {first, last, delta, {}};
+  r.visit(d);
+}
+
+} // namespace steve
@@ -0,0 +1,85 @@
+
+#ifndef STEVE_IMAGE_HPP
+#define STEVE_IMAGE_HPP
+
+#include <steve/Ast.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// This module defines module images. An image is the elaborated form
+// of a file module, saved in the module cache (a .stevemod file) so
+// that later imports of the module need not lex, parse, or elaborate
+// its source.
+//
+// An image is an array of 32-bit words that is mapped into memory and
+// read in place. It contains:
+//
+//    - a header giving the format, the compiler version, a hash of the
+//      module's source text, and the module's key;
+//
+//    - a pool of interned strings (names, paths, and integer literals),
+//      each stored once;
+//
+//    - the modules on which the image depends, including every module
+//      that it imports, with their keys;
+//
+//    - a table of references to nodes owned by those modules (or by the
+//      builtin declarations), given by their index in that module's node
+//      table;
+//
+//    - a node table whose entries are kind-tagged records, one for each
+//      node owned by the module. A reference to another node in the same
+//      table is stored relative to the referring record.
+//
+// The key of a module is a hash of its source and of the keys of the
+// modules it imports, so it changes when the source of any module it
+// imports, directly or not, changes.
+//
+// An image is stale if its format, its compiler version, or the hash of
+// its source differs from the current one, or if the key of any of its
+// dependencies has changed. Stale images are ignored.
+//
+// Nodes are numbered in the order they are reached from the module's
+// declarations, so the nodes of a module have the same indexes whether
+// it was elaborated or read from its image.
+
+namespace steve {
+
+class File;
+
+std::uint64_t hash_source(const File&);
+void note_source(Module*, std::uint64_t);
+std::uint64_t source_hash(Module*);
+void note_imports(Module*, const std::vector<Module*>&);
+std::uint64_t module_key(Module*);
+
+Path image_path(const Path&);
+
+// A module on which an image depends. If the module was imported as
+// part of a directory module, parent is the index of that dependency.
+struct Image_dep {
+  Path path;          // The path of the module
+  String id;          // The name of the module
+  int parent;         // The enclosing dependency, or -1
+  bool dir;           // True if the module is a directory
+  std::uint64_t key;  // The key of the module, 0 for directories
+};
+
+struct Image;
+
+bool save_image(const Path&, Module*, const File&, const std::vector<Module*>&);
+
+Image* open_image(const Path&, std::uint64_t);
+const std::vector<Image_dep>& image_deps(const Image*);
+void note_image(Module*, const Image*);
+Decl_seq* read_image(Image*, Module*, const File&, const std::vector<Module*>&);
+void close_image(Image*);
+
+void forget_images();
+
+void relocate_decl(Decl*, Source_offset, Source_offset, std::int64_t);
+
+} // namespace steve
+
+#endif
@@ -7,18 +7,55 @@ namespace steve {
 // Consruct an integer with the value in s in base b. Behavior is undefined
 // if s does not represent an integer in base b.
 Integer::Integer(String s, int b) 
-  : base_(b)
+  : is_large_(true), base_(b)
 {
-  if (mpz_init_set_str(value_, s.data(), base_) == -1)
+  if (mpz_init_set_str(large_, s.data(), base_) == -1)
     steve_unreachable(format("invalid integer representation '{}' in base {}", s, b));
+  demote();
+}
+
+// If the value is in GMP but fits in a long, store it inline.
+void
+Integer::demote() {
+  if (is_large_ and mpz_fits_slong_p(large_)) {
+    long n = mpz_get_si(large_);
+    mpz_clear(large_);
+    small_ = n;
+    is_large_ = false;
+  }
+}
+
+// Compute this value as f(this, x) using GMP. This is the slow path
+// of the arithmetic operators.
+void
+Integer::apply(Mpz_op f, const Integer& x) {
+  promote();
+  if (x.is_large_) {
+    f(large_, large_, x.large_);
+  } else {
+    mpz_t t;
+    mpz_init_set_si(t, x.small_);
+    f(large_, large_, t);
+    mpz_clear(t);
+  }
+  demote();
+}
+
+// Compute this value as f(this, x) using GMP, where x is a number
+// of bits.
+void
+Integer::apply(Mpz_shift f, const Integer& x) {
+  promote();
+  f(large_, large_, x.getu());
+  demote();
 }
 
 namespace {
 
 inline std::size_t
-get_buffer_size(const mpz_t& z, int b) {
-  // add 1 for a null terminator
-  std::size_t r = mpz_sizeinbase(z, b) + 1; 
+get_buffer_size(mpz_srcptr z, int b) {
+  // add 1 for a null terminator and 1 for a sign
+  std::size_t r = mpz_sizeinbase(z, b) + 2; 
   
   // add in the formatting characters.
   switch (b) {
@@ -33,23 +70,29 @@ get_buffer_size(const mpz_t& z, int b) {
 } // namespace
 
 // Streaming
+//
+// Values stored inline are printed directly in base 10. Otherwise,
+// the value is formatted by GMP.
 std::ostream&
-operator<<(std::ostream& os, const Integer& z) {
-  int  base = z.base();
-  std::size_t n = get_buffer_size(z.data(), base);
+operator<<(std::ostream& os, const Integer& x) {
+  if (x.is_small() and x.base() == 10)
+    return os << x.small();
+  Integer::Mpz_view z = x.data();
+  int  base = x.base();
+  std::size_t n = get_buffer_size(z, base);
   std::unique_ptr<char[]> buf(new char[n]);
   switch (base) {
     case 2:
-      gmp_snprintf(buf.get(), n + 2, "0b%Zo", z.data());
+      gmp_snprintf(buf.get(), n + 2, "0b%Zo", z.get());
       break;
     case 8:
-      gmp_snprintf(buf.get(), n + 1, "0%Zo", z.data());
+      gmp_snprintf(buf.get(), n + 1, "0%Zo", z.get());
       break;
     case 10:
-      gmp_snprintf(buf.get(), n, "%Zd", z.data());
+      gmp_snprintf(buf.get(), n, "%Zd", z.get());
       break;
     case 16:
-      gmp_snprintf(buf.get(), n + 2, "0x%Zx", z.data());
+      gmp_snprintf(buf.get(), n + 2, "0x%Zx", z.get());
       break;
   }
   return os << buf.get(); 
@@ -10,13 +10,22 @@
 #include <steve/Memory.hpp>
 #include <steve/Debug.hpp>
 
+#include <climits>
+
 #include <gmp.h>
 
 namespace steve {
 
 // The Integer class represents arbitrary integer values.
+//
+// Values that fit in a long are stored inline, and arithmetic on them
+// is done in machine words. An operation whose result does not fit
+// is redone with GMP, and the result is stored in an mpz_t. Results
+// that fit in a long are always stored inline again.
 class Integer {
 public:
+  class Mpz_view;
+
   // Default constructor
   //
   // FIXME: Make a default constructor that takes a width specification.
@@ -26,6 +35,10 @@ public:
   Integer(const Integer&);
   Integer& operator=(const Integer&);
 
+  // Move semantics
+  Integer(Integer&&);
+  Integer& operator=(Integer&&);
+
   // Value initialization.
   Integer(long, int = 10);
   Integer(String, int = 10);
@@ -62,11 +75,48 @@ public:
   int base() const;
   std::uintmax_t getu() const;
   std::intmax_t gets() const;
-  const mpz_t& data() const;
+  Mpz_view data() const;
+
+  bool is_small() const;
+  long small() const;
+
+private:
+  using Mpz_op = void (*)(mpz_ptr, mpz_srcptr, mpz_srcptr);
+  using Mpz_shift = void (*)(mpz_ptr, mpz_srcptr, mp_bitcnt_t);
+
+  void promote();
+  void demote();
+  void apply(Mpz_op, const Integer&);
+  void apply(Mpz_shift, const Integer&);
+
+  // The value is either inline or in GMP.
+  union {
+    long  small_;
+    mpz_t large_;
+  };
+  bool is_large_;
+  int base_;
+};
+
+// A read-only view of the value of an integer as a GMP integer. The
+// view refers to the value of an integer stored in GMP. A value stored
+// inline is copied into a temporary owned by the view, so the integer
+// itself is not changed.
+class Integer::Mpz_view {
+public:
+  explicit Mpz_view(const Integer&);
+  Mpz_view(Mpz_view&&);
+  ~Mpz_view();
+
+  Mpz_view(const Mpz_view&) = delete;
+  Mpz_view& operator=(const Mpz_view&) = delete;
+
+  mpz_srcptr get() const;
+  operator mpz_srcptr() const;
 
 private:
-  mpz_t value_;
-  int   base_;
+  mpz_t       temp_;
+  mpz_srcptr  ptr_;
 };
 
 // Equality
@@ -1,24 +1,70 @@
 namespace steve {
 
-// Default initialize the integer value.
-//
-// Note that GMP does not optimize for default-intialized values. 
+// Default initialize the integer value to 0.
 inline
-Integer::Integer() : base_(10) { mpz_init(value_); }
+Integer::Integer() : small_(0), is_large_(false), base_(10) { }
 
 // Copy initialize this object with x.
 inline
 Integer::Integer(const Integer& x) 
-  : base_(x.base_) 
-{ mpz_init_set(value_, x.value_); }
+  : is_large_(x.is_large_), base_(x.base_) 
+{ 
+  if (is_large_)
+    mpz_init_set(large_, x.large_);
+  else
+    small_ = x.small_;
+}
 
 // Copy assign this object to the value of x.
 inline Integer&
 Integer::operator=(const Integer& x) {
-  if (this != &x) {
-    mpz_clear(value_);
-    mpz_set(value_, x.value_);
-    base_ = x.base_;
+  if (this == &x)
+    return *this;
+  if (x.is_large_) {
+    if (is_large_)
+      mpz_set(large_, x.large_);
+    else
+      mpz_init_set(large_, x.large_);
+  } else {
+    if (is_large_)
+      mpz_clear(large_);
+    small_ = x.small_;
+  }
+  is_large_ = x.is_large_;
+  base_ = x.base_;
+  return *this;
+}
+
+// Move initialize this object with x. The GMP representation of x
+// is taken, and x is left with the value 0.
+inline
+Integer::Integer(Integer&& x) 
+  : is_large_(x.is_large_), base_(x.base_) 
+{ 
+  if (is_large_) {
+    *large_ = *x.large_;
+    x.is_large_ = false;
+    x.small_ = 0;
+  } else {
+    small_ = x.small_;
+  }
+}
+
+// Move assign this object to the value of x.
+inline Integer&
+Integer::operator=(Integer&& x) {
+  if (this == &x)
+    return *this;
+  if (is_large_)
+    mpz_clear(large_);
+  is_large_ = x.is_large_;
+  base_ = x.base_;
+  if (is_large_) {
+    *large_ = *x.large_;
+    x.is_large_ = false;
+    x.small_ = 0;
+  } else {
+    small_ = x.small_;
   }
   return *this;
 }
@@ -26,28 +72,46 @@ Integer::operator=(const Integer& x) {
 // Construct an integer with the value n.
 inline
 Integer::Integer(long n, int b)
-  : base_(b)
-{ mpz_init_set_si(value_, n); }
+  : small_(n), is_large_(false), base_(b)
+{ }
 
 // Destroy the ionteger, releasing resources.
 inline
-Integer::~Integer() { mpz_clear(value_); }
+Integer::~Integer() { 
+  if (is_large_)
+    mpz_clear(large_); 
+}
 
 inline Integer& 
 Integer::operator+=(const Integer& x) {
-  mpz_add(value_, value_, x.value_);
+  long r;
+  if (not is_large_ and not x.is_large_ 
+      and not __builtin_add_overflow(small_, x.small_, &r))
+    small_ = r;
+  else
+    apply(mpz_add, x);
   return *this;
 }
 
 inline Integer& 
 Integer::operator-=(const Integer& x) {
-  mpz_sub(value_, value_, x.value_);
+  long r;
+  if (not is_large_ and not x.is_large_ 
+      and not __builtin_sub_overflow(small_, x.small_, &r))
+    small_ = r;
+  else
+    apply(mpz_sub, x);
   return *this;
 }
 
 inline Integer& 
 Integer::operator*=(const Integer& x) {
-  mpz_mul(value_, value_, x.value_);
+  long r;
+  if (not is_large_ and not x.is_large_ 
+      and not __builtin_mul_overflow(small_, x.small_, &r))
+    small_ = r;
+  else
+    apply(mpz_mul, x);
   return *this;
 }
 
@@ -55,9 +119,19 @@ Integer::operator*=(const Integer& x) {
 // floor division. A discussion of alternatives can be found in the paper,
 // "The Euclidean definition of the functions div and mod" by Raymond T.
 // Boute (http://dl.acm.org/citation.cfm?id=128862).
+//
+// Division by 0 and the one division that overflows are left to GMP.
 inline Integer& 
 Integer::operator/=(const Integer& x) {
-  mpz_fdiv_q(value_, value_, x.value_);
+  if (not is_large_ and not x.is_large_ and x.small_ != 0 
+      and not (x.small_ == -1 and small_ == LONG_MIN)) {
+    long q = small_ / x.small_;
+    if (small_ % x.small_ != 0 and ((small_ < 0) != (x.small_ < 0)))
+      --q;
+    small_ = q;
+  } else {
+    apply(mpz_fdiv_q, x);
+  }
   return *this;
 }
 
@@ -66,32 +140,58 @@ Integer::operator/=(const Integer& x) {
 // discussion.
 inline Integer& 
 Integer::operator%=(const Integer& x) {
-  mpz_fdiv_r(value_, value_, x.value_);
+  if (not is_large_ and not x.is_large_ and x.small_ != 0 
+      and not (x.small_ == -1 and small_ == LONG_MIN)) {
+    long r = small_ % x.small_;
+    if (r != 0 and ((r < 0) != (x.small_ < 0)))
+      r += x.small_;
+    small_ = r;
+  } else {
+    apply(mpz_fdiv_r, x);
+  }
   return *this;
 }
 
+// Note that the bitwise operations on inline values have the same
+// two's complement semantics as GMP.
 inline Integer&
 Integer::operator&=(const Integer& x) {
-  mpz_and(value_, value_, x.value_);
+  if (not is_large_ and not x.is_large_)
+    small_ &= x.small_;
+  else
+    apply(mpz_and, x);
   return *this;
 }
 
 inline Integer&
 Integer::operator|=(const Integer& x) {
-  mpz_ior(value_, value_, x.value_);
+  if (not is_large_ and not x.is_large_)
+    small_ |= x.small_;
+  else
+    apply(mpz_ior, x);
   return *this;
 }
 
 inline Integer&
 Integer::operator^=(const Integer& x) {
-  mpz_xor(value_, value_, x.value_);
+  if (not is_large_ and not x.is_large_)
+    small_ ^= x.small_;
+  else
+    apply(mpz_xor, x);
   return *this;
 }
 
 // Left-shift the integer value by the specified amount.
 inline Integer&
 Integer::operator<<=(const Integer& x) {
-  mpz_mul_2exp(value_, value_, x.getu());
+  if (not is_large_ and not x.is_large_ and x.small_ >= 0 and x.small_ < 64) {
+    __int128 r = static_cast<__int128>(small_) << x.small_;
+    if (r >= LONG_MIN and r <= LONG_MAX) {
+      small_ = static_cast<long>(r);
+      return *this;
+    }
+  }
+  apply(mpz_mul_2exp, x);
   return *this;
 }
 
@@ -101,34 +201,62 @@ Integer::operator<<=(const Integer& x) {
 // representations.
 inline Integer&
 Integer::operator>>=(const Integer& x) {
-  mpz_fdiv_q_2exp(value_, value_, x.getu());
+  if (not is_large_ and not x.is_large_ and x.small_ >= 0) {
+    if (x.small_ < 64)
+      small_ >>= x.small_;
+    else
+      small_ = small_ < 0 ? -1 : 0;
+    return *this;
+  }
+  apply(mpz_fdiv_q_2exp, x);
   return *this;
 }
 
 // Negate this value.
 inline Integer&
 Integer::neg() {
-  mpz_neg(value_, value_);
+  if (not is_large_ and small_ != LONG_MIN) {
+    small_ = -small_;
+  } else {
+    promote();
+    mpz_neg(large_, large_);
+    demote();
+  }
   return *this;
 }
 
 // Set this value to its absolute value.
 inline Integer&
 Integer::abs() {
-  mpz_abs(value_, value_);
+  if (not is_large_ and small_ != LONG_MIN) {
+    small_ = small_ < 0 ? -small_ : small_;
+  } else {
+    promote();
+    mpz_abs(large_, large_);
+    demote();
+  }
   return *this;
 }
 
 // Set this value to its one's complement.
 inline Integer&
 Integer::comp() {
-  mpz_com(value_, value_);
+  if (not is_large_) {
+    small_ = ~small_;
+  } else {
+    mpz_com(large_, large_);
+    demote();
+  }
   return *this;
 }
 
 // Returns the signum of the value.
 inline int
-Integer::sign() const { return mpz_sgn(value_); }
+Integer::sign() const { 
+  if (is_large_)
+    return mpz_sgn(large_); 
+  return (small_ > 0) - (small_ < 0);
+}
 
 // Returns true if the value is strictly positive.
 inline bool
@@ -146,9 +274,18 @@ Integer::is_nonpositive() const { return sign() <= 0; }
 inline bool
 Integer::is_nonnegative() const { return sign() >= 0; }
 
-// Returns the number of bits in the integer representation.
+// Returns the number of bits in the integer representation. Like
+// GMP, this is the number of bits in the magnitude of the value,
+// and 0 requires 1 bit.
 inline int
-Integer::bits() const { return mpz_sizeinbase(value_, 2); }
+Integer::bits() const { 
+  if (is_large_)
+    return mpz_sizeinbase(large_, 2); 
+  unsigned long m = small_ < 0 ? -static_cast<unsigned long>(small_) : small_;
+  if (m == 0)
+    return 1;
+  return 8 * sizeof(long) - __builtin_clzl(m);
+}
 
 // Returns the base of in which the inteer should be formatted.
 inline int
@@ -158,24 +295,100 @@ Integer::base() const { return base_; }
 inline std::uintmax_t
 Integer::getu() const { 
   steve_assert(is_nonnegative(), "get signed value as unsigned");
-  return mpz_get_ui(value_);
+  if (is_large_)
+    return mpz_get_ui(large_);
+  return small_;
 }
 
 // Returns the value as a signed integer.
 inline std::intmax_t
 Integer::gets() const { 
-  return mpz_get_si(value_);
+  if (is_large_)
+    return mpz_get_si(large_);
+  return small_;
 }
 
-// Returns a reference to the underlying data.
-inline const mpz_t& 
-Integer::data() const { return value_; }
+// Returns a view of the value as a GMP integer.
+inline Integer::Mpz_view
+Integer::data() const { return Mpz_view(*this); }
+
+// Returns true if the value is stored inline.
+inline bool
+Integer::is_small() const { return not is_large_; }
+
+// Returns the value stored inline. Behavior is undefined if the
+// value is not stored inline.
+inline long
+Integer::small() const { 
+  steve_assert(not is_large_, "large integer accessed as small");
+  return small_;
+}
+
+// Move an inline value into GMP.
+inline void
+Integer::promote() {
+  if (not is_large_) {
+    long n = small_;
+    mpz_init_set_si(large_, n);
+    is_large_ = true;
+  }
+}
+
+// Create a view of the value of x.
+inline
+Integer::Mpz_view::Mpz_view(const Integer& x) {
+  if (x.is_large_) {
+    ptr_ = x.large_;
+  } else {
+    mpz_init_set_si(temp_, x.small_);
+    ptr_ = temp_;
+  }
+}
+
+// Take the view of x, including its temporary, if any.
+inline
+Integer::Mpz_view::Mpz_view(Mpz_view&& x) {
+  if (x.ptr_ == x.temp_) {
+    *temp_ = *x.temp_;
+    ptr_ = temp_;
+    x.ptr_ = nullptr;
+  } else {
+    ptr_ = x.ptr_;
+  }
+}
+
+inline
+Integer::Mpz_view::~Mpz_view() {
+  if (ptr_ == temp_)
+    mpz_clear(temp_);
+}
+
+inline mpz_srcptr
+Integer::Mpz_view::get() const { return ptr_; }
+
+inline
+Integer::Mpz_view::operator mpz_srcptr() const { return ptr_; }
+
+// Compare a and b, returning a negative value if a < b, 0 if a == b,
+// and a positive value if a > b.
+inline int
+compare(const Integer& a, const Integer& b) {
+  if (a.is_small() and b.is_small())
+    return (a.small() > b.small()) - (a.small() < b.small());
+  if (a.is_small())
+    return -mpz_cmp_si(b.data().get(), a.small());
+  if (b.is_small())
+    return mpz_cmp_si(a.data().get(), b.small());
+  return mpz_cmp(a.data(), b.data());
+}
 
 // Equality comparison
 // Returns true when the two integers have the same value.
 inline bool
 operator==(const Integer& a, const Integer& b) {
-  return mpz_cmp(a.data(), b.data()) == 0;
+  if (a.is_small() and b.is_small())
+    return a.small() == b.small();
+  return compare(a, b) == 0;
 }
 
 inline bool 
@@ -185,7 +398,9 @@ operator!=(const Integer& a, const Integer& b) { return not(a == b); }
 // Returns true when a is less than b.
 inline bool
 operator<(const Integer& a, const Integer& b) {
-  return mpz_cmp(a.data(), b.data()) < 0;
+  if (a.is_small() and b.is_small())
+    return a.small() < b.small();
+  return compare(a, b) < 0;
 }
 
 inline bool
@@ -199,42 +414,42 @@ operator>=(const Integer& a, const Integer& b) { return not(a < b); }
 
 // Arithmetic
 inline Integer
-operator+(const Integer& a, const Integer& b) { return Integer(a) += b; }
+operator+(const Integer& a, const Integer& b) { return std::move(Integer(a) += b); }
 
 inline Integer
-operator-(const Integer& a, const Integer& b) { return Integer(a) -= b; }
+operator-(const Integer& a, const Integer& b) { return std::move(Integer(a) -= b); }
 
 inline Integer
-operator*(const Integer& a, const Integer& b) { return Integer(a) *= b; }
+operator*(const Integer& a, const Integer& b) { return std::move(Integer(a) *= b); }
 
 inline Integer
-operator/(const Integer& a, const Integer& b) { return Integer(a) /= b; }
+operator/(const Integer& a, const Integer& b) { return std::move(Integer(a) /= b); }
 
 inline Integer
-operator%(const Integer& a, const Integer& b) { return Integer(a) %= b; }
+operator%(const Integer& a, const Integer& b) { return std::move(Integer(a) %= b); }
 
 inline Integer 
-operator-(const Integer& x) { return Integer(x).neg(); }
+operator-(const Integer& x) { return std::move(Integer(x).neg()); }
 
 inline Integer 
 operator+(const Integer& x) { return x; }
 
 inline Integer
-operator&(const Integer& a, const Integer& b) { return Integer(a) &= b; }
+operator&(const Integer& a, const Integer& b) { return std::move(Integer(a) &= b); }
 
 inline Integer
-operator|(const Integer& a, const Integer& b) { return Integer(a) |= b; }
+operator|(const Integer& a, const Integer& b) { return std::move(Integer(a) |= b); }
 
 inline Integer
-operator^(const Integer& a, const Integer& b) { return Integer(a) ^= b; }
+operator^(const Integer& a, const Integer& b) { return std::move(Integer(a) ^= b); }
 
 inline Integer
-operator~(const Integer& x) { return Integer(x).comp(); }
+operator~(const Integer& x) { return std::move(Integer(x).comp()); }
 
 inline Integer
-operator<<(const Integer& a, const Integer& b) { return Integer(a) <<= b; }
+operator<<(const Integer& a, const Integer& b) { return std::move(Integer(a) <<= b); }
 
 inline Integer
-operator>>(const Integer& a, const Integer& b) { return Integer(a) >>= b; }
+operator>>(const Integer& a, const Integer& b) { return std::move(Integer(a) >>= b); }
 
 } // namespace
@@ -0,0 +1,103 @@
+
+// This program measures the time taken by the arithmetic operators
+// on integers whose values fit in a machine word. It compares Integer
+// with the same operations done with GMP, which is how every integer
+// was previously represented: each result is a new mpz_t.
+//
+//    integer_arith [<iterations>]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <steve/Integer.hpp>
+
+using namespace steve;
+
+using Clock = std::chrono::steady_clock;
+
+using Int_op = Integer (*)(const Integer&, const Integer&);
+using Mpz_op = void (*)(mpz_ptr, mpz_srcptr, mpz_srcptr);
+
+struct Op {
+  const char* name;
+  Int_op int_op;
+  Mpz_op mpz_op;
+};
+
+Integer add(const Integer& a, const Integer& b) { return a + b; }
+Integer sub(const Integer& a, const Integer& b) { return a - b; }
+Integer mul(const Integer& a, const Integer& b) { return a * b; }
+Integer div(const Integer& a, const Integer& b) { return a / b; }
+Integer rem(const Integer& a, const Integer& b) { return a % b; }
+Integer bit_and(const Integer& a, const Integer& b) { return a & b; }
+Integer bit_or(const Integer& a, const Integer& b) { return a | b; }
+Integer bit_xor(const Integer& a, const Integer& b) { return a ^ b; }
+
+// Returns the time per operation in nanoseconds.
+template<typename F>
+  double
+  time(int n, F f) {
+    Clock::time_point start = Clock::now();
+    f();
+    Clock::duration time = Clock::now() - start;
+    using Nsec = std::chrono::duration<double, std::nano>;
+    return std::chrono::duration_cast<Nsec>(time).count() / n;
+  }
+
+int
+main(int argc, char* argv[]) {
+  int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+  // Operands typical of protocol specifications: field widths, 
+  // lengths, and masks.
+  std::vector<long> xs;
+  for (int i = 0; i < 1024; ++i)
+    xs.push_back((i * 7919) % 65536 + 1);
+
+  Op ops[] {
+    {"+", add, mpz_add},
+    {"-", sub, mpz_sub},
+    {"*", mul, mpz_mul},
+    {"/", div, mpz_fdiv_q},
+    {"%", rem, mpz_fdiv_r},
+    {"&", bit_and, mpz_and},
+    {"|", bit_or, mpz_ior},
+    {"^", bit_xor, mpz_xor},
+  };
+
+  std::vector<Integer> is(xs.begin(), xs.end());
+  std::vector<mpz_t> zs(xs.size());
+  for (std::size_t i = 0; i < xs.size(); ++i)
+    mpz_init_set_si(zs[i], xs[i]);
+
+  std::cout << "op    integer (ns)    gmp (ns)\n";
+  for (Op& op : ops) {
+    long sum = 0;
+    double t1 = time(n, [&]() {
+      for (int i = 0; i < n; ++i) {
+        Integer r = op.int_op(is[i & 1023], is[(i + 1) & 1023]);
+        sum += r.gets();
+      }
+    });
+    double t2 = time(n, [&]() {
+      for (int i = 0; i < n; ++i) {
+        mpz_t r;
+        mpz_init_set(r, zs[i & 1023]);
+        op.mpz_op(r, r, zs[(i + 1) & 1023]);
+        sum -= mpz_get_si(r);
+        mpz_clear(r);
+      }
+    });
+    if (sum != 0) {
+      std::cerr << "error: results differ for '" << op.name << "'\n";
+      return 1;
+    }
+    std::cout << op.name << "     " << t1 << "    " << t2 << '\n';
+  }
+
+  for (mpz_t& z : zs)
+    mpz_clear(z);
+  return 0;
+}
@@ -0,0 +1,113 @@
+
+// This program checks the arithmetic operators on integers stored
+// inline against the same operations done with GMP. The operands
+// include the values at which inline arithmetic overflows.
+//
+//    integer_small
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include <steve/Integer.hpp>
+
+using namespace steve;
+
+std::string
+to_string(const mpz_t z) {
+  char* p = mpz_get_str(nullptr, 10, z);
+  std::string s = p;
+  std::free(p);
+  return s;
+}
+
+std::string
+to_string(const Integer& n) {
+  std::ostringstream ss;
+  ss << n;
+  return ss.str();
+}
+
+int failures = 0;
+
+void
+check(long a, const char* op, long b, const Integer& r, const mpz_t z) {
+  if (to_string(r) != to_string(z)) {
+    std::cerr << a << ' ' << op << ' ' << b << ": got " << r 
+              << ", expected " << to_string(z) << '\n';
+    ++failures;
+  }
+}
+
+int
+main() {
+  std::vector<long> ns {
+    0, 1, -1, 2, -2, 63, 64, 
+    LONG_MAX, LONG_MIN, LONG_MAX - 1, LONG_MIN + 1, 
+    1L << 40, -(1L << 40), 3037000499L, -3037000500L
+  };
+  std::mt19937_64 gen(42);
+  for (int i = 0; i < 32; ++i)
+    ns.push_back(static_cast<long>(gen()));
+
+  mpz_t x, y, z;
+  mpz_inits(x, y, z, nullptr);
+  for (long a : ns) {
+    for (long b : ns) {
+      mpz_set_si(x, a);
+      mpz_set_si(y, b);
+      Integer m = a;
+      Integer n = b;
+
+      mpz_add(z, x, y); check(a, "+", b, m + n, z);
+      mpz_sub(z, x, y); check(a, "-", b, m - n, z);
+      mpz_mul(z, x, y); check(a, "*", b, m * n, z);
+      if (b != 0) {
+        mpz_fdiv_q(z, x, y); check(a, "/", b, m / n, z);
+        mpz_fdiv_r(z, x, y); check(a, "%", b, m % n, z);
+      }
+      mpz_and(z, x, y); check(a, "&", b, m & n, z);
+      mpz_ior(z, x, y); check(a, "|", b, m | n, z);
+      mpz_xor(z, x, y); check(a, "^", b, m ^ n, z);
+      if (b >= 0 and b < 200) {
+        mpz_mul_2exp(z, x, b); check(a, "<<", b, m << n, z);
+        mpz_fdiv_q_2exp(z, x, b); check(a, ">>", b, m >> n, z);
+      }
+      mpz_neg(z, x); check(a, "neg", 0, -m, z);
+      mpz_com(z, x); check(a, "~", 0, ~m, z);
+
+      // Results that overflow and come back.
+      mpz_mul(z, x, y); 
+      mpz_mul(z, z, y); 
+      Integer p = m * n * n;
+      check(a, "* *", b, p, z);
+      if (b != 0) {
+        mpz_fdiv_q(z, z, y);
+        mpz_fdiv_q(z, z, y);
+        check(a, "* * / /", b, p / n / n, z);
+      }
+
+      if ((m < n) != (mpz_cmp(x, y) < 0) or (m == n) != (a == b)) {
+        std::cerr << a << " <=> " << b << ": wrong ordering\n";
+        ++failures;
+      }
+      if (m.bits() != int(mpz_sizeinbase(x, 2))) {
+        std::cerr << a << ": wrong number of bits\n";
+        ++failures;
+      }
+
+      // Viewing a value in GMP does not change how it is stored.
+      if (mpz_cmp(m.data(), x) != 0 or not m.is_small()) {
+        std::cerr << a << ": wrong view in GMP\n";
+        ++failures;
+      }
+    }
+  }
+  mpz_clears(x, y, z, nullptr);
+
+  if (failures)
+    std::cerr << failures << " failures\n";
+  return failures ? 1 : 0;
+}
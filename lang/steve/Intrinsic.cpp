@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <iterator>
+#include <unordered_map>
 
 namespace steve {
 
@@ -83,13 +84,17 @@ make_builtin(Arity3 f) { return new Builtin(3, f); }
 // the declaration in a subsequent pass.
 //
 // FIXME: Factor common initializations?
+//
+// A spec may also give a value-level implementation of the function,
+// which is used by compiled evaluation.
 struct Spec {
   template<typename N, typename F>
-    Spec(N n, Typenames ps, Typename r, F f)
+    Spec(N n, Typenames ps, Typename r, F f, Value_op v = nullptr)
       : name(make_name(n))
       , parms(make_parms(ps))
       , result(make_type(r))
       , fn(make_builtin(f))
+      , op(v)
       , def()
       , ovl()
      { complete(); }
@@ -100,6 +105,7 @@ struct Spec {
   Type_seq* parms;
   Type*     result;
   Builtin*  fn;
+  Value_op  op;
   Decl*     def;
   Overload* ovl;
 };
@@ -107,7 +113,7 @@ struct Spec {
 void
 Spec::complete() {
   // Finish the function typoe
-  Type* type = new Fn_type(parms, result);
+  Type* type = make_expr<Fn_type>(no_location, nullptr, parms, result);
   fn->type_ = type;
 
   // Build the declaration.
@@ -423,12 +429,71 @@ bool_not(Expr* e) {
   return to_expr(result, get_bool_type());
 }
 
+// -------------------------------------------------------------------------- //
+// Value-level operators
+//
+// These are the same operations as above, applied directly to values.
+
+Value unit_equal_value(const Value*) { return true; }
+Value unit_not_equal_value(const Value*) { return false; }
+
+Value 
+boolean_equal_value(const Value* a) { return a[0].as_bool() == a[1].as_bool(); }
+
+Value 
+boolean_not_equal_value(const Value* a) { return a[0].as_bool() != a[1].as_bool(); }
+
+Value 
+bool_and_value(const Value* a) { return a[0].as_bool() and a[1].as_bool(); }
+
+Value 
+bool_or_value(const Value* a) { return a[0].as_bool() or a[1].as_bool(); }
+
+Value 
+bool_not_value(const Value* a) { return not a[0].as_bool(); }
+
+// Returns the integer value of the nth argument.
+inline const Integer&
+arg(const Value* a, int n) { return a[n].as_integer(); }
+
+Value integer_equal_value(const Value* a) { return arg(a, 0) == arg(a, 1); }
+Value integer_not_equal_value(const Value* a) { return arg(a, 0) != arg(a, 1); }
+Value integer_less_value(const Value* a) { return arg(a, 0) < arg(a, 1); }
+Value integer_greater_value(const Value* a) { return arg(a, 0) > arg(a, 1); }
+Value integer_less_equal_value(const Value* a) { return arg(a, 0) <= arg(a, 1); }
+Value integer_greater_equal_value(const Value* a) { return arg(a, 0) >= arg(a, 1); }
+
+Value integer_addition_value(const Value* a) { return arg(a, 0) + arg(a, 1); }
+Value integer_subtraction_value(const Value* a) { return arg(a, 0) - arg(a, 1); }
+Value integer_multiplication_value(const Value* a) { return arg(a, 0) * arg(a, 1); }
+Value integer_division_value(const Value* a) { return arg(a, 0) / arg(a, 1); }
+Value integer_remainder_value(const Value* a) { return arg(a, 0) % arg(a, 1); }
+Value integer_negation_value(const Value* a) { return -arg(a, 0); }
+
+Value integer_bitwise_and_value(const Value* a) { return arg(a, 0) & arg(a, 1); }
+Value integer_bitwise_or_value(const Value* a) { return arg(a, 0) | arg(a, 1); }
+Value integer_bitwise_xor_value(const Value* a) { return arg(a, 0) ^ arg(a, 1); }
+Value integer_bitwise_complement_value(const Value* a) { return ~arg(a, 0); }
+
+Value left_shift_value(const Value* a) { return arg(a, 0) << arg(a, 1); }
+Value right_shift_value(const Value* a) { return arg(a, 0) >> arg(a, 1); }
+
 // -------------------------------------------------------------------------- //
 // Globals
 
 // Intrinsic functions
 Decl* bitfield_;
 
+// The definitions of all builtin functions, in order of declaration.
+Decl_seq* builtins_;
+
+// Value-level implementations of builtin functions.
+std::unordered_map<Builtin*, Value_op> value_ops_;
+
+// The short-circuiting logical operators.
+Builtin* and_;
+Builtin* or_;
+
 } // namespace
 
 
@@ -441,63 +506,63 @@ init_intrinsics() {
   Diagnostics_guard guard(diags);
 
   // FIXME: Re-enable and finish all of the various builtin operators.
-  Spec specs[] __attribute__ ((unused)) = {
+  Spec specs[] = {
     // equal to (a == b)
-    { equal_equal_tok,    {unit_, unit_}, bool_, unit_equal},
-    { equal_equal_tok,    {bool_, bool_}, bool_, boolean_equal},
-    { equal_equal_tok,    {nat_, nat_}, bool_, integer_equal},
-    { equal_equal_tok,    {int_, int_}, bool_, integer_equal},
+    { equal_equal_tok,    {unit_, unit_}, bool_, unit_equal, unit_equal_value},
+    { equal_equal_tok,    {bool_, bool_}, bool_, boolean_equal, boolean_equal_value},
+    { equal_equal_tok,    {nat_, nat_}, bool_, integer_equal, integer_equal_value},
+    { equal_equal_tok,    {int_, int_}, bool_, integer_equal, integer_equal_value},
     { equal_equal_tok,    {type_, type_}, bool_, type_equal},
     // not equal to (a != b)
-    { bang_equal_tok,     {unit_, unit_}, bool_, unit_not_equal},
-    { bang_equal_tok,     {bool_, bool_}, bool_, boolean_not_equal},
-    { bang_equal_tok,     {nat_, nat_}, bool_, integer_not_equal},
-    { bang_equal_tok,     {int_, int_}, bool_, integer_not_equal},
+    { bang_equal_tok,     {unit_, unit_}, bool_, unit_not_equal, unit_not_equal_value},
+    { bang_equal_tok,     {bool_, bool_}, bool_, boolean_not_equal, boolean_not_equal_value},
+    { bang_equal_tok,     {nat_, nat_}, bool_, integer_not_equal, integer_not_equal_value},
+    { bang_equal_tok,     {int_, int_}, bool_, integer_not_equal, integer_not_equal_value},
     { bang_equal_tok,     {type_, type_}, bool_, type_not_equal},
     // Less than (a < b)
     // { langle_tok,         {nat_, nat_}, bool_, integer_less},
-    { langle_tok,         {int_, int_}, bool_, integer_less},
+    { langle_tok,         {int_, int_}, bool_, integer_less, integer_less_value},
     // Greater than (a > b)
     // { rangle_tok,         {nat_, nat_}, bool_, integer_greater},
-    { rangle_tok,         {int_, int_}, bool_, integer_greater},
+    { rangle_tok,         {int_, int_}, bool_, integer_greater, integer_greater_value},
     // Less than or equal to (a <= b)
     // { langle_equal_tok,   {nat_, nat_}, bool_, integer_less_equal},
-    { langle_equal_tok,   {int_, int_}, bool_, integer_less_equal},
+    { langle_equal_tok,   {int_, int_}, bool_, integer_less_equal, integer_less_equal_value},
     // Greater than or equal to (a >= b)
     // { rangle_equal_tok,   {nat_, nat_}, bool_, integer_greater_equal},
-    { rangle_equal_tok,   {int_, int_}, bool_, integer_greater_equal},
+    { rangle_equal_tok,   {int_, int_}, bool_, integer_greater_equal, integer_greater_equal_value},
     // Addition
     // { plus_tok,           {nat_, nat_}, nat_, integer_addition},
-    { plus_tok,           {int_, int_}, int_, integer_addition},
+    { plus_tok,           {int_, int_}, int_, integer_addition, integer_addition_value},
     // Subtraction
     // { minus_tok,          {nat_, nat_}, nat_, integer_subtraction},
-    { minus_tok,          {int_, int_}, int_, integer_subtraction},
+    { minus_tok,          {int_, int_}, int_, integer_subtraction, integer_subtraction_value},
     // Multiplication
     // { star_tok,           {nat_, nat_}, nat_, integer_multiplication},
-    { star_tok,           {int_, int_}, int_, integer_multiplication},
+    { star_tok,           {int_, int_}, int_, integer_multiplication, integer_multiplication_value},
     // Division
     // { slash_tok,          {nat_, nat_}, nat_, integer_division},
-    { slash_tok,          {int_, int_}, int_, integer_division},
+    { slash_tok,          {int_, int_}, int_, integer_division, integer_division_value},
     // Remainder
     // { percent_tok,        {nat_, nat_}, nat_, integer_remainder},
-    { percent_tok,        {int_, int_}, int_, integer_remainder},
+    { percent_tok,        {int_, int_}, int_, integer_remainder, integer_remainder_value},
     // Negation
-    { minus_tok,          {nat_}, nat_, integer_negation},
+    { minus_tok,          {nat_}, nat_, integer_negation, integer_negation_value},
     // Bitwise operations
-    { ampersand_tok,      {nat_, nat_}, nat_, integer_bitwise_and},
-    { pipe_tok,           {nat_, nat_}, nat_, integer_bitwise_or},
-    { caret_tok,          {nat_, nat_}, nat_, integer_bitwise_xor},
-    { tilde_tok,          {nat_, nat_}, nat_, integer_bitwise_complement},
+    { ampersand_tok,      {nat_, nat_}, nat_, integer_bitwise_and, integer_bitwise_and_value},
+    { pipe_tok,           {nat_, nat_}, nat_, integer_bitwise_or, integer_bitwise_or_value},
+    { caret_tok,          {nat_, nat_}, nat_, integer_bitwise_xor, integer_bitwise_xor_value},
+    { tilde_tok,          {nat_, nat_}, nat_, integer_bitwise_complement, integer_bitwise_complement_value},
     // Left shift
-    { langle_langle_tok,  {nat_, nat_}, nat_, arithmetic_left_shift},
-    { langle_langle_tok,  {int_, nat_}, int_, arithmetic_left_shift},
+    { langle_langle_tok,  {nat_, nat_}, nat_, arithmetic_left_shift, left_shift_value},
+    { langle_langle_tok,  {int_, nat_}, int_, arithmetic_left_shift, left_shift_value},
     // Right shift
-    { rangle_rangle_tok,  {nat_, nat_}, nat_, logical_right_shift},
-    { rangle_rangle_tok,  {int_, nat_}, int_, arithmetic_right_shift},
+    { rangle_rangle_tok,  {nat_, nat_}, nat_, logical_right_shift, right_shift_value},
+    { rangle_rangle_tok,  {int_, nat_}, int_, arithmetic_right_shift, right_shift_value},
     // Logical operators
-    { and_tok,            {bool_, bool_}, bool_, bool_and},
-    { or_tok,             {bool_, bool_}, bool_, bool_or},
-    { not_tok,            {bool_, bool_}, bool_, bool_not},
+    { and_tok,            {bool_, bool_}, bool_, bool_and, bool_and_value},
+    { or_tok,             {bool_, bool_}, bool_, bool_or, bool_or_value},
+    { not_tok,            {bool_, bool_}, bool_, bool_not, bool_not_value},
 
     { "__bits",           {typename_, nat_, nat_}, typename_, eval_bits},
     { "__net_str",        {nat_}, typename_,                  eval_net_str_type},
@@ -507,6 +572,18 @@ init_intrinsics() {
     { "__net_seq",        {typename_, bool_}, typename_,       eval_net_seq_type},
   };
 
+  // Register the value-level implementations.
+  builtins_ = new Decl_seq();
+  for (Spec& s : specs) {
+    builtins_->push_back(s.def);
+    if (s.op)
+      value_ops_.insert({s.fn, s.op});
+    if (s.op == bool_and_value)
+      and_ = s.fn;
+    if (s.op == bool_or_value)
+      or_ = s.fn;
+  }
+
   // FIXME: This could be improved.
   if (not current_diagnostics()->empty()) {
     std::cerr << "internal compiler error\n";
@@ -522,4 +599,24 @@ init_intrinsics() {
 Decl*
 get_bitfield() { return bitfield_; }
 
+// Returns the sequence of builtin function definitions.
+Decl_seq*
+get_builtins() { return builtins_; }
+
+// Returns the value-level implementation of the builtin function b,
+// or nullptr if it has none.
+Value_op
+get_value_op(Builtin* b) {
+  auto iter = value_ops_.find(b);
+  return iter != value_ops_.end() ? iter->second : nullptr;
+}
+
+// Returns true if b is the short-circuiting logical and.
+bool
+is_builtin_and(Builtin* b) { return b == and_; }
+
+// Returns true if b is the short-circuiting logical or.
+bool
+is_builtin_or(Builtin* b) { return b == or_; }
+
 } // namespace steve
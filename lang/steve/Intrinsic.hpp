@@ -12,9 +12,22 @@
 namespace steve {
 
 struct Decl;
+struct Value;
 
 Decl* get_bitfield();
 
+Decl_seq* get_builtins();
+
+// A value-level implementation of a builtin function, taking an array
+// of argument values. Compiled evaluation calls these directly rather
+// than building argument expressions.
+using Value_op = Value (*)(const Value*);
+
+Value_op get_value_op(Builtin*);
+
+bool is_builtin_and(Builtin*);
+bool is_builtin_or(Builtin*);
+
 } // namespace steve
 
 #endif
@@ -23,6 +23,7 @@ init_lang() {
 
 } // namespace
 
+extern void init_scan();
 extern void init_tokens();
 extern void init_trees();
 extern void init_exprs();
@@ -33,6 +34,7 @@ Language::Language()
   : Scope_guard(builtin_scope)
 {
   init_lang();
+  init_scan();
   init_tokens();
   init_trees();
   init_exprs();
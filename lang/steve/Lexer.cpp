@@ -1,8 +1,8 @@
 
 #include <steve/Lexer.hpp>
 #include <steve/Comment.hpp>
+#include <steve/Scan.hpp>
 
-#include <cctype>
 #include <iostream>
 #include <map>
 
@@ -11,72 +11,66 @@ namespace steve {
 namespace {
 
 // -------------------------------------------------------------------------- //
-// Comments
+// Locations
 
-// TODO: Only save comments on the input file, and only for certain
-// applications. We don't always need to do this.
-//
-// Save the comment.
-void 
-save_comment(Lexer& lex, String str) {
-  comments().save(lex.loc, str);
+// Returns the source offset of the position p. Positions in a string
+// have no source offset.
+inline Source_offset
+offset(const Lexer& lex, Lexer::Iterator p) {
+  return lex.file ? lex.file->offset(p) : 0;
 }
 
-// If the previous token was a comment, then we need to break
-// its adjacency with the previous comment.
-//
-// TODO: Only do this when actually managing comments.
-void
-break_comment_block(Lexer& lex) {
-  if (lex.toks.size() > 1) {
-    Token& last = lex.toks[lex.toks.size() - 1];
-    if (last.kind == comment_tok)
-      comments().reset();
-  }
+// Returns the source location of the position p.
+inline Location
+location(const Lexer& lex, Lexer::Iterator p) {
+  return Location(offset(lex, p));
+}
+
+
+// -------------------------------------------------------------------------- //
+// Comments
+
+// Save the comment starting at the position p. If any tokens were
+// lexed since the previous comment, then that comment's block is
+// closed. Comments are not saved when lexing a string.
+void 
+save_comment(Lexer& lex, Lexer::Iterator p, String str) {
+  if (not lex.file)
+    return;
+  if (lex.toks.size() != lex.comment_mark)
+    comments().reset();
+  comments().save(location(lex, p), str);
+  lex.comment_mark = lex.toks.size();
 }
 
 // -------------------------------------------------------------------------- //
 // Lexer control
 
-// Advance the lexer by n characters assuming that a) the new position
-// is not past the limit, and b) a newline sequence is not included
-// in that string.
+// Advance the lexer by n characters assuming that the new position
+// is not past the limit.
 inline void
-advance(Lexer& lex, int n = 1) {
-  lex.first += n;
-  lex.loc.col += n;
-}
+advance(Lexer& lex, int n = 1) { lex.first += n; }
 
-// Save a token having the given location, symbol, and text.
+// Save a token starting at the position p and having the given
+// symbol and text.
 inline void
-save(Lexer& lex, Token_kind k, String str) {
-  lex.toks.emplace_back(lex.loc, k, str);
-  break_comment_block(lex);
+save(Lexer& lex, Lexer::Iterator p, Token_kind k, String str) {
+  lex.toks.emplace_back(offset(lex, p), k, str);
 }
 
+// Save a token starting at the current character.
+inline void
+save(Lexer& lex, Token_kind k, String str) { save(lex, lex.first, k, str); }
+
 // -------------------------------------------------------------------------- //
 // Characters
-
-// Returns true if c is in [a-zA-Z_].
-inline bool
-is_id_head(char c) { return std::isalpha(c) || c == '_'; }
-
-// Returns true if c is in [a-zA-Z0-9_].
-inline bool
-is_id_rest(char c) {return std::isalpha(c) || std::isdigit(c) || c == '_'; }
-
-// Returns true if c is in [0-9].
-inline bool
-is_digit(char c) { return std::isdigit(c); }
+//
+// See Scan.hpp for the character classification functions.
 
 // Returns true if c is in [0-1].
 inline bool
 is_bin_digit(char c) { return c == '0' || c == '1'; }
 
-// Returns true if c is in [0-9a-fA-F]
-inline bool
-is_hex_digit(char c) { return std::isxdigit(c); }
-
 
 // -------------------------------------------------------------------------- //
 // Lexing rules
@@ -90,33 +84,29 @@ next_char_is(Lexer& lex, char c) {
     return false;
 }
 
-// Consume horizontal whitespace starting at the current character.
-//
-// TODO: Consume all consecutive horizontal whitespace?
+// Consume all consecutive horizontal whitespace starting at the
+// current character.
 void
-lex_space(Lexer& lex) { advance(lex); }
+lex_space(Lexer& lex) {
+  advance(lex, skip_space(lex.first + 1, lex.last) - lex.first);
+}
 
 // Consume a newline starting at the current character.
 //
 // TODO: Recognize CR as a newline character and handle combinations of
 // CR/LF and LF/CR as a single newline.
 void
-lex_newline(Lexer& lex) {
-  ++lex.first;
-  ++lex.loc.line;
-  lex.loc.col = 1;
-}
+lex_newline(Lexer& lex) { ++lex.first; }
 
 // Consume a comment, starting with "//" and up to (but not including)
-// the new line.
+// the new line. The text of the comment is saved only if comments
+// are being captured.
 void
 lex_comment(Lexer& lex) {
   auto iter = lex.first + 2;
-  lex.first += 2;
-  while (lex.first != lex.last and *lex.first != '\n')
-    ++lex.first;
-  String text(iter, lex.first);
-  save_comment(lex, text);  
+  lex.first = find_newline(iter, lex.last);
+  if (lex.capture_comments)
+    save_comment(lex, iter - 2, String(iter, lex.first));
 }
 
 // Consume an n-character lexeme, creating a token.
@@ -137,7 +127,7 @@ lex_digraph(Lexer& lex, Token_kind k) { return lex_ngraph(lex, k, 2); }
 
 void
 lex_error(Lexer& lex) {
-  std::cerr << lex.loc << ": error: unrecognized character '" 
+  std::cerr << location(lex, lex.first) << ": error: unrecognized character '" 
             << *lex.first << "'\n";
   advance(lex);
 }
@@ -145,9 +135,7 @@ lex_error(Lexer& lex) {
 // Consume an identifier or keyword.
 void
 lex_id(Lexer& lex) {
-  Lexer::Iterator iter = lex.first + 1;
-  while (iter != lex.last and is_id_rest(*iter))
-    ++iter;
+  Lexer::Iterator iter = skip_id_rest(lex.first + 1, lex.last);
   String str(lex.first, iter);
   if (Token_kind k = keyword(str))
     save(lex, k, str);
@@ -251,9 +239,9 @@ lex_ipv4(Lexer& lex) {
           String str(iter, lex.first);
           
           if(ip_is_optional(str))
-            save(lex, ipv4_masked_tok, str);
+            save(lex, iter, ipv4_masked_tok, str);
           else
-            save(lex, ipv4_tok, str);
+            save(lex, iter, ipv4_tok, str);
           return true;
         }
 
@@ -262,13 +250,26 @@ lex_ipv4(Lexer& lex) {
   return false;
 }
 
+// Lex the next token. Identifiers, numbers, and whitespace are
+// recognized by their character class; everything else is a
+// punctuator or an error.
 void 
 lex(Lexer& lex) {
-  switch (*lex.first) {
-  // Horizontal whitespace
-  case ' ':
-  case '\t': lex_space(lex); break;
+  Char_class k = char_class(*lex.first);
+  if (k & id_head_char) {
+    // TODO: This could be an ipv6 address.
+    return lex_id(lex);
+  }
+  if (k & digit_char) {
+    // Try a complete ipv4 address first.
+    if (not lex_ipv4(lex))
+      lex_num(lex);
+    return;
+  }
+  if (k & space_char)
+    return lex_space(lex);
 
+  switch (*lex.first) {
   // Vertical whitespace
   case '\n': lex_newline(lex); break;
 
@@ -339,20 +340,7 @@ lex(Lexer& lex) {
     break;
 
   default:
-    // Maybe this is an identifier, keyowrd, number, or address.
-    if (is_id_head(*lex.first)) {
-      // TODO: This could be an ipv6 address.
-      lex_id(lex);      
-    }
-    else if (is_digit(*lex.first)) {
-      // Try a complete ipv4 address first.
-      if (lex_ipv4(lex))
-        break;
-      else
-        lex_num(lex);
-    }
-    else
-      lex_error(lex);
+    lex_error(lex);
     break;
   }
 }
@@ -365,7 +353,10 @@ Lexer::operator()(File* file, Iterator f, Iterator l) {
 
   first = f;
   last = l;
-  loc = Location(file);
+  this->file = file;
+  comment_mark = 0;
+  if (capture_comments and file)
+    comments().clear(file);
 
   while (first != last)
     lex(*this);
@@ -14,9 +14,13 @@
 namespace steve {
 
 // The lexer is responsible for decomposing a character stream into
-// a token stream.
+// a token stream. Note that the lexer iterates directly over the
+// text of a file, which may be mapped into memory.
+//
+// Comments are discarded unless capture_comments is set, in which
+// case they are saved in the comment manager (see Comment.hpp).
 struct Lexer {
-  using Iterator = std::string::const_iterator;
+  using Iterator = File::iterator;
 
   Tokens operator()(File*);
   Tokens operator()(File*, const std::string&);
@@ -24,9 +28,12 @@ struct Lexer {
 
   Iterator first;    // The current lex position
   Iterator last;     // The final lex position
-  Location loc;      // The current source location
+  File* file;        // The file being lexed, if any
   Tokens toks;       // The current token list
   Diagnostics diags;
+
+  bool capture_comments = false; // True if comments are saved
+  std::size_t comment_mark = 0;  // The number of tokens at the last comment
 };
 
 } // namespace steve
@@ -3,12 +3,12 @@ namespace steve {
 
 inline Tokens
 Lexer::operator()(File* f) {
-  return (*this)(f, f->text());
+  return (*this)(f, f->begin(), f->end());
 }
 
 inline Tokens
 Lexer::operator()(File* f, const std::string& s) {
-  return (*this)(f, s.begin(), s.end());
+  return (*this)(f, s.data(), s.data() + s.size());
 }
 
 } // namespace steve
@@ -0,0 +1,103 @@
+
+// This program measures the throughput of the lexer for each of the
+// scanning kernels supported by the host, and checks that every kernel
+// produces the same tokens.
+//
+//    lexer_throughput <dir> [<iterations>]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <steve/Language.hpp>
+#include <steve/Lexer.hpp>
+#include <steve/Scan.hpp>
+
+using namespace steve;
+
+using Clock = std::chrono::steady_clock;
+using Files = std::vector<File*>;
+
+// Collect the source files under the directory d.
+Files
+find_sources(const Path& d) {
+  Files fs;
+  for (fs::recursive_directory_iterator i(d), e; i != e; ++i)
+    if (i->path().extension() == ".steve")
+      fs.push_back(get_file(i->path()));
+  return fs;
+}
+
+bool
+same_tokens(const Tokens& a, const Tokens& b) {
+  if (a.size() != b.size())
+    return false;
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    if (a[i].offset() != b[i].offset() || a[i].symbol() != b[i].symbol())
+      return false;
+  }
+  return true;
+}
+
+// Lex every file using the current scanning kernels.
+std::vector<Tokens>
+lex_all(const Files& fs) {
+  std::vector<Tokens> toks;
+  for (File* f : fs) {
+    Lexer lex;
+    toks.push_back(lex(f));
+  }
+  return toks;
+}
+
+int
+main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::cerr << "usage: lexer_throughput <dir> [<iterations>]\n";
+    return 1;
+  }
+  Language lang;
+
+  Files fs = find_sources(argv[1]);
+  int iters = argc > 2 ? std::atoi(argv[2]) : 200;
+  std::size_t bytes = 0;
+  for (File* f : fs)
+    bytes += f->size();
+  std::cout << fs.size() << " files, " << bytes << " bytes, "
+            << iters << " iterations\n";
+
+  // Compute the reference tokens.
+  use_scan_isa(scalar_isa);
+  std::vector<Tokens> ref = lex_all(fs);
+  std::size_t ntoks = 0;
+  for (const Tokens& toks : ref)
+    ntoks += toks.size();
+  std::cout << ntoks << " tokens, " << ntoks * sizeof(Token) << " bytes\n";
+
+  int status = 0;
+  for (Scan_isa isa : {scalar_isa, sse2_isa, avx2_isa}) {
+    if (not use_scan_isa(isa))
+      continue;
+
+    // Check the results.
+    std::vector<Tokens> toks = lex_all(fs);
+    for (std::size_t i = 0; i < fs.size(); ++i) {
+      if (not same_tokens(ref[i], toks[i])) {
+        std::cerr << scan_isa_name(isa) << ": token mismatch in "
+                  << fs[i]->path() << '\n';
+        status = 1;
+      }
+    }
+
+    // Measure throughput.
+    auto start = Clock::now();
+    for (int n = 0; n < iters; ++n)
+      lex_all(fs);
+    auto stop = Clock::now();
+    double secs = std::chrono::duration<double>(stop - start).count();
+    std::cout << scan_isa_name(isa) << ": " 
+              << (bytes * iters) / secs / 1e6 << " MB/s\n";
+  }
+  return status;
+}
@@ -6,34 +6,68 @@
 
 namespace steve {
 
+// Initialize the location to the end the given file. For a
+// location l initialized in this way, l.is_eof() is true. If f
+// is null, the location is internal.
+Location::Location(eof_location_t, File* f)
+  : off_(f ? f->base() + f->size() : 0) { }
+
+// Returns true if the location is the end of its file.
+bool
+Location::is_eof() const {
+  File* f = file();
+  return f and off_ == f->base() + f->size();
+}
+
+// Returns the file containing the location, or nullptr if the
+// location is internal or its file has been released.
+File*
+Location::file() const { return off_ ? find_file(off_) : nullptr; }
+
+// Returns the line and column of the location. For internal
+// locations, this is (0, 0).
+Source_position
+Location::position() const {
+  if (File* f = file())
+    return f->position(off_);
+  return {0, 0};
+}
+
 // Return true if two source locations are vertically adjacent. That
 // is, they locations are in the same file, and same column, but differ
 // by only one line.
 bool
 adjacent(const Location& a, const Location& b) {
-  if (a.file != b.file)
+  if (a.file() != b.file())
     return false;
-  if (a.col != b.col)
+  Source_position p = a.position();
+  Source_position q = b.position();
+  if (p.col != q.col)
     return false;
-  if (std::abs(a.line - b.line) != 1)
+  if (std::abs(p.line - q.line) != 1)
     return false;
   return true;
 }
 
 bool
 above(const Location& a, const Location& b) {
-  return b.line - a.line == 1;
+  return b.line() - a.line() == 1;
 }
 
-// Output for source locations.
+// Output for source locations. A location whose file has been
+// released is unknown.
 std::ostream&
 operator<<(std::ostream& os, const Location& loc) {
   if (loc.is_internal())
     return os << "<internal>";
-  os << loc.file->path().c_str() << ':';
+  File* f = loc.file();
+  if (not f)
+    return os << "<unknown>";
+  os << f->path().c_str() << ':';
   if (loc.is_eof())
     return os << "<eof>";
-  return os << loc.line << ':' << loc.col;
+  Source_position p = f->position(loc.offset());
+  return os << p.line << ':' << p.col;
 }
 
 } // namespace steve
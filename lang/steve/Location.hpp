@@ -2,12 +2,20 @@
 #ifndef STEVE_LOCATION_HPP
 #define STEVE_LOCATION_HPP
 
+#include <cstdint>
 #include <iosfwd>
 
 namespace steve {
 
 class File;
 
+// Every loaded file reserves a contiguous range of a global source
+// offset space. This allows a position in any file to be encoded as a
+// single 32-bit integer. Offset 0 denotes no position. The range of
+// each file includes one offset past its last character, which denotes
+// the end of that file. See File.hpp.
+using Source_offset = std::uint32_t;
+
 // A univalent type used to construct a location that does not
 // refer to a source code location.
 enum no_location_t { no_location };
@@ -15,26 +23,34 @@ enum no_location_t { no_location };
 // A univalent type used to construct the EOF location.
 enum eof_location_t { eof_location };
 
-// A location represents a position in a source file, indicated by its
-// line and character offset.
-//
-// TODO: Can we further compact source locations so they can be
-// enregistered? This is a large project and probably entails
-// the restructing of locations as simply pointers into another
-// data structure.
+// The line and column of a position in a source file.
+struct Source_position {
+  int line;
+  int col;
+};
+
+// A location represents a position in a source file. A location is
+// a single source offset, which is decoded into a file, line, and
+// column only when needed (e.g., when printing diagnostics).
 class Location {
 public:
   Location() = default;
-  Location(File*);
+  explicit Location(Source_offset);
   Location(no_location_t);
   Location(eof_location_t, File*);
-  
+
+  Source_offset offset() const;
+
   bool is_internal() const;
   bool is_eof() const;
 
-  int   line = 1;
-  int   col  = 1;
-  File* file = nullptr;
+  File* file() const;
+  Source_position position() const;
+  int line() const;
+  int col() const;
+
+private:
+  Source_offset off_ = 0;
 };
 
 // Equality comparison
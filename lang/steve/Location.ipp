@@ -1,33 +1,35 @@
 
 namespace steve {
 
-// Default initialize a location into the current file.
 inline
-Location::Location(File* f)
-  : file(f) { }
+Location::Location(Source_offset n)
+  : off_(n) { }
 
 // Initialize an empty location. For a location l initialized in this
 // way, l.is_internal() is true.
 inline
 Location::Location(no_location_t)
-  : line(0), col(0), file(nullptr) { }
+  : off_(0) { }
 
-// Initialize the location to the end the given file. For a
-// location l initialized in this way, l.is_eof() is true.
-inline
-Location::Location(eof_location_t, File* f)
-  : line(-1), col(0), file(f) { }
+// Returns the source offset of the location.
+inline Source_offset
+Location::offset() const { return off_; }
 
 inline bool
-Location::is_internal() const { return not file; }
+Location::is_internal() const { return off_ == 0; }
 
-inline bool
-Location::is_eof() const { return line == -1; }
+// Returns the line of the location.
+inline int
+Location::line() const { return position().line; }
+
+// Returns the column of the location.
+inline int
+Location::col() const { return position().col; }
 
 // Equality comparison
 inline bool
 operator==(const Location& a, const Location& b) {
-  return a.file == b.file && a.line == b.line && a.col == b.col;
+  return a.offset() == b.offset();
 }
 
 inline bool
@@ -21,13 +21,21 @@ cli::Help_command    help_cmd;
 cli::Version_command version_cmd;
 cli::Extract_command extract_cmd;
 cli::Test_command    test_cmd;
+cli::Batch_command   batch_cmd;
+cli::Watch_command   watch_cmd;
+
+int run_command(int, char**);
+cli::Serve_command   serve_cmd(run_command);
 
 // Populate the command map
 cli::Command_map commands {
   {"help",    &help_cmd},
   {"version", &version_cmd},
   {"extract", &extract_cmd},
-  {"test",    &test_cmd}
+  {"test",    &test_cmd},
+  {"batch",   &batch_cmd},
+  {"watch",   &watch_cmd},
+  {"serve",   &serve_cmd}
 };
 
 // FIXME: Move these into the help function.
@@ -45,14 +53,9 @@ command_error(const char* cmd) {
   return -1;
 }
 
+// Run the command line in this process.
 int
-main(int argc, char* argv[]) {
-  // Initialize the configuration
-  Configuration cfg;
-
-  // Initialize the language environment.
-  Language lang;
-
+run_command(int argc, char* argv[]) {
   // Initialize the root diagnostics.  
   Diagnostics diags;
   Diagnostics_guard dg = diags;
@@ -65,8 +68,6 @@ main(int argc, char* argv[]) {
   if (last < 0 or last == argc)
     return usage_error();
 
-  // tOIDO
-
   // Get the command.
   auto iter = commands.find(argv[last]);
   if (iter == commands.end())
@@ -81,3 +82,19 @@ main(int argc, char* argv[]) {
   
   return 0;
 }
+
+int
+main(int argc, char* argv[]) {
+  // Forward the command to the compile server, if one is running.
+  int status;
+  if (cli::forward_command(argc, argv, status))
+    return status;
+
+  // Initialize the configuration
+  Configuration cfg;
+
+  // Initialize the language environment.
+  Language lang;
+
+  return run_command(argc, argv);
+}
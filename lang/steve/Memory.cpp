@@ -1,2 +1,90 @@
 
-#include <steve/Memory.hpp>
\ No newline at end of file
+#include <steve/Memory.hpp>
+
+#include <new>
+
+namespace steve {
+
+// -------------------------------------------------------------------------- //
+// Arena
+
+Arena::Arena(std::size_t n)
+  : block_(n), ptr_(nullptr), end_(nullptr), used_(0), reserved_(0)
+{ }
+
+Arena::~Arena() {
+  for (const auto& b : blocks_)
+    ::operator delete(b.first);
+}
+
+// Returns true if p points into memory allocated from the arena.
+bool
+Arena::owns(const void* p) const {
+  const char* c = static_cast<const char*>(p);
+  for (const auto& b : blocks_)
+    if (b.first <= c and c < b.first + b.second)
+      return true;
+  return false;
+}
+
+// Allocate a new block that can hold n bytes with alignment a, and
+// allocate from that. Oversized requests get a block of their own
+// so that the current block can still be used.
+void*
+Arena::grow(std::size_t n, std::size_t a) {
+  std::size_t size = n + a;
+  bool large = size > block_ / 4;
+  if (not large)
+    size = block_;
+  char* p = static_cast<char*>(::operator new(size));
+  blocks_.emplace_back(p, size);
+  reserved_ += size;
+  if (not large) {
+    ptr_ = p;
+    end_ = p + size;
+    return allocate(n, a);
+  }
+  used_ += n;
+  return p + (-reinterpret_cast<std::uintptr_t>(p) & (a - 1));
+}
+
+
+
+// -------------------------------------------------------------------------- //
+// Region allocation
+
+namespace {
+
+// The current arena. Each thread selects its own.
+thread_local Arena* arena_ = nullptr;
+
+} // namespace
+
+// Returns the current arena, or nullptr if nodes are allocated on
+// the heap.
+Arena*
+current_arena() { return arena_; }
+
+// Set the current arena. If a is null, nodes are allocated on the
+// heap.
+void
+use_arena(Arena* a) { arena_ = a; }
+
+Arena_guard::Arena_guard(Arena& a)
+  : saved(arena_) 
+{ 
+  arena_ = &a;
+}
+
+Arena_guard::~Arena_guard() { arena_ = saved; }
+
+// Allocate n bytes with alignment a from the current arena or, if there
+// is no current arena, the heap.
+void*
+gc_allocate(std::size_t n, std::size_t a) {
+  if (arena_)
+    return arena_->allocate(n, a);
+  return ::operator new(n);
+}
+
+} // namespace steve
@@ -1,17 +1,194 @@
 #ifndef STEVE_MEMORY_HPP
 #define STEVE_MEMORY_HPP
 
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
 #include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace steve {
 
-struct Gc { };
 
+// An arena is a region of memory from which objects are allocated by
+// bumping a pointer. Memory is reclaimed only when the arena is
+// destroyed; destructors of allocated objects are never run.
+class Arena {
+public:
+  explicit Arena(std::size_t = 64 * 1024);
+  ~Arena();
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  void* allocate(std::size_t, std::size_t = alignof(std::max_align_t));
+
+  std::size_t used() const;
+  std::size_t reserved() const;
+
+  bool owns(const void*) const;
+
+private:
+  void* grow(std::size_t, std::size_t);
+
+  std::vector<std::pair<char*, std::size_t>> blocks_;
+  std::size_t block_;    // The default block size
+  char* ptr_;            // The next free byte
+  char* end_;            // The end of the current block
+  std::size_t used_;     // Total bytes allocated
+  std::size_t reserved_; // Total bytes in all blocks
+};
+
+// Allocate n bytes with alignment a.
+inline void*
+Arena::allocate(std::size_t n, std::size_t a) {
+  std::size_t pad = -reinterpret_cast<std::uintptr_t>(ptr_) & (a - 1);
+  if (std::size_t(end_ - ptr_) < n + pad)
+    return grow(n, a);
+  char* p = ptr_ + pad;
+  ptr_ = p + n;
+  used_ += n;
+  return p;
+}
+
+// Returns the number of bytes allocated from the arena.
+inline std::size_t
+Arena::used() const { return used_; }
+
+// Returns the number of bytes reserved by the arena.
+inline std::size_t
+Arena::reserved() const { return reserved_; }
+
+
+// -------------------------------------------------------------------------- //
+// Region allocation
+//
+// Nodes are allocated from the current arena, which is selected by the
+// phase of translation that creates them (e.g., parse trees are
+// allocated in an arena that is released after elaboration). When no
+// arena is current, nodes are allocated on the heap. In either case,
+// nodes are never deleted.
+
+Arena* current_arena();
+void use_arena(Arena*);
+
+// An RAII helper that makes an arena current for the duration of a
+// scope, restoring the previous arena on exit.
+struct Arena_guard {
+  explicit Arena_guard(Arena&);
+  ~Arena_guard();
+
+  Arena* saved; // The previous arena
+};
+
+void* gc_allocate(std::size_t, std::size_t);
+
+// The allocation hook for nodes. Objects of classes derived from Gc
+// are allocated from the current arena.
+struct Gc {
+  static void* operator new(std::size_t n) { 
+    return gc_allocate(n, alignof(std::max_align_t)); 
+  }
+
+  static void operator delete(void*) { }
+};
+
+// The Gc allocator allocates the elements of node sequences from the
+// arena that was current when the sequence was created. Memory is
+// reclaimed only with the arena, so a sequence that grows leaves its
+// previous storage behind.
 template<typename T>
-  using Gc_allocator = std::allocator<T>;
+  struct Gc_allocator {
+    using value_type = T;
+
+    Gc_allocator();
+    template<typename U> Gc_allocator(const Gc_allocator<U>&);
+
+    T* allocate(std::size_t);
+    void deallocate(T*, std::size_t);
+
+    Arena* arena;
+  };
+
+template<typename T, typename U>
+  bool operator==(const Gc_allocator<T>&, const Gc_allocator<U>&);
+
+template<typename T, typename U>
+  bool operator!=(const Gc_allocator<T>&, const Gc_allocator<U>&);
+
+
+// -------------------------------------------------------------------------- //
+// Small vectors
+
+// A small vector is a sequence that stores up to N elements in place,
+// and moves its elements to the heap only when it grows beyond that.
+// This is used for short, transient sequences (e.g., the arguments of
+// a call) that would otherwise allocate each time they are built.
+template<typename T, std::size_t N>
+  class Small_vector {
+  public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    Small_vector();
+    Small_vector(std::initializer_list<T>);
+    ~Small_vector();
+
+    // Copy semantics
+    Small_vector(const Small_vector&);
+    Small_vector& operator=(const Small_vector&);
+
+    // Move semantics
+    Small_vector(Small_vector&&);
+    Small_vector& operator=(Small_vector&&);
+
+    // Capacity
+    bool empty() const { return first_ == last_; }
+    std::size_t size() const { return last_ - first_; }
+    std::size_t capacity() const { return limit_ - first_; }
+    void reserve(std::size_t);
+
+    // Element access
+    T& operator[](std::size_t n) { return first_[n]; }
+    const T& operator[](std::size_t n) const { return first_[n]; }
+    T& front() { return *first_; }
+    const T& front() const { return *first_; }
+    T& back() { return *(last_ - 1); }
+    const T& back() const { return *(last_ - 1); }
+    T* data() { return first_; }
+    const T* data() const { return first_; }
+
+    // Iterators
+    iterator begin() { return first_; }
+    iterator end() { return last_; }
+    const_iterator begin() const { return first_; }
+    const_iterator end() const { return last_; }
+
+    // Modifiers
+    void push_back(const T&);
+    void push_back(T&&);
+    template<typename... Args> void emplace_back(Args&&...);
+    void clear();
+
+  private:
+    bool is_small() const;
+    T* buffer();
+    void release();
+    void relocate(T*, std::size_t);
+
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type buf_[N];
+    T* first_;
+    T* last_;
+    T* limit_;
+  };
 
 } // namespace steve
 
+#include <steve/Memory.ipp>
+
 #if 0
 
 // Boehm GC
@@ -0,0 +1,205 @@
+
+namespace steve {
+
+// -------------------------------------------------------------------------- //
+// Gc allocator
+
+// Initialize the allocator to allocate from the current arena.
+template<typename T>
+  inline
+  Gc_allocator<T>::Gc_allocator()
+    : arena(current_arena()) { }
+
+template<typename T>
+  template<typename U>
+    inline
+    Gc_allocator<T>::Gc_allocator(const Gc_allocator<U>& a)
+      : arena(a.arena) { }
+
+// Allocate storage for n objects of type T.
+template<typename T>
+  inline T*
+  Gc_allocator<T>::allocate(std::size_t n) {
+    if (arena)
+      return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+    return static_cast<T*>(::operator new(n * sizeof(T)));
+  }
+
+// Release the storage for n objects of type T. This has no effect
+// when allocating from an arena.
+template<typename T>
+  inline void
+  Gc_allocator<T>::deallocate(T* p, std::size_t n) {
+    if (not arena)
+      ::operator delete(p);
+  }
+
+template<typename T, typename U>
+  inline bool
+  operator==(const Gc_allocator<T>& a, const Gc_allocator<U>& b) {
+    return a.arena == b.arena;
+  }
+
+template<typename T, typename U>
+  inline bool
+  operator!=(const Gc_allocator<T>& a, const Gc_allocator<U>& b) {
+    return a.arena != b.arena;
+  }
+
+
+// -------------------------------------------------------------------------- //
+// Small vector
+
+template<typename T, std::size_t N>
+  inline
+  Small_vector<T, N>::Small_vector()
+    : first_(buffer()), last_(first_), limit_(first_ + N) { }
+
+template<typename T, std::size_t N>
+  inline
+  Small_vector<T, N>::Small_vector(std::initializer_list<T> list)
+    : Small_vector()
+  {
+    reserve(list.size());
+    for (const T& x : list)
+      push_back(x);
+  }
+
+template<typename T, std::size_t N>
+  inline
+  Small_vector<T, N>::~Small_vector() { release(); }
+
+template<typename T, std::size_t N>
+  inline
+  Small_vector<T, N>::Small_vector(const Small_vector& s)
+    : Small_vector()
+  {
+    reserve(s.size());
+    for (const T& x : s)
+      push_back(x);
+  }
+
+template<typename T, std::size_t N>
+  inline Small_vector<T, N>&
+  Small_vector<T, N>::operator=(const Small_vector& s) {
+    if (this != &s) {
+      clear();
+      reserve(s.size());
+      for (const T& x : s)
+        push_back(x);
+    }
+    return *this;
+  }
+
+// Heap storage is taken from s. In-place elements are moved one
+// at a time.
+template<typename T, std::size_t N>
+  inline
+  Small_vector<T, N>::Small_vector(Small_vector&& s)
+    : Small_vector()
+  { *this = std::move(s); }
+
+template<typename T, std::size_t N>
+  inline Small_vector<T, N>&
+  Small_vector<T, N>::operator=(Small_vector&& s) {
+    if (this == &s)
+      return *this;
+    release();
+    if (s.is_small()) {
+      first_ = last_ = buffer();
+      limit_ = first_ + N;
+      for (T& x : s)
+        push_back(std::move(x));
+      s.clear();
+    } else {
+      first_ = s.first_;
+      last_ = s.last_;
+      limit_ = s.limit_;
+      s.first_ = s.last_ = s.buffer();
+      s.limit_ = s.first_ + N;
+    }
+    return *this;
+  }
+
+// Ensure that the vector can hold at least n elements.
+template<typename T, std::size_t N>
+  void
+  Small_vector<T, N>::reserve(std::size_t n) {
+    if (n <= capacity())
+      return;
+    relocate(static_cast<T*>(::operator new(n * sizeof(T))), n);
+  }
+
+// Move the elements into the heap storage p, which holds n elements,
+// and release the current storage.
+template<typename T, std::size_t N>
+  void
+  Small_vector<T, N>::relocate(T* p, std::size_t n) {
+    T* q = p;
+    for (T* i = first_; i != last_; ++i, ++q) {
+      new (q) T(std::move(*i));
+      i->~T();
+    }
+    if (not is_small())
+      ::operator delete(first_);
+    first_ = p;
+    last_ = q;
+    limit_ = p + n;
+  }
+
+template<typename T, std::size_t N>
+  inline void
+  Small_vector<T, N>::push_back(const T& x) { emplace_back(x); }
+
+template<typename T, std::size_t N>
+  inline void
+  Small_vector<T, N>::push_back(T&& x) { emplace_back(std::move(x)); }
+
+// Construct a new element at the end of the vector. When the vector
+// is full, the element is constructed in the new storage before the
+// existing elements are moved, since the arguments may refer to them.
+template<typename T, std::size_t N>
+  template<typename... Args>
+    inline void
+    Small_vector<T, N>::emplace_back(Args&&... args) {
+      if (last_ == limit_) {
+        std::size_t n = 2 * capacity();
+        T* p = static_cast<T*>(::operator new(n * sizeof(T)));
+        new (p + size()) T(std::forward<Args>(args)...);
+        relocate(p, n);
+      } else {
+        new (last_) T(std::forward<Args>(args)...);
+      }
+      ++last_;
+    }
+
+// Destroy the elements of the vector, keeping its storage.
+template<typename T, std::size_t N>
+  inline void
+  Small_vector<T, N>::clear() {
+    for (T* i = first_; i != last_; ++i)
+      i->~T();
+    last_ = first_;
+  }
+
+// Returns true if the elements are stored in place.
+template<typename T, std::size_t N>
+  inline bool
+  Small_vector<T, N>::is_small() const {
+    return first_ == reinterpret_cast<const T*>(buf_);
+  }
+
+template<typename T, std::size_t N>
+  inline T*
+  Small_vector<T, N>::buffer() { return reinterpret_cast<T*>(buf_); }
+
+// Destroy the elements and release any heap storage.
+template<typename T, std::size_t N>
+  inline void
+  Small_vector<T, N>::release() {
+    clear();
+    if (not is_small())
+      ::operator delete(first_);
+  }
+
+} // namespace steve
@@ -0,0 +1,70 @@
+
+// This program reports the number of heap allocations and the peak
+// resident set size needed to load (lex, parse, and elaborate) a
+// module.
+//
+//    module_memory <file>
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#include <sys/resource.h>
+
+#include <steve/Config.hpp>
+#include <steve/Error.hpp>
+#include <steve/Language.hpp>
+#include <steve/Module.hpp>
+
+using namespace steve;
+
+// Allocation counters. These are updated by the replacements of
+// the global allocation functions below.
+std::size_t allocs_ = 0;
+std::size_t bytes_ = 0;
+
+void*
+operator new(std::size_t n) {
+  ++allocs_;
+  bytes_ += n;
+  if (void* p = std::malloc(n ? n : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void
+operator delete(void* p) noexcept { std::free(p); }
+
+void
+operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// Returns the peak resident set size in kilobytes.
+long
+peak_rss() {
+  rusage r;
+  getrusage(RUSAGE_SELF, &r);
+  return r.ru_maxrss;
+}
+
+int
+main(int argc, char* argv[]) {
+  if (argc != 2) {
+    std::cerr << "usage: module_memory <file>\n";
+    return 1;
+  }
+  Configuration cfg;
+  Language lang;
+  Diagnostics diags;
+  Diagnostics_guard dg = diags;
+
+  std::size_t allocs = allocs_;
+  std::size_t bytes = bytes_;
+  long rss = peak_rss();
+  Module* m = load_file(argv[1]);
+  std::cout << (m ? "loaded " : "failed to load ") << argv[1] << '\n'
+            << allocs_ - allocs << " allocations, " 
+            << bytes_ - bytes << " bytes\n"
+            << "peak rss: " << peak_rss() << " KB (" 
+            << peak_rss() - rss << " KB while loading)\n";
+  return 0;
+}
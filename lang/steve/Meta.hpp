@@ -2,6 +2,7 @@
 #ifndef STEVE_META_HPP
 #define STEVE_META_HPP
 
+#include <cstddef>
 #include <type_traits>
 
 // This module provides various metaprogramming facilities.
@@ -11,6 +12,18 @@ namespace steve {
 template<bool B, typename T>
   using Requires = typename std::enable_if<B, T>::type;
 
+// A sequence of indexes. This is used to expand the elements of
+// a tuple into an argument list.
+template<std::size_t... N>
+  struct Indices { };
+
+// Make_indices<N>::type is Indices<0, 1, ..., N - 1>.
+template<std::size_t N, std::size_t... Ns>
+  struct Make_indices : Make_indices<N - 1, N - 1, Ns...> { };
+
+template<std::size_t... Ns>
+  struct Make_indices<0, Ns...> { using type = Indices<Ns...>; };
+
 } // namespace steve
 
 #endif
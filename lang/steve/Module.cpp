@@ -1,19 +1,30 @@
 
 #include <steve/Module.hpp>
 #include <steve/Ast.hpp>
+#include <steve/Closure.hpp>
 #include <steve/Config.hpp>
+#include <steve/Depend.hpp>
 #include <steve/Elaborator.hpp>
+#include <steve/Evaluator.hpp>
+#include <steve/Image.hpp>
 #include <steve/Lexer.hpp>
+#include <steve/Overload.hpp>
 #include <steve/Parser.hpp>
 #include <steve/Scope.hpp>
 #include <steve/Syntax.hpp>
+#include <steve/Task.hpp>
 #include <steve/Token.hpp>
 #include <steve/Type.hpp>
 
+#include <condition_variable>
 #include <fstream>
 #include <iostream>
 #include <iterator>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <unistd.h>
 
@@ -50,6 +61,36 @@ register_module(Module* m) {
   return m;
 }
 
+// Each file module is allocated in its own arena. A rebuilt module is
+// allocated in the same arena, since its new declarations refer to the
+// ones it reuses. The arenas are released when the modules are
+// forgotten.
+using Arena_map = std::map<Path, std::unique_ptr<Arena>>;
+Arena_map arenas_;
+
+// The bytes allocated by rebuilds since the modules were last
+// forgotten. This bounds the memory held by replaced declarations.
+std::size_t rebuilt_ = 0;
+
+// Rebuilds may allocate this many bytes before the modules are
+// forgotten to release the declarations they replaced.
+constexpr std::size_t rebuild_limit = 1 << 20;
+
+// The number of times the modules have been forgotten.
+std::size_t generation_ = 0;
+
+// The dependencies of each file module elaborated from source.
+std::unordered_map<const Module*, Module_deps> deps_;
+
+// Create the arena for the module at the given path.
+inline Arena&
+make_module_arena(const Path& p) {
+  std::unique_ptr<Arena>& a = arenas_[p];
+  steve_assert(not a, format("module '{}' already allocated", p.c_str()));
+  a.reset(new Arena());
+  return *a;
+}
+
 // Create an initial module. This allocates the module type, but leaves
 // the declaration sequence uninitialized.
 inline Module*
@@ -73,60 +114,434 @@ finish_module(Module* m, Decl_seq* ds) {
 }
 
 
+// -------------------------------------------------------------------------- //
+// Module scheduling
+//
+// Before a module is elaborated, the file modules that it imports are
+// lexed and parsed in the background, as are the modules that those
+// import, and so on. Elaboration is not parallel: a module is still
+// elaborated when its import declaration is elaborated, which happens
+// after the modules on which it depends have been elaborated. By then,
+// its parse has usually finished.
+//
+// A parse that has not started when it is needed is run by the thread
+// that needs it. Parses that are never needed (e.g., because an import
+// failed) are discarded when the outermost module has been loaded, so
+// no background work outlives the loading of a module.
+//
+// Only the loading thread registers modules, so each module is still
+// loaded exactly once.
+
+// Construct a path to a directory from a module-id.
+inline Path
+steve_dir_name(String id) { return id.str(); }
+
+// Construct a path ot a Steve file from a module-id.
+inline Path
+steve_file_name(String id) { return id.str() + ".steve"; }
+
+// The tokens and parse tree of a module file. The tree is allocated
+// in its own arena, which is released once the module has been
+// elaborated. If the file could not be lexed or parsed, there is no
+// tree, and the diagnostics say why.
+struct Parse {
+  File* file = nullptr;
+  Tokens toks;
+  Arena trees;
+  Tree* tree = nullptr;
+  Diagnostics diags;
+};
+
+using Parse_ptr = std::unique_ptr<Parse>;
+
+// Lex and parse the file f. Note that the parser is created before
+// its arena is made current.
+Parse_ptr
+parse_file(File* f) {
+  Diagnostics_guard guard;
+  Parse_ptr p(new Parse());
+  p->file = f;
+
+  Lexer lex;
+  lex.capture_comments = config().capture_comments;
+  p->toks = lex(f);
+  if (not lex.diags.empty()) {
+    p->diags = std::move(lex.diags);
+    return p;
+  }
+
+  Parser parse;
+  Tree* t;
+  {
+    Arena_guard ag(p->trees);
+    t = parse(p->toks);
+  }
+  if (not parse.diags.empty())
+    p->diags = std::move(parse.diags);
+  else
+    p->tree = t;
+  return p;
+}
+
+// The state of a scheduled parse. A parse is taken by the thread
+// that needs it, whether or not it has been run.
+enum Parse_state {
+  parse_queued,
+  parse_running,
+  parse_done,
+  parse_taken,
+};
+
+struct Parse_job {
+  Parse_job(const Path& p)
+    : path(p), state(parse_queued) { }
+
+  Path path;
+  Parse_state state;
+  Parse_ptr result;
+};
+
+using Parse_job_ptr = std::shared_ptr<Parse_job>;
+
+// The scheduler maintains the scheduled parses, indexed by path, and
+// the threads that run them. The threads are started when the first
+// parse is scheduled.
+struct Scheduler {
+  std::mutex mutex;
+  std::condition_variable finished;
+  std::map<Path, Parse_job_ptr> jobs;
+  bool cancel = false;
+  std::unique_ptr<Task_pool> pool;
+};
+
+Scheduler&
+scheduler() {
+  static Scheduler s;
+  return s;
+}
+
+// Returns true if imports are parsed in the background. Comments
+// are saved globally as files are lexed, so files are only lexed
+// by the loading thread when comments are needed.
+inline bool
+use_scheduler() {
+  return config().jobs > 1 and not config().capture_comments;
+}
+
+// Append the identifiers in the module name t to ids. Returns false
+// if the name is ill-formed.
+bool
+get_module_ids(Tree* t, std::vector<String>& ids) {
+  if (Dot_tree* dot = as<Dot_tree>(t))
+    return get_module_ids(dot->scope(), ids) and get_module_ids(dot->member(), ids);
+  if (Id_tree* id = as<Id_tree>(t)) {
+    ids.push_back(id->value()->text());
+    return true;
+  }
+  return false;
+}
+
+// Returns the path of the file module that is loaded by importing
+// the module name t, or an empty path if no file module would be
+// loaded. This follows the search rules of find_module and nested
+// directory modules, but it does not load anything.
+Path
+find_import_file(Tree* t) {
+  std::vector<String> ids;
+  if (not get_module_ids(t, ids))
+    return Path();
+
+  // Search locally, then in the module path.
+  Path_list dirs {fs::current_path()};
+  const Path_list& search = config().module_path;
+  dirs.insert(dirs.end(), search.begin(), search.end());
+  Path dir;
+  for (const Path& d : dirs) {
+    if (fs::exists(d / steve_dir_name(ids[0]))) {
+      dir = d / steve_dir_name(ids[0]);
+      break;
+    }
+    if (fs::exists(d / steve_file_name(ids[0])))
+      return d / steve_file_name(ids[0]);
+  }
+  if (dir.empty())
+    return Path();
+
+  // Search for nested modules.
+  for (std::size_t i = 1; i < ids.size(); ++i) {
+    if (fs::exists(dir / steve_dir_name(ids[i])))
+      dir /= steve_dir_name(ids[i]);
+    else if (fs::exists(dir / steve_file_name(ids[i])))
+      return dir / steve_file_name(ids[i]);
+    else
+      break;
+  }
+  return Path();
+}
+
+void schedule_imports(Tree*);
+
+// Run the parse of a scheduled module, unless it has been taken.
+// Errors are diagnosed when the module is loaded.
+void
+run_parse(Parse_job_ptr job) {
+  Scheduler& s = scheduler();
+  {
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (job->state != parse_queued)
+      return;
+    job->state = parse_running;
+  }
+
+  Parse_ptr p;
+  try {
+    p = parse_file(get_file(job->path));
+    if (p->tree)
+      schedule_imports(p->tree);
+  } catch (std::exception&) {
+    p.reset();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(s.mutex);
+    job->result = std::move(p);
+    job->state = parse_done;
+  }
+  s.finished.notify_all();
+}
+
+// Schedule the parse of the file module at path p, unless it has
+// already been scheduled.
+void
+schedule_parse(const Path& p) {
+  Scheduler& s = scheduler();
+  Parse_job_ptr job;
+  {
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (s.cancel or s.jobs.count(p))
+      return;
+    job = std::make_shared<Parse_job>(p);
+    s.jobs.emplace(p, job);
+    if (not s.pool)
+      s.pool.reset(new Task_pool(config().jobs - 1));
+  }
+  s.pool->submit([job]() { run_parse(job); });
+}
+
+inline bool use_images();
+
+// Schedule the parse of each file module imported by the module
+// whose parse tree is t. Modules that have images are not parsed.
+void
+schedule_imports(Tree* t) {
+  if (not use_scheduler())
+    return;
+  Top_tree* top = as<Top_tree>(t);
+  if (not top)
+    return;
+  for (Tree* d : *top->first) {
+    if (Import_tree* imp = as<Import_tree>(d)) {
+      Path p = find_import_file(imp->module());
+      if (p.empty())
+        continue;
+      if (use_images() and fs::exists(image_path(p)))
+        continue;
+      schedule_parse(p);
+    }
+  }
+}
+
+// Returns the parse of the file f at path p. If that parse has been
+// scheduled, wait for it to finish, unless it has not started.
+// Otherwise, parse the file now.
+Parse_ptr
+take_parse(const Path& p, File* f) {
+  Scheduler& s = scheduler();
+  Parse_ptr result;
+  {
+    std::unique_lock<std::mutex> lock(s.mutex);
+    auto iter = s.jobs.find(p);
+    if (iter != s.jobs.end()) {
+      Parse_job& job = *iter->second;
+      s.finished.wait(lock, [&job]() { return job.state != parse_running; });
+      if (job.state == parse_done)
+        result = std::move(job.result);
+      job.state = parse_taken;
+    }
+  }
+  if (result and result->file == f)
+    return result;
+  return parse_file(f);
+}
+
+// Discard the scheduled parses. This waits for running parses to
+// finish, and prevents new ones from being scheduled meanwhile.
+void
+discard_parses() {
+  Scheduler& s = scheduler();
+  std::unique_lock<std::mutex> lock(s.mutex);
+  if (s.jobs.empty())
+    return;
+  s.cancel = true;
+  for (auto& x : s.jobs)
+    if (x.second->state == parse_queued)
+      x.second->state = parse_taken;
+  s.finished.wait(lock, [&s]() {
+    for (auto& x : s.jobs)
+      if (x.second->state == parse_running)
+        return false;
+    return true;
+  });
+  s.jobs.clear();
+  s.cancel = false;
+}
+
+// The number of modules being loaded by the loading thread.
+int loading_ = 0;
+
+// An RAII helper that tracks the loading of modules. When the
+// outermost module has been loaded, unneeded parses are discarded.
+struct Loading_guard {
+  Loading_guard() { ++loading_; }
+  ~Loading_guard() {
+    if (--loading_ == 0)
+      discard_parses();
+  }
+};
+
+
 // -------------------------------------------------------------------------- //
 // Module loading
 
-// Parse the module in the given file, returning its sequence of
-// declarations.
+// Parse and elaborate the module m in the file f, returning its
+// sequence of declarations. The modules that it imports are parsed in
+// the background while it is elaborated. The dependencies of the
+// module are recorded so that it can be rebuilt.
 //
 // FIXME: We should be recurs
 Decl_seq*
-parse_module(const Location& loc, File* f) {
+parse_module(const Location& loc, Module* m, File* f) {
   // Save off the current diagnostics so we don't overwrite them
   // with the lexer, parser, and elaborator.
   Diagnostics_guard guard;
+  Loading_guard lg;
 
-  // Get the text.
-  Expected<std::string> text = f->text();
-  if (not text) {
-    error(loc) << text.error().message();
-    return nullptr;
-  }
-
-  // Lex the module.
-  Lexer lex;
-  Tokens toks = lex(f);
-  if (not lex.diags.empty()) {
-    std::cerr << lex.diags;
-    return nullptr;
-  }
-
-  // Parse the module.
-  Parser parse;
-  Tree* pt = parse(toks);
-  if (not parse.diags.empty()) {
-    std::cerr << parse.diags;
+  // Lex and parse the module.
+  Parse_ptr pt = take_parse(m->path(), f);
+  if (not pt->tree) {
+    std::cerr << pt->diags;
     return nullptr;
   }
+  schedule_imports(pt->tree);
 
   // Elaborate the contents.
+  Dep_tracker deps(decl_sources(pt->toks, pt->tree));
+  Tracker_guard tg(&deps);
   Elaborator elab;
-  Expr* ast = elab(pt);
+  Expr* ast = elab(pt->tree);
   if (not elab.diags.empty()) {
     std::cerr << elab.diags;
     return nullptr;
   }
+  deps_[m] = std::move(deps.deps);
   return as<Top>(ast)->decls();
 }
 
-// Load the file module.
+// -------------------------------------------------------------------------- //
+// Module images
+//
+// When a module cache is configured, each file module is saved as an
+// image after it is elaborated. A later import of the same module opens
+// its image instead, loading the modules on which it depends, and the
+// declarations are read from the image when they are first needed.
+
+// Returns true if modules are saved to and loaded from images. Images
+// do not save comments, so they are not used when comments are needed.
+inline bool
+use_images() {
+  return not config().module_cache.empty() and not config().capture_comments;
+}
+
+// An image whose declarations have not yet been read.
+struct Pending_image {
+  Image* image;
+  File* file;
+  std::vector<Module*> deps;
+};
+
+std::unordered_map<const Module*, Pending_image> pending_;
+
+Module* try_load_dir(const Location&, const Path&, Name*);
+Module* try_load_file(const Location&, const Path&, Name*);
+
+// Load a module on which an image depends. A module nested in a
+// directory module is loaded through that directory, as if it were
+// imported.
+Module*
+load_image_dep(const Location& loc, const Image_dep& d, const std::vector<Module*>& deps) {
+  if (d.parent >= 0)
+    return load_module(loc, deps[d.parent], d.id);
+  if (d.dir)
+    return try_load_dir(loc, d.path, new Basic_id(d.id));
+  return try_load_file(loc, d.path, new Basic_id(d.id));
+}
+
+// Open the image of the module m, whose source is f. Returns false if
+// there is no image or if it is stale.
+bool
+open_module_image(const Location& loc, Module* m, File* f) {
+  Image* img = open_image(image_path(m->path()), source_hash(m));
+  if (not img)
+    return false;
+
+  // Diagnostics for modules that fail to load are issued when the
+  // module is elaborated from source.
+  Suppression_guard sg;
+  std::vector<Module*> deps;
+  for (const Image_dep& d : image_deps(img)) {
+    Module* dm = load_image_dep(loc, d, deps);
+    if (not dm or dm->path() != d.path or module_key(dm) != d.key) {
+      close_image(img);
+      return false;
+    }
+    deps.push_back(dm);
+  }
+  note_image(m, img);
+  pending_.emplace(m, Pending_image{img, f, std::move(deps)});
+  return true;
+}
+
+// Save the image of the module m, whose source is f. The key of the
+// module is noted first, since images of modules that import m depend
+// on it whether or not m's image can be saved.
+inline void
+save_module_image(Module* m, File* f) {
+  const std::vector<Module*>& imports = deps_[m].imports;
+  note_imports(m, imports);
+  save_image(image_path(m->path()), m, *f, imports);
+}
+
+// Load the file module. The module and its declarations are allocated
+// in an arena owned by the module.
 Module*
 load_file_module(const Location& loc, File* f, const Path& p, Name* n) {
+  Arena_guard ag(make_module_arena(p));
   Module* m = register_module(init_module(p, n));
-  if (Decl_seq* ds = parse_module(loc, f))
-    return finish_module(m, ds);
-  else
+  if (not use_images()) {
+    if (Decl_seq* ds = parse_module(loc, m, f))
+      return finish_module(m, ds);
     return nullptr;
+  }
+
+  note_source(m, hash_source(*f));
+  if (open_module_image(loc, m, f))
+    return m;
+  if (Decl_seq* ds = parse_module(loc, m, f)) {
+    finish_module(m, ds);
+    save_module_image(m, f);
+    return m;
+  }
+  return nullptr;
 }
 
 // Try to load a module from the file with the given name. 
@@ -136,10 +551,15 @@ load_file_module(const Location& loc, File* f, const Path& p, Name* n) {
 // fully qualified form.
 Module*
 load_file_module(const Location& loc, const Path& p, Name* n) {
-  if (Module* m = lookup_module(p))
+  if (Module* m = lookup_module(p)) {
+    note_import(m);
     return m;
+  }
   try {
-    return load_file_module(loc, get_file(p), p, n);
+    Module* m = load_file_module(loc, get_file(p), p, n);
+    if (m)
+      note_import(m);
+    return m;
   } catch (std::system_error& err) {
     error(loc) << format("error loading '{}': {}", p, err.what());
     return nullptr;
@@ -179,14 +599,6 @@ try_load_file(const Location& loc, const Path& p, Name* n) {
   return nullptr;
 }
 
-// Construct a path to a directory from a module-id.
-inline Path
-steve_dir_name(String id) { return id.str(); }
-
-// Construct a path ot a Steve file from a module-id.
-inline Path
-steve_file_name(String id) { return id.str() + ".steve"; }
-
 // Normalize a path name as an id. 
 //
 // TODO: What if the input file has a non-empty directory?
@@ -240,6 +652,224 @@ find_module(const Location& loc, String id, Name* n) {
 
 } // namespace
 
+// Returns the module loaded from the given path, or nullptr if no
+// such module has been loaded.
+Module*
+get_module(const Path& p) { return lookup_module(p); }
+
+namespace {
+
+// Forget every loaded module, so that later imports load them again.
+//
+// The arenas of the modules are released, along with the files they
+// were loaded from. The caches that refer to their nodes are cleared
+// first: the calls and closures of the evaluator, the resolutions of
+// overloads, the canonical types, and the node tables of images.
+void
+forget_modules() {
+  for (auto& x : pending_)
+    close_image(x.second.image);
+  pending_.clear();
+  deps_.clear();
+  modules_.clear();
+
+  clear_call_cache();
+  clear_closures();
+  clear_resolution_caches();
+  forget_images();
+  for (auto& x : arenas_)
+    forget_types(*x.second);
+  arenas_.clear();
+  release_files();
+  rebuilt_ = 0;
+  ++generation_;
+}
+
+// Returns true if rebuilds have allocated more than the modules they
+// replaced are likely to hold, so that the modules should be forgotten.
+bool
+too_much_rebuilt() {
+  if (rebuilt_ < rebuild_limit)
+    return false;
+  std::size_t used = 0;
+  for (auto& x : arenas_)
+    used += x.second->used();
+  return rebuilt_ > used - rebuilt_;
+}
+
+// Append the file module m to order, after the modules it imports.
+void
+order_modules(Module* m, std::unordered_set<Module*>& seen, std::vector<Module*>& order) {
+  if (not seen.insert(m).second)
+    return;
+  for (Module* i : deps_[m].imports)
+    order_modules(i, seen, order);
+  order.push_back(m);
+}
+
+// Returns true if any declaration of the module refers to a declaration
+// whose name has changed.
+bool
+uses_changed(const Module_deps& deps, const Name_set& changed) {
+  for (const Decl_record& r : deps.decls) {
+    for (Decl* d : r.uses)
+      if (changed.count(decl_spelling(d)))
+        return true;
+  }
+  return false;
+}
+
+// Elaborate the module m again, reusing its unchanged declarations.
+// The new declarations are allocated in the module's arena. Returns
+// false if the module cannot be elaborated (e.g., its source has been
+// removed); its diagnostics are discarded.
+bool
+rebuild_module(Module* m, Name_set& changed, std::vector<Decl*>* built) {
+  Diagnostics_guard guard;
+  Parse_ptr pt;
+  try {
+    pt = parse_file(get_file(m->path()));
+  } catch (std::exception&) {
+    return false;
+  }
+  if (not pt->tree)
+    return false;
+
+  Arena& a = *arenas_[m->path()];
+  std::size_t used = a.used();
+  Arena_guard ag(a);
+
+  Module_deps& prev = deps_[m];
+  Dep_tracker deps(decl_sources(pt->toks, pt->tree), &prev, &changed);
+  Tracker_guard tg(&deps);
+  Elaborator elab;
+  Expr* ast = elab(pt->tree);
+  rebuilt_ += a.used() - used;
+  if (not ast or not elab.diags.empty())
+    return false;
+  m->second = as<Top>(ast)->decls();
+  prev = std::move(deps.deps);
+  if (built)
+    built->insert(built->end(), deps.built.begin(), deps.built.end());
+  return true;
+}
+
+// Rebuild the modules whose sources have changed, and the modules that
+// refer to their changed declarations, in import order. Returns false
+// if any module cannot be rebuilt.
+bool
+rebuild_modules(const std::unordered_set<Module*>& stale, std::vector<Decl*>* built) {
+  std::unordered_set<Module*> seen;
+  std::vector<Module*> order;
+  for (auto& x : modules_) {
+    if (arenas_.count(x.first))
+      order_modules(x.second, seen, order);
+  }
+
+  Name_set changed;
+  for (Module* m : order) {
+    if (stale.count(m) or uses_changed(deps_[m], changed)) {
+      if (not rebuild_module(m, changed, built))
+        return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+// Bring the loaded modules up to date with their sources. Returns
+// true if any module was rebuilt or forgotten. If built is given, the
+// declarations that were elaborated again are appended to it.
+//
+// A file module whose source has changed is rebuilt, as is each module
+// that refers to a declaration of a rebuilt module whose name changed
+// (see Depend.hpp). If a module failed to load, or if any module cannot
+// be rebuilt (e.g., it was loaded from an image and has no recorded
+// dependencies, or its source cannot be read), every module is
+// forgotten instead, and later imports load them again.
+//
+// The modules are also forgotten when rebuilds have allocated more
+// memory than the modules hold, so that the declarations they replaced
+// are released; built is then left unchanged.
+bool
+refresh_modules(std::vector<Decl*>* built) {
+  std::unordered_set<Module*> stale;
+  bool failed = false;
+  bool untracked = false;
+  for (auto& x : modules_) {
+    Module* m = x.second;
+    if (arenas_.count(m->path()) == 0)
+      continue;
+    File* f;
+    try {
+      f = get_file(m->path());
+    } catch (std::exception&) {
+      failed = true;
+      continue;
+    }
+    if (f->changed()) {
+      forget_file(f);
+      stale.insert(m);
+    }
+    if (not m->second and not pending_.count(m))
+      failed = true;
+    else if (not deps_.count(m))
+      untracked = true;
+  }
+  if (stale.empty() and not failed)
+    return false;
+
+  std::size_t n = built ? built->size() : 0;
+  if (failed or untracked or not rebuild_modules(stale, built) or too_much_rebuilt()) {
+    forget_modules();
+    if (built)
+      built->resize(n);
+  }
+  return true;
+}
+
+// Returns the number of times the loaded modules have been forgotten.
+// The nodes of forgotten modules are released, so a node of a module
+// is identified by its address only within a generation.
+std::size_t
+module_generation() { return generation_; }
+
+// Read the declarations of a module loaded from its image. If the
+// image cannot be read, the module is elaborated from source.
+Decl_seq*
+load_decls(const Module* m) {
+  auto iter = pending_.find(m);
+  if (iter == pending_.end())
+    return nullptr;
+  Pending_image img = std::move(iter->second);
+  pending_.erase(iter);
+
+  Module* mod = const_cast<Module*>(m);
+  Arena_guard ag(*arenas_[m->path()]);
+  Decl_seq* ds = read_image(img.image, mod, *img.file, img.deps);
+  close_image(img.image);
+  if (ds)
+    return finish_module(mod, ds)->second;
+  if ((ds = parse_module(no_location, mod, img.file))) {
+    finish_module(mod, ds);
+    save_module_image(mod, img.file);
+  }
+  return ds;
+}
+
+// Returns true if the module parent already imports m. A module
+// nested in a directory is imported into that directory once, no
+// matter how many modules import it.
+bool
+imports_module(Module* parent, Module* m) {
+  for (Decl* d : *parent->decls())
+    if (Import* imp = as<Import>(d))
+      if (imp->module() == m)
+        return true;
+  return false;
+}
+
 // Load a module. The search rules are as follows;
 //
 // - if parent is null, search each directory in the module path
@@ -256,9 +886,11 @@ load_module(Location loc, Module* parent, String id) {
     return find_module(loc, id, n);
   else {
     if (Module* m = load_module(loc, parent->path(), id, n)) {
-      Name* n = new Basic_id(id);
-      Decl* d = new Import(n, m);
-      parent->decls()->push_back(d);
+      if (not imports_module(parent, m)) {
+        Name* n = new Basic_id(id);
+        Decl* d = new Import(n, m);
+        parent->decls()->push_back(d);
+      }
       return m;
     }
   }
@@ -296,14 +928,19 @@ load_file(const Path& input) {
 Expr*
 load_name(const std::string& s) {
   Lexer lex;
-  Tokens toks = lex(nullptr, s.begin(), s.end());
+  Tokens toks = lex(nullptr, s);
   if (not lex.diags.empty()) {
     std::cerr << lex.diags;
     return nullptr;
   }
 
+  Arena trees;
   Parser parse;
-  Tree* id = parse(toks, postfix_parse);
+  Tree* id;
+  {
+    Arena_guard ag(trees);
+    id = parse(toks, postfix_parse);
+  }
   if (not parse.diags.empty()) {
     std::cerr << parse.diags;
     return nullptr;
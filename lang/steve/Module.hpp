@@ -6,11 +6,18 @@
 #include <steve/Location.hpp>
 #include <steve/File.hpp>
 
+#include <vector>
+
 namespace steve {
 
 struct Expr;
+struct Decl;
 struct Module;
 
+Module* get_module(const Path&);
+bool refresh_modules(std::vector<Decl*>* = nullptr);
+std::size_t module_generation();
+
 Module* load_file(const Path&);
 Module* load_module(Module*, String);
 Module* load_module(Location, Module*, String);
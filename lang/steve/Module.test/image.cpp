@@ -0,0 +1,131 @@
+// This program loads a module through the module cache several times,
+// editing the module it imports between runs, and checks that each run
+// prints the same declarations as a run without images. Each run is a
+// separate process, so that modules are read from their images rather
+// than from the modules loaded by earlier runs.
+//
+//    module_image
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <steve/Ast.hpp>
+#include <steve/Config.hpp>
+#include <steve/Debug.hpp>
+#include <steve/Error.hpp>
+#include <steve/Language.hpp>
+#include <steve/Module.hpp>
+
+using namespace steve;
+
+const char* a_steve =
+  "def x : int = 1;\n";
+
+const char* b_steve =
+  "import m.a;\n"
+  "def y : int = m.a.x + 1;\n";
+
+// The module c depends on m.a only through b.
+const char* c_steve =
+  "import b;\n"
+  "def w : int = b.y * 2;\n";
+
+const char* main_steve =
+  "import m.a;\n"
+  "import c;\n"
+  "def z : int = c.w + m.a.x;\n";
+
+void
+write_file(const char* path, const std::string& text) {
+  std::ofstream f(path);
+  f << text;
+}
+
+// Load main.steve in a new process and return its declarations, one
+// per line. If cache is empty, no images are used.
+std::string
+load_main(const std::string& cache) {
+  int fds[2];
+  if (::pipe(fds) < 0)
+    return "error: cannot create a pipe";
+  std::cout.flush();
+  pid_t pid = ::fork();
+  if (pid == 0) {
+    ::close(fds[0]);
+    Configuration cfg;
+    cfg.module_cache = cache;
+    Language lang;
+    Diagnostics diags;
+    Diagnostics_guard dg = diags;
+    std::stringstream ss;
+    if (Module* m = load_file("main.steve")) {
+      for (Decl* d : *m->decls())
+        ss << debug(d) << '\n';
+    }
+    ss << diags;
+    std::string out = ss.str();
+    ssize_t n = ::write(fds[1], out.data(), out.size());
+    ::_exit(n == ssize_t(out.size()) ? 0 : 1);
+  }
+  ::close(fds[1]);
+  std::string out;
+  char buf[256];
+  ssize_t n;
+  while ((n = ::read(fds[0], buf, sizeof buf)) > 0)
+    out.append(buf, n);
+  ::close(fds[0]);
+  int status;
+  if (pid < 0 or ::waitpid(pid, &status, 0) < 0 or status != 0)
+    out += "error: the run failed\n";
+  return out;
+}
+
+// Load main.steve through the cache and check that it prints the same
+// declarations as a run without images.
+bool
+check_run(const char* step, const std::string& cache) {
+  std::string expect = load_main("");
+  std::string out = load_main(cache);
+  std::cout << step << ": " << (out == expect ? "same" : "different") << '\n';
+  if (out != expect) {
+    std::cerr << "error: expected\n" << expect << "got\n" << out;
+    return false;
+  }
+  return true;
+}
+
+int
+main() {
+  char dir[] = "/tmp/steve-image-XXXXXX";
+  if (not ::mkdtemp(dir) or ::chdir(dir) < 0) {
+    std::cerr << "error: cannot create a temporary directory\n";
+    return 1;
+  }
+  ::mkdir("m", 0755);
+  write_file("m/a.steve", a_steve);
+  write_file("b.steve", b_steve);
+  write_file("c.steve", c_steve);
+  write_file("main.steve", main_steve);
+  std::string cache = std::string(dir) + "/cache";
+
+  // The first run saves the images that later runs read.
+  bool ok = check_run("cold", cache);
+  ok &= check_run("warm", cache);
+
+  // Changing an imported module makes the images that depend on it
+  // stale. They are rebuilt by the next run and read by the one after.
+  // The edit changes the size of the file, so it is seen regardless of
+  // the resolution of modification times.
+  write_file("m/a.steve", "def x : int = 10;\n");
+  ok &= check_run("edit m.a", cache);
+  ok &= check_run("warm after edit", cache);
+
+  std::system(("rm -rf " + std::string(dir)).c_str());
+  return ok ? 0 : 1;
+}
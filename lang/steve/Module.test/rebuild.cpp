@@ -0,0 +1,193 @@
+
+// This program loads a module and the module it imports, edits their
+// sources, and checks that refreshing the modules rebuilds exactly the
+// declarations that changed and those that depend on them. Each step
+// reports the declarations that were rebuilt.
+//
+//    module_rebuild
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <unistd.h>
+
+#include <steve/Ast.hpp>
+#include <steve/Config.hpp>
+#include <steve/Debug.hpp>
+#include <steve/Depend.hpp>
+#include <steve/Error.hpp>
+#include <steve/Language.hpp>
+#include <steve/Module.hpp>
+
+using namespace steve;
+
+const char* util_steve =
+  "def x : int = 1;\n"
+  "def y : int = x + 1;\n"
+  "def z : int = 3;\n"
+  "def f(n : int) -> int = { return n + x; }\n";
+
+const char* main_steve =
+  "import util;\n"
+  "def p : int = util.y;\n"
+  "def q : int = util.z;\n"
+  "def r : int = 5;\n"
+  "def s : int = util.f(1);\n";
+
+void
+write_file(const char* path, const std::string& text) {
+  std::ofstream f(path);
+  f << text;
+}
+
+// Replace the first occurrence of from with to in the file at path.
+// The edits in this program change the size of the file, so that the
+// change is seen regardless of the resolution of modification times.
+void
+edit_file(const char* path, const std::string& from, const std::string& to) {
+  std::stringstream ss;
+  ss << std::ifstream(path).rdbuf();
+  std::string text = ss.str();
+  text.replace(text.find(from), from.size(), to);
+  write_file(path, text);
+}
+
+// Refresh the modules and check that the rebuilt declarations are
+// named, in order, by expect.
+bool
+check_rebuild(const char* step, const std::string& expect) {
+  std::vector<Decl*> built;
+  refresh_modules(&built);
+  std::string names;
+  for (Decl* d : built) {
+    if (not names.empty())
+      names += ' ';
+    names += decl_spelling(d).str();
+  }
+  std::cout << step << ": rebuilt " << (names.empty() ? "nothing" : names) << '\n';
+  if (names != expect) {
+    std::cerr << "error: expected " << expect << '\n';
+    return false;
+  }
+  return true;
+}
+
+// Check that the definition named n in the module m is printed as
+// expect.
+bool
+check_def(Module* m, const char* n, const std::string& expect) {
+  for (Decl* d : *m->decls()) {
+    Def* def = as<Def>(d);
+    if (not def or decl_spelling(def).str() != n)
+      continue;
+    std::stringstream ss;
+    ss << debug(def);
+    if (ss.str() == expect)
+      return true;
+    std::cerr << "error: expected " << expect << ", got " << ss.str() << '\n';
+    return false;
+  }
+  std::cerr << "error: no definition of " << n << '\n';
+  return false;
+}
+
+// Check that the name of the declaration n in the module m is located
+// at the given line and column.
+bool
+check_loc(Module* m, const char* n, int line, int col) {
+  for (Decl* d : *m->decls()) {
+    if (decl_spelling(d).str() != n)
+      continue;
+    Source_position p = d->loc.position();
+    if (p.line == line and p.col == col)
+      return true;
+    std::cerr << "error: expected " << n << " at " << line << ':' << col 
+              << ", got " << p.line << ':' << p.col << '\n';
+    return false;
+  }
+  std::cerr << "error: no declaration of " << n << '\n';
+  return false;
+}
+
+int
+main() {
+  char dir[] = "/tmp/steve-rebuild-XXXXXX";
+  if (not ::mkdtemp(dir) or ::chdir(dir) < 0) {
+    std::cerr << "error: cannot create a temporary directory\n";
+    return 1;
+  }
+  write_file("util.steve", util_steve);
+  write_file("main.steve", main_steve);
+
+  Configuration cfg;
+  Language lang;
+  Diagnostics diags;
+  Diagnostics_guard dg = diags;
+
+  Module* m = load_file("main.steve");
+  if (not m) {
+    std::cerr << diags;
+    return 1;
+  }
+
+  bool ok = check_rebuild("unchanged", "");
+
+  // Changing x rebuilds its dependents in both modules.
+  edit_file("util.steve", "x : int = 1", "x : int = 10");
+  ok &= check_rebuild("edit util.x", "x y f p s");
+  ok &= check_def(m, "p", "(def-decl p int 11)");
+  ok &= check_def(m, "s", "(def-decl s int 11)");
+
+  // Modules are rebuilt in import order, whatever their names.
+  edit_file("util.steve", "x : int = 10", "x : int = 100");
+  ok &= check_rebuild("edit util.x again", "x y f p s");
+  ok &= check_def(m, "p", "(def-decl p int 101)");
+
+  // A new declaration that is not used rebuilds only itself.
+  edit_file("util.steve", "def z", "def w : int = 4;\ndef z");
+  ok &= check_rebuild("add util.w", "w");
+  ok &= check_loc(get_module(fs::canonical("util.steve")), "f", 5, 5);
+
+  // Moving a declaration does not rebuild it, but moves its location.
+  edit_file("main.steve", "import util;\n", "\n\nimport util;\n");
+  ok &= check_rebuild("move main", "");
+  ok &= check_loc(m, "p", 4, 5);
+
+  // Indenting a declaration also moves it.
+  edit_file("main.steve", "def q", "  def q");
+  ok &= check_rebuild("indent main.q", "");
+  ok &= check_loc(m, "q", 5, 7);
+
+  // Changing the layout of a declaration rebuilds it.
+  edit_file("main.steve", "q : int", "q :  int");
+  ok &= check_rebuild("space main.q", "q");
+  ok &= check_loc(m, "q", 5, 7);
+
+  // An edit in the importing module rebuilds only that declaration.
+  edit_file("main.steve", "r : int = 5", "r : int = 50");
+  ok &= check_rebuild("edit main.r", "r");
+  ok &= check_def(m, "r", "(def-decl r int 50)");
+
+  // Removing a declaration rebuilds the declarations that used it.
+  edit_file("util.steve", "def z : int = 3;\n", "");
+  edit_file("main.steve", "util.z", "util.w");
+  ok &= check_rebuild("remove util.z", "q");
+  ok &= check_def(m, "q", "(def-decl q int 4)");
+
+  // Removing an imported source forgets every module. The modules are
+  // released, so m is not used after this step.
+  Path main = m->path();
+  ::unlink("util.steve");
+  bool forgotten = refresh_modules() and not get_module(main);
+  std::cout << "remove util: " << (forgotten ? "forgotten" : "kept") << '\n';
+  if (not forgotten) {
+    std::cerr << "error: expected the modules to be forgotten\n";
+    ok = false;
+  }
+
+  ::unlink("main.steve");
+  ::rmdir(dir);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+// This program loads a module that imports many modules, parsing the
+// imported modules with different numbers of threads, and checks that
+// each run prints the same declarations as a run with one thread. Each
+// run is a separate process, so that every module is loaded again.
+//
+//    module_schedule
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <steve/Ast.hpp>
+#include <steve/Config.hpp>
+#include <steve/Debug.hpp>
+#include <steve/Error.hpp>
+#include <steve/Language.hpp>
+#include <steve/Module.hpp>
+
+using namespace steve;
+
+// The number of modules imported by main.steve. The module mi imports
+// the module m(i/2), so that modules are imported both by main.steve
+// and by one another.
+constexpr int nmodules = 24;
+
+void
+write_file(const std::string& path, const std::string& text) {
+  std::ofstream f(path);
+  f << text;
+}
+
+void
+write_modules() {
+  std::stringstream main;
+  std::string total = "0";
+  for (int i = 0; i < nmodules; ++i) {
+    std::string m = "m" + std::to_string(i);
+    std::stringstream ss;
+    if (i == 0)
+      ss << "def v : int = 1;\n";
+    else
+      ss << "import m" << i / 2 << ";\n"
+         << "def v : int = m" << i / 2 << ".v + " << i << ";\n";
+    ss << "def f(n : int) -> int = { return n + v; }\n";
+    write_file(m + ".steve", ss.str());
+    main << "import " << m << ";\n";
+    total += " + " + m + ".f(" + std::to_string(i) + ")";
+  }
+  main << "def total : int = " << total << ";\n";
+  write_file("main.steve", main.str());
+}
+
+// Load main.steve in a new process that parses imported modules with
+// the given number of threads, and return its declarations, one per
+// line.
+std::string
+load_main(unsigned jobs) {
+  int fds[2];
+  if (::pipe(fds) < 0)
+    return "error: cannot create a pipe";
+  std::cout.flush();
+  pid_t pid = ::fork();
+  if (pid == 0) {
+    ::close(fds[0]);
+    Configuration cfg;
+    cfg.jobs = jobs;
+    Language lang;
+    Diagnostics diags;
+    Diagnostics_guard dg = diags;
+    std::stringstream ss;
+    if (Module* m = load_file("main.steve")) {
+      for (Decl* d : *m->decls())
+        ss << debug(d) << '\n';
+    }
+    ss << diags;
+    std::string out = ss.str();
+    ssize_t n = ::write(fds[1], out.data(), out.size());
+    ::_exit(n == ssize_t(out.size()) ? 0 : 1);
+  }
+  ::close(fds[1]);
+  std::string out;
+  char buf[256];
+  ssize_t n;
+  while ((n = ::read(fds[0], buf, sizeof buf)) > 0)
+    out.append(buf, n);
+  ::close(fds[0]);
+  int status;
+  if (pid < 0 or ::waitpid(pid, &status, 0) < 0 or status != 0)
+    out += "error: the run failed\n";
+  return out;
+}
+
+// Load main.steve with the given number of threads and check that it
+// prints the declarations in expect.
+bool
+check_run(unsigned jobs, const std::string& expect) {
+  std::string out = load_main(jobs);
+  std::cout << jobs << " jobs: " << (out == expect ? "same" : "different") << '\n';
+  if (out != expect) {
+    std::cerr << "error: expected\n" << expect << "got\n" << out;
+    return false;
+  }
+  return true;
+}
+
+int
+main() {
+  char dir[] = "/tmp/steve-schedule-XXXXXX";
+  if (not ::mkdtemp(dir) or ::chdir(dir) < 0) {
+    std::cerr << "error: cannot create a temporary directory\n";
+    return 1;
+  }
+  write_modules();
+
+  // The run with one thread parses every module on the main thread.
+  std::string expect = load_main(1);
+  bool ok = expect.find("(def-decl total int") != std::string::npos;
+  if (not ok)
+    std::cerr << "error: main.steve did not load\n" << expect;
+
+  // Threads finish in a different order on each run, so the largest
+  // number of threads is tried several times.
+  for (unsigned jobs : {2, 4, 8, 8, 8})
+    ok &= check_run(jobs, expect);
+
+  std::system(("rm -rf " + std::string(dir)).c_str());
+  return ok ? 0 : 1;
+}
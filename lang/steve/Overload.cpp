@@ -8,10 +8,102 @@
 #include <steve/Error.hpp>
 #include <steve/Debug.hpp>
 
+#include <atomic>
 #include <iostream>
+#include <unordered_map>
 
 namespace steve {
 
+// -------------------------------------------------------------------------- //
+// Resolution cache
+//
+// Whether a candidate is viable, and how its conversions rank, depends
+// only on the types of the arguments. A unique resolution is cached by
+// the types of the arguments, which are compared by address. Builtin
+// types are written as a new node at each use, so they are keyed by
+// the builtin type of the same kind. This is exact for builtin and
+// canonical types; other types may simply miss the cache.
+//
+// A resolution is cached only when every declaration in the overload
+// set was a candidate. A function declaration whose definition has not
+// yet been elaborated is not a candidate, and may become one later.
+// Declaring a new overload clears the cache of its set.
+
+using Type_list = Small_vector<Type*, 3>;
+
+// Returns the type by which t is keyed in the resolution cache.
+Type*
+cache_key(Type* t) {
+  if (not t)
+    return t;
+  switch (t->kind) {
+  case typename_type: return get_typename_type();
+  case unit_type: return get_unit_type();
+  case bool_type: return get_bool_type();
+  case nat_type: return get_nat_type();
+  case int_type: return get_int_type();
+  case char_type: return get_char_type();
+  default: return t;
+  }
+}
+
+struct type_list_hash {
+  std::size_t operator()(const Type_list& ts) const {
+    std::size_t h = ts.size();
+    for (Type* t : ts)
+      h ^= std::hash<Type*>()(t) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    return h;
+  }
+};
+
+struct type_list_eq {
+  bool operator()(const Type_list& a, const Type_list& b) const {
+    return a.size() == b.size() and std::equal(a.begin(), a.end(), b.begin());
+  }
+};
+
+// Maps the argument types of a call to the declaration selected for
+// them.
+struct Resolution_cache
+  : std::unordered_map<Type_list, Decl*, type_list_hash, type_list_eq> 
+{ };
+
+namespace {
+
+std::atomic<std::size_t> hits_(0);
+std::atomic<std::size_t> misses_(0);
+bool cache_resolutions_ = true;
+
+} // namespace
+
+Overload::Overload() = default;
+
+Overload::Overload(std::initializer_list<Decl*> list)
+  : Small_vector<Decl*, 1>(list) { }
+
+Overload::Overload(Overload&&) = default;
+
+Overload::~Overload() = default;
+
+Resolution_cache_stats
+resolution_cache_stats() { return {hits_, misses_}; }
+
+void
+use_resolution_cache(bool b) { cache_resolutions_ = b; }
+
+// Discard the cached resolutions of every overload set in the current
+// scope and its enclosing scopes. The caches of other scopes are
+// discarded with those scopes. This is done when the declarations and
+// types to which the caches refer are released.
+void
+clear_resolution_caches() {
+  for (Scope* s = current_scope(); s; s = s->parent) {
+    for (Scope_entry& e : *s)
+      e.ovl.cache.reset();
+  }
+}
+
+
 // Returns true if t1 and t2 have equivalent parameter type lists.
 bool
 equivalent_parameters(Fn_type* t1, Fn_type* t2) {
@@ -44,7 +136,7 @@ check_overloadable(Decl* d1, Decl* d2) {
 
   // Only functions can be overloaded.
   if (not t1) {
-    error(d1->loc) << format("cannot overload '{}' because "
+    error(d1->loc) << message("cannot overload '{}' because "
                              "it is not a function", 
                              debug(d1));
     return false;
@@ -52,9 +144,9 @@ check_overloadable(Decl* d1, Decl* d2) {
 
   // Redeclaration of a different kind.
   if (not t2) {
-    error(d1->loc) << format("redefining '{}' as a different kind of symbol",
+    error(d1->loc) << message("redefining '{}' as a different kind of symbol",
                              debug(d1));
-    note(d2->loc) << format("  previous definition is '{}'", debug(d2));
+    note(d2->loc) << message("  previous definition is '{}'", debug(d2));
     return false;
   }
 
@@ -65,10 +157,10 @@ check_overloadable(Decl* d1, Decl* d2) {
   // on a deduced parameter.
   if (equivalent_parameters(t1, t2)) {
     if (is_same(t1->result(), t2->result())) {
-      error(d1->loc) << format("redefinition of '{}'", debug(d1));
-      note(d2->loc) << format("  previous definition is '{}'", debug(d2));
+      error(d1->loc) << message("redefinition of '{}'", debug(d1));
+      note(d2->loc) << message("  previous definition is '{}'", debug(d2));
     } else {
-      error(d1->loc) << format("cannot overload '{}' and '{}' because "
+      error(d1->loc) << message("cannot overload '{}' and '{}' because "
                                "they differ only their result types",
                                debug(d1), debug(d2));
     }
@@ -98,6 +190,7 @@ bool
 declare_overload(Overload& ovl, Decl* d) {
   if (check_overloadable(ovl, d)) {
     ovl.push_back(d);
+    ovl.cache.reset();
     return true;
   }
   return false;
@@ -187,7 +280,7 @@ match_arguments(Location loc, Def* fn, Expr_seq* args, Type_seq* parms) {
   //
   // TODO: This is where would would instantiate default arguments.
   if (first1 == last1 and first2 != last2) {
-    error(loc) << format("too few arguments for '{}'", debug(fn->name()));
+    error(loc) << message("too few arguments for '{}'", debug(fn->name()));
     return nullptr;
   }
 
@@ -196,7 +289,7 @@ match_arguments(Location loc, Def* fn, Expr_seq* args, Type_seq* parms) {
   // TODO: Unless the last argument is variadic, then all remaining
   // arguments would be placed into an argument pack.
   if (first2 == last2 and first1 != last1) {
-    error(loc) << format("too many arguments for '{}'", debug(fn->name()));
+    error(loc) << message("too many arguments for '{}'", debug(fn->name()));
     return nullptr;
   }
 
@@ -206,12 +299,11 @@ match_arguments(Location loc, Def* fn, Expr_seq* args, Type_seq* parms) {
 // A funtion F is viable if and only if the sequence of arguments
 // matches the types of its parameters.
 //
-// Note that diagnostics are suppressed (but saved) during overload 
-// resolution. Each candidate saves any diagnostics that were
-// generated during its analysis.
+// Note that diagnostics are suppressed during overload resolution.
+// They are neither saved nor formatted.
 Candidate
 viable_candidate(Location loc, Candidate& c, Expr_seq* args) {
-  Diagnostics_guard guard(c.diags);
+  Suppression_guard guard;
 
   Fn_type* ft = as<Fn_type>(type(c.fn));
   steve_assert(ft, "candidate with non-function type");
@@ -320,16 +412,36 @@ best_candidates(Candidate_list& viable) {
 // resplice viable and non-viable candidates.
 Resolution
 resolve_call(Location loc, Overload& ovl, Expr_seq* args) {
+  Type_list types;
+  for (Expr* a : *args)
+    types.push_back(cache_key(type(a)));
+  if (cache_resolutions_ and ovl.cache) {
+    auto iter = ovl.cache->find(types);
+    if (iter != ovl.cache->end()) {
+      ++hits_;
+      return {iter->second};
+    }
+  }
+  ++misses_;
+
   Candidate_list cands = gather_candidates(loc, ovl, args);
+  bool complete = cands.size() == ovl.size();
   Candidate_list viable = viable_candidates(loc, cands, args);
   Candidate_list best = best_candidates(viable);
 
   if (best.empty())
     return {};
-  if (best.size() == 1)
-    return {best.front().def};
-  else
+  if (best.size() == 1) {
+    Candidate& c = best.front();
+    if (cache_resolutions_ and complete) {
+      if (not ovl.cache)
+        ovl.cache.reset(new Resolution_cache());
+      ovl.cache->emplace(std::move(types), c.def);
+    }
+    return {c.def};
+  } else {
     return {std::move(best)};
+  }
 }
 
 Resolution
@@ -27,7 +27,6 @@ struct Candidate {
   Term*           fn;     // The candidate function
   Expr_seq*       args;   // The call arguments (possibly converted)
   Conversion_list convs;  // Conversions required to call the function
-  Diagnostics     diags;  // Diagnostics resulting from the check
   bool            viable; // True if viable.
 };
 
@@ -71,6 +70,20 @@ struct Resolution {
   const Candidate_list& solutions() const;
 };
 
+// Statistics about the resolution cache. A call is resolved from the
+// cache when it has the same argument types as a previous call that
+// was resolved against the same overload set.
+struct Resolution_cache_stats {
+  std::size_t hits;   // Calls resolved from the cache
+  std::size_t misses; // Calls resolved by comparing candidates
+};
+
+Resolution_cache_stats resolution_cache_stats();
+void clear_resolution_caches();
+
+// Enable or disable the resolution cache. It is enabled by default.
+void use_resolution_cache(bool);
+
 bool declare_overload(Overload&, Decl*);
 Resolution resolve_call(Location, Overload&, Expr_seq*);
 Resolution resolve_unary(Location, Overload&, Expr*);
@@ -8,7 +8,7 @@ namespace steve {
 // function, and sequence of arguments.
 inline
 Candidate::Candidate(Def* d, Term* f, Expr_seq* a)
-  : def(d), fn(f), args(a), diags(), viable(false) { }
+  : def(d), fn(f), args(a), viable(false) { }
 
 // Contextually converts to true if the candidate is viable.
 inline
@@ -0,0 +1,71 @@
+
+// This program measures the time needed to elaborate a module that
+// makes heavy use of overloaded operators. Each operator is resolved
+// against every builtin overload of its name, and most candidates are
+// rejected with a (suppressed) diagnostic. The resolution cache is
+// disabled so that every call is resolved by checking candidates.
+//
+//    overload_elab [<functions>] [<iterations>]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+#include <steve/Elaborator.hpp>
+#include <steve/Error.hpp>
+#include <steve/Language.hpp>
+#include <steve/Lexer.hpp>
+#include <steve/Overload.hpp>
+#include <steve/Parser.hpp>
+
+using namespace steve;
+
+using Clock = std::chrono::steady_clock;
+
+// Generate a module of n functions.
+std::string
+make_module(int n) {
+  std::stringstream ss;
+  for (int i = 0; i < n; ++i) {
+    ss << "def f" << i << "(x : int, y : bool) -> bool = { "
+       << "return y == (x + " << i << " == x * 2 - " << i << "); }\n";
+  }
+  return ss.str();
+}
+
+int
+main(int argc, char* argv[]) {
+  int n = argc > 1 ? std::atoi(argv[1]) : 200;
+  int iters = argc > 2 ? std::atoi(argv[2]) : 20;
+  Language lang;
+  Diagnostics diags;
+  Diagnostics_guard dg = diags;
+  use_resolution_cache(false);
+
+  std::string text = make_module(n);
+  Lexer lex;
+  Tokens toks = lex(nullptr, text);
+  Parser parse;
+  Tree* tree = parse(toks);
+  if (not lex.diags.empty() or not parse.diags.empty()) {
+    std::cerr << lex.diags << parse.diags;
+    return 1;
+  }
+
+  Clock::time_point start = Clock::now();
+  for (int i = 0; i < iters; ++i) {
+    Elaborator elab;
+    if (not elab(tree) or not elab.diags.empty()) {
+      std::cerr << elab.diags;
+      return 1;
+    }
+  }
+  Clock::duration time = Clock::now() - start;
+
+  using Msec = std::chrono::duration<double, std::milli>;
+  std::cout << n << " functions, " << 5 * n << " operators\n"
+            << std::chrono::duration_cast<Msec>(time).count() / iters 
+            << " ms/elaboration\n";
+  return 0;
+}
@@ -5,6 +5,7 @@
 #include <stdexcept>
 
 #include <steve/Parser.hpp>
+#include <steve/File.hpp>
 #include <steve/Syntax.hpp>
 
 namespace steve {
@@ -43,7 +44,7 @@ lookahead(const Parser& p, std::size_t n) {
 inline bool
 next_token_is(const Parser& p, Token_kind t) {
   if (const Token* k = peek(p))
-    return k->kind == t;
+    return k->kind() == t;
   else
     return false;
 }
@@ -61,7 +62,7 @@ next_token_is_in(const Parser& p, std::initializer_list<Token_kind> ks) {
   if (not k)
     return false;
   for (Token_kind tk : ks)
-    if (k->kind == tk)
+    if (k->kind() == tk)
       return true;
   return false;
 }
@@ -72,14 +73,14 @@ last_token_was(const Parser& p, Token_kind t) {
   if (p.current == p.first)
     return false;
   Token_iterator iter = std::prev(p.current);
-  return iter->kind == t;
+  return iter->kind() == t;
 }
 
 // Returns true if the nth token has type t.
 inline bool
 nth_token_is(const Parser& p, std::size_t n, Token_kind t) { 
   if (const Token* tok = lookahead(p, n))
-    return tok->kind == t;
+    return tok->kind() == t;
   else
     return false;
 }
@@ -88,10 +89,10 @@ nth_token_is(const Parser& p, std::size_t n, Token_kind t) {
 Location
 location(const Parser& p) { 
   if (const Token* k = peek(p)) {
-    return k->loc;
+    return k->loc();
   } else {
     if (p.first != p.last)
-      return {eof_location, p.first->loc.file};
+      return {eof_location, find_file(p.first->offset())};
     else
       return no_location;
   }
@@ -192,7 +193,7 @@ expect(Parser& p, Token_kind k) {
   if (end_of_stream(p))
     ds << "end of file";
   else
-    ds << '\'' << iter->text << '\'';
+    ds << '\'' << iter->text() << '\'';
 
   return nullptr;
 }
@@ -309,54 +310,83 @@ template<typename Sub, typename Op>
 
 // -------------------------------------------------------------------------- //
 // Tentative parsing
-
-// Begin a tentative parse. This initialize tp with the current
-// state of op (but with an empty set of diagnostics).
-inline void
-begin_tentative_parse(Parser& op, Parser& tp) {
-  tp.first = op.first;
-  tp.last = op.last;
-  tp.current = op.current;
-  use_diagnostics(tp.diags);
-}
-
-// Commit to a tentative parse. This updates the parser p with
-// the state of tp and restores the diagnostics to the original
-// parser. Note that any diagnostics accrued during the tentative
-// parse are merged into the diagnostics of the original parser.
+//
+// A tentative parse emits its diagnostics directly into those of the
+// parser. If the parse fails, the parser's position and diagnostics are
+// restored.
+
+// The state of the parser at the beginning of a tentative parse.
+struct Tentative_state {
+  Token_iterator current;
+  std::size_t diags;
+};
+
+// The failure of a tentative parse that made the most progress among
+// a set of alternatives. If every alternative fails, its diagnostics
+// are the most helpful to report.
+struct Tentative_failure {
+  std::size_t end = 0; // The index of the token where the parse failed
+  Diagnostics diags;   // The diagnostics of the failed parse
+};
+
+// Begin a tentative parse, returning the state to restore if the
+// parse fails.
+inline Tentative_state
+begin_tentative_parse(Parser& p) {
+  ++p.stats.tentative;
+  return {p.current, p.diags.size()};
+}
+
+// Abort the tentative parse, restoring the state in s. Diagnostics
+// accrued during the parse are discarded.
 inline void
-commit_tentative_parse(Parser& op, Parser& tp) {
-  op.current = tp.current;
-  op.diags.insert(op.diags.end(), tp.diags.begin(), tp.diags.end());
-  use_diagnostics(op.diags);
+abort_tentative_parse(Parser& p, const Tentative_state& s) { 
+  ++p.stats.aborted;
+  p.stats.rescanned += p.current - s.current;
+  p.current = s.current;
+  p.diags.resize(s.diags);
 }
 
-// Abort the tentative parse. Reset the diagnostics to those
-// of the original parser.
-inline void
-abort_tentative_parse(Parser& op, Parser& tp) { 
-  use_diagnostics(op.diags);
-}
+// Record a failed parse ending at end in f, if it made more progress
+// than the failures already recorded.
+template<typename Iter>
+  inline void
+  note_tentative_failure(Tentative_failure* f, std::size_t end, Iter first, Iter last) {
+    if (f and end > f->end) {
+      f->end = end;
+      f->diags.assign(first, last);
+    }
+  }
 
 // Parse a rule tentatively. If the parse fails (returning nullptr), 
-// the no changes are made to the parser.
+// the no changes are made to the parser, and the failure is recorded
+// in f, if given.
 //
 // It is currently the responsibility of the writer of the
 // tentatively parsed rule to ensure that no changes to the global
 // state are leaked from an aborted tentative parse (i.e., scopes).
 template<typename Rule>
-  inline Parse_result<Rule>
-  parse_tentative(Parser& p, Rule rule) {
-    Parser tp;
-    begin_tentative_parse(p, tp);
-    if (auto* e = rule(tp)) {
-      commit_tentative_parse(p, tp);
-      return e;
+  Parse_result<Rule>
+  parse_tentative(Parser& p, Rule rule, Tentative_failure* f = nullptr) {
+    Tentative_state s = begin_tentative_parse(p);
+    Parse_result<Rule> r = rule(p);
+    if (not r) {
+      std::size_t end = p.current - p.first;
+      note_tentative_failure(f, end, p.diags.begin() + s.diags, p.diags.end());
+      abort_tentative_parse(p, s);
     }
-    abort_tentative_parse(p, tp);
-    return nullptr;
+    return r;
   }
 
+// Report the failure of a set of tentative alternatives by emitting
+// the diagnostics of the one that made the most progress. Parsing
+// resumes where that alternative failed.
+inline void
+report_tentative_failure(Parser& p, const Tentative_failure& f) {
+  p.current = p.first + f.end;
+  p.diags.insert(p.diags.end(), f.diags.begin(), f.diags.end());
+}
+
 
 // -------------------------------------------------------------------------- //
 // Enclosures
@@ -731,7 +761,7 @@ parse_variant_type(Parser& p) {
 bool
 is_assignment_expr(Tree* t) {
   if (Binary_tree* b = as<Binary_tree>(t))
-    return b->op()->kind == equal_tok;
+    return b->op()->kind() == equal_tok;
   return false;
 }
 
@@ -824,7 +854,7 @@ parse_literal_expr(Parser& p) {
   const Token* k = peek(p);
   if (not k)
     return nullptr;
-  switch (k->kind) {
+  switch (k->kind()) {
   // boolean-literal
   case boolean_literal_tok:
   // integer-literal
@@ -1008,164 +1038,198 @@ parse_prefix_expr(Parser& p) {
   return parse_postfix_expr(p);
 }
 
-// Parse a sign expression.
-//
-//    sign-expr ::= prefix-expr | '-' sign-expr
-Tree*
-parse_sign_expr(Parser& p) {
-  auto op = [](Parser& p) { 
-    return accept(p, minus_tok); 
-  };
-  return parse_unary(p, parse_prefix_expr, op, "prefix-expr");
-}
-
-// Parse a multiplicative expression.
-//
-//    multiplicative-expr ::= sign-expr 
-//                          | multiplicative-expr ['*' | '/' | '%'] sign-expr
- Tree* 
-parse_multiplicative_expr(Parser& p) {
-  auto op = [](Parser& p) { 
-    return accept_one(p, {star_tok, slash_tok, percent_tok}); 
-  };
-  return parse_left(p, parse_sign_expr, op, "sign-expression");
-}
-
-// Parse an additive expression.
-//
-//    additive-expr ::= multiplicative-expr 
-//                    | additive-expr ['+' | '-'] multiplicative-expr
-Tree*
-parse_additive_expr(Parser& p) {
-  auto op = [](Parser& p) { 
-    return accept_one(p, {plus_tok, minus_tok}); 
-  };
-  return parse_left(p, parse_multiplicative_expr, op, "multiplicative-expression");
-}
-
-// Parse a shift expression.
-//
-//    shift-expr ::= additive-expr 
-//                 | shift-expr ['<<' | '>>'] additive-expr
-Tree*
-parse_shift_expr(Parser& p) {
-  auto op = [](Parser& p) { 
-    return accept_one(p, {langle_langle_tok, rangle_rangle_tok}); 
-  };
-  return parse_left(p, parse_additive_expr, op, "additive-expression");
-}
-
-// Parse a bitwise not expression.
+// -------------------------------------------------------------------------- //
+// Operator expressions
 //
-//    bitwise-not-expr ::= shift-expr
-//                       | '~' bitwise-not-expr
-Tree*
-parse_bitwise_not_expr(Parser& p) {
-  auto op = [](Parser& p) { 
-    return accept(p, tilde_tok); 
-  };
-  return parse_unary(p, parse_shift_expr, op, "shift-expression");
-}
-
-// Parse a bitwise and expression.
+// Expressions involving unary and binary operators are parsed by
+// precedence climbing rather than by a separate rule for each level
+// of the grammar. The grammar is still this:
 //
+//    logical-if-expr ::= logical-or-expr 
+//                      | logical-or-expr '->' logical-if-expr
+//    logical-or-expr ::= logical-and-expr
+//                      | logical-or-expr 'or' logical-and-expr
+//    logical-and-expr ::= logical-not-expr
+//                       | logical-and-expr 'and' logical-not-expr
+//    logical-not-expr ::= equality-expr
+//                       | 'not' logical-not-expr
+//    equality-expr ::= ordering-expr
+//                    | equality-expr ['==' | '!='] ordering-expr
+//    ordering-expr ::= bitwise-or-expr
+//                    | ordering-expr ['<' | '>' | '<=' | '>='] bitwise-or-expr
+//    bitwise-or-expr ::= bitwise-xor-expr
+//                      | bitwise-or-expr '|' bitwise-xor-expr
+//    bitwise-xor-expr ::= bitwise-and-expr
+//                       | bitwise-xor-expr '^' bitwise-and-expr
 //    bitwise-and-expr ::= bitwise-not-expr
 //                       | bitwise-and-expr '&' bitwise-not-expr
-Tree* 
-parse_bitwise_and_expr(Parser& p) {
-  auto op = [](Parser& p) { 
-    return accept(p, ampersand_tok); 
-  };
-  return parse_left(p, parse_bitwise_not_expr, op, "bitwise-not-expression");
-}
-
-// Parse a bitwise xor expression.
-//
-//    bitwise-xor-expr ::= bitwise-and-expr
-//                       | bitwise-xor-expr '&' bitwise-not-expr
-Tree*
-parse_bitwise_xor_expr(Parser& p) {
-  auto op = [](Parser& p) { 
-    return accept(p, caret_tok); 
-  };
-  return parse_left(p, parse_bitwise_and_expr, op, "bitwise-and-expression");
-}
-
-// Parse a bitwise or expression.
+//    bitwise-not-expr ::= shift-expr
+//                       | '~' bitwise-not-expr
+//    shift-expr ::= additive-expr 
+//                 | shift-expr ['<<' | '>>'] additive-expr
+//    additive-expr ::= multiplicative-expr 
+//                    | additive-expr ['+' | '-'] multiplicative-expr
+//    multiplicative-expr ::= sign-expr 
+//                          | multiplicative-expr ['*' | '/' | '%'] sign-expr
+//    sign-expr ::= prefix-expr | '-' sign-expr
 //
-//    bitwise-or-expr ::= bitwise-xor-expr
-//                      | bitwise-or-expr '&' bitwise-not-expr
-Tree*
-parse_bitwise_or_expr(Parser& p) {
-  auto op = [](Parser& p) { 
-    return accept(p, pipe_tok); 
-  };
-  return parse_left(p, parse_bitwise_xor_expr, op, "bitwise-xor-expression");
+// but an expression is parsed by a single call for each operator
+// instead of a call for each level of the grammar.
+
+// The precedence of an operator, from loosest to tightest binding.
+// Each value also names the level of the grammar at which operators
+// of that precedence are parsed.
+enum Precedence {
+  no_prec,
+  logical_if_prec,     // a -> b
+  logical_or_prec,     // a or b
+  logical_and_prec,    // a and b
+  logical_not_prec,    // not a
+  equality_prec,       // a == b, a != b
+  ordering_prec,       // a < b, a > b, a <= b, a >= b
+  bitwise_or_prec,     // a | b
+  bitwise_xor_prec,    // a ^ b
+  bitwise_and_prec,    // a & b
+  bitwise_not_prec,    // ~a
+  shift_prec,          // a << b, a >> b
+  additive_prec,       // a + b, a - b
+  multiplicative_prec, // a * b, a / b, a % b
+  sign_prec,           // -a
+  prefix_prec,         // A prefix-expr
+};
+
+// The names of the grammar productions at each precedence. These
+// are used in diagnostics.
+const char* prec_names_[] {
+  nullptr,
+  "logical-if-expression",
+  "logical-or-expression",
+  "logical-and-expression",
+  "logical-not-expression",
+  "equality-expression",
+  "ordering-expression",
+  "bitwise-or-expression",
+  "bitwise-xor-expression",
+  "bitwise-and-expression",
+  "bitwise-not-expression",
+  "shift-expression",
+  "additive-expression",
+  "multiplicative-expression",
+  "sign-expression",
+  "prefix-expr",
+};
+
+// Returns the name of the production expected as the operand of an
+// operator with precedence n.
+inline const char*
+operand_name(Precedence n) { return prec_names_[n + 1]; }
+
+// Returns the precedence of k as a binary operator, or no_prec if k
+// is not a binary operator.
+inline Precedence
+binary_precedence(Token_kind k) {
+  switch (k) {
+  case arrow_tok: return logical_if_prec;
+  case or_tok: return logical_or_prec;
+  case and_tok: return logical_and_prec;
+  case equal_equal_tok:
+  case bang_equal_tok: return equality_prec;
+  case langle_tok:
+  case rangle_tok:
+  case langle_equal_tok:
+  case rangle_equal_tok: return ordering_prec;
+  case pipe_tok: return bitwise_or_prec;
+  case caret_tok: return bitwise_xor_prec;
+  case ampersand_tok: return bitwise_and_prec;
+  case langle_langle_tok:
+  case rangle_rangle_tok: return shift_prec;
+  case plus_tok:
+  case minus_tok: return additive_prec;
+  case star_tok:
+  case slash_tok:
+  case percent_tok: return multiplicative_prec;
+  default: return no_prec;
+  }
 }
 
-// Parse an ordering expression.
-//
-//    ordering-expr ::= bitwise-or-expr
-//                    | ordering-expr ['<' | '>' | '<=' | '>='] bitwise-or-expr
-Tree*
-parse_ordering_expr(Parser& p) {
-  auto op = [](Parser& p) { 
-    return accept_one(p, {langle_tok, rangle_tok, langle_equal_tok, rangle_equal_tok});
-  };
-  return parse_left(p, parse_bitwise_or_expr, op, "bitwise-or-expression");
+// Returns the precedence of k as a unary operator, or no_prec if k
+// is not a unary operator.
+inline Precedence
+unary_precedence(Token_kind k) {
+  switch (k) {
+  case not_tok: return logical_not_prec;
+  case tilde_tok: return bitwise_not_prec;
+  case minus_tok: return sign_prec;
+  default: return no_prec;
+  }
 }
 
-// Parse an equality expresssion.
-//
-//    equality-expr ::= ordering-expr
-//                    | equality-expr ['==' | '!='] ordering-expr
-Tree*
-parse_equality_expr(Parser& p) {
-  auto op = [](Parser& p) -> const Token* {
-    return accept_one(p, {equal_equal_tok, bang_equal_tok});
-  };
-  return parse_left(p, parse_ordering_expr, op, "ordering-expression");
-}
+// Returns true if binary operators with precedence n are
+// right-associative.
+inline bool
+is_right_associative(Precedence n) { return n == logical_if_prec; }
 
-// Parse a logical not expression.
-//
-//    logical-not ::= equality-expr
-//                  | 'not' logical-not-expr
-Tree*
-parse_logical_not_expr(Parser& p) {
-  auto op = [](Parser& p) { return accept(p, not_tok); };
-  return parse_unary(p, parse_equality_expr, op, "equality-expression");
+// Returns the precedence of the next token as a binary operator.
+inline Precedence
+next_binary_precedence(const Parser& p) {
+  if (const Token* k = peek(p))
+    return binary_precedence(k->kind());
+  return no_prec;
 }
 
-// Parse a logical and expression.
-//
-//    logical-and-expr ::= logical-not-expr
-//                       | logical-and-expr 'and' logical-not-expr
-Tree*
-parse_logical_and_expr(Parser& p) {
-  auto op = [](Parser& p) { return accept(p, and_tok); };
-  return parse_left(p, parse_logical_not_expr, op, "logical-not-expression");
-}
+// Returns the precedence of the next token as a unary operator.
+inline Precedence
+next_unary_precedence(const Parser& p) {
+  if (const Token* k = peek(p))
+    return unary_precedence(k->kind());
+  return no_prec;
+}
+
+// Parse an expression whose operators have at least the precedence
+// n. This parses the grammar production named by n.
+//
+// A unary operator is only accepted if its precedence is at least
+// n. Its operand has the precedence of the operator (e.g., not not a). 
+// A binary operator is accepted when its precedence is at least n; its
+// right operand binds more tightly unless the operator is right
+// associative.
+//
+// When the operand of a unary operator is missing, parsing resumes
+// with the next tighter precedence after the diagnostic.
+Tree*
+parse_operator_expr(Parser& p, Precedence n) {
+  Tree* t;
+  Precedence u = next_unary_precedence(p);
+  if (u >= n) {
+    const Token* k = consume(p);
+    auto sub = [u](Parser& p) { return parse_operator_expr(p, u); };
+    if (Tree* e = parse_expected(p, sub, operand_name(u)))
+      t = new Unary_tree(k, e);
+    else
+      t = parse_operator_expr(p, Precedence(u + 1));
+  } else {
+    t = parse_prefix_expr(p);
+  }
+  if (not t)
+    return nullptr;
 
-// Parse a logical or expression.
-//
-//    logical-or-expr ::= logical-and-expr
-//                      | logical-or-expr 'or' logical-and-expr
-Tree*
-parse_logical_or_expr(Parser& p) {
-  auto op = [](Parser& p) { return accept(p, or_tok); };
-  return parse_left(p, parse_logical_and_expr, op, "logical-and-expression");
+  Precedence b;
+  while ((b = next_binary_precedence(p)) >= n) {
+    const Token* k = consume(p);
+    Precedence r = is_right_associative(b) ? b : Precedence(b + 1);
+    auto sub = [r](Parser& p) { return parse_operator_expr(p, r); };
+    if (Tree* e = parse_expected(p, sub, operand_name(b)))
+      t = new Binary_tree(k, t, e);
+    else
+      return nullptr;
+  }
+  return t;
 }
 
-// Parse a logical-if expression. Note that this is a right-associative
-// operator.
-//
-//    logical-if-expr ::= logical-and-expr
-//                      | logical-and-expr '->' logical-if-expr
-Tree*
-parse_logical_if_expr(Parser& p) {
-  auto op = [](Parser& p) { return accept(p, arrow_tok); };
-  return parse_right(p, parse_logical_or_expr, op, "logical-or-expression");
+// Parse a logical-if expression.
+inline Tree*
+parse_logical_if_expr(Parser& p) { 
+  return parse_operator_expr(p, logical_if_prec); 
 }
 
 // Parse an if expression.
@@ -1202,7 +1266,6 @@ parse_expr(Parser& p) { return parse_if_expr(p); }
 //                      | logical-if-expr '=' assignment-expr
 Tree*
 parse_assignment_expr(Parser& p) {
-  std::cout << "EH?" << '\n';
   auto op = [](Parser& p) { return accept(p, equal_tok); };
   return parse_right(p, parse_expr, op, "expression");
 }
@@ -1500,16 +1563,24 @@ parse_function_definition(Parser& p, const Token* k, Tree* n) {
 //
 // Note that all definitions begin with a name. They are differentiated
 // by the the tokens following the name.
+//
+// The alternatives are parsed tentatively. If both fail, the
+// diagnostics of the one that made the most progress are reported.
 Tree*
 parse_def_decl(Parser& p) {
   if (const Token* k = accept(p, def_tok))
     if (Tree* n = parse_expected(p, parse_name, "name")) {
+      auto value = [k, n](Parser& p) { return parse_value_definition(p, k, n); };
+      auto fn = [k, n](Parser& p) { return parse_function_definition(p, k, n); };
 
-      if (Tree* d = parse_value_definition(p, k, n))
+      Tentative_failure f;
+      f.end = p.current - p.first;
+      if (Tree* d = parse_tentative(p, value, &f))
         return d;
-      if (Tree* d = parse_function_definition(p, k, n))
+      if (Tree* d = parse_tentative(p, fn, &f))
         return d;
 
+      report_tentative_failure(p, f);
       error(p) << "expected 'parameter-list' or ':' after 'name'";
       return nullptr;
    }
@@ -24,6 +24,15 @@ enum Parse_kind {
   top_parse,          // Parse a module
 };
 
+// Statistics about backtracking. Tokens consumed by a failed
+// tentative parse are scanned again by the next alternative (they
+// are re-scanned).
+struct Backtrack_stats {
+  std::size_t tentative = 0; // Tentative parses run
+  std::size_t aborted = 0;   // Tentative parses that failed
+  std::size_t rescanned = 0; // Tokens consumed by failed parses
+};
+
 // The parser transforms a token stream into a parse tree. For
 // this language, the parse tree is indistinguishable from the
 // abstract syntax tree.
@@ -35,6 +44,8 @@ struct Parser {
   Token_iterator last;
   Token_iterator current;
   Diagnostics    diags;
+
+  Backtrack_stats stats;
 };
 
 } // namespace steve
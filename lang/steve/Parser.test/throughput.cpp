@@ -0,0 +1,125 @@
+
+// This program measures the throughput of the parser. Each file is
+// split into its top-level declarations, and each declaration is
+// parsed separately so that a syntax error in one declaration does
+// not hide the rest of the file.
+//
+// The program also reports the number of tokens re-scanned due to
+// backtracking.
+//
+//    parser_throughput <dir> [<iterations>]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <steve/Language.hpp>
+#include <steve/Lexer.hpp>
+#include <steve/Parser.hpp>
+
+using namespace steve;
+
+using Clock = std::chrono::steady_clock;
+
+// A range of tokens comprising a top-level declaration.
+struct Segment {
+  Token_iterator first;
+  Token_iterator last;
+};
+
+using Segments = std::vector<Segment>;
+
+// Split the tokens into the sequences terminated by a semicolon that
+// is not enclosed by parens, braces, or brackets.
+void
+split_decls(const Tokens& toks, Segments& segs) {
+  int depth = 0;
+  Token_iterator first = toks.begin();
+  for (Token_iterator i = toks.begin(); i != toks.end(); ++i) {
+    switch (i->kind()) {
+    case lparen_tok: case lbrace_tok: case lbracket_tok:
+      ++depth; 
+      break;
+    case rparen_tok: case rbrace_tok: case rbracket_tok:
+      --depth; 
+      break;
+    case semicolon_tok:
+      if (depth == 0) {
+        segs.push_back({first, i + 1});
+        first = i + 1;
+      }
+      break;
+    }
+  }
+}
+
+// Statistics about a parse.
+struct Parse_stats {
+  std::size_t decls = 0;  // Declarations parsed without errors
+  std::size_t tokens = 0; // Tokens consumed by the parser
+  Backtrack_stats backtrack;
+};
+
+// Parse every declaration.
+Parse_stats
+parse_all(const Segments& segs) {
+  Parse_stats stats;
+  for (const Segment& s : segs) {
+    Parser parse;
+    parse(s.first, s.last);
+    if (parse.diags.empty())
+      ++stats.decls;
+    stats.tokens += parse.current - s.first;
+    stats.backtrack.tentative += parse.stats.tentative;
+    stats.backtrack.aborted += parse.stats.aborted;
+    stats.backtrack.rescanned += parse.stats.rescanned;
+  }
+  return stats;
+}
+
+void
+print_backtracking(const Backtrack_stats& s) {
+  std::cout << s.tentative << " tentative parses, " << s.aborted 
+            << " aborted, " << s.rescanned << " tokens re-scanned\n";
+}
+
+int
+main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::cerr << "usage: parser_throughput <dir> [<iterations>]\n";
+    return 1;
+  }
+  Language lang;
+
+  std::vector<Tokens> toks;
+  for (fs::recursive_directory_iterator i(argv[1]), e; i != e; ++i) {
+    if (i->path().extension() == ".steve") {
+      Lexer lex;
+      toks.push_back(lex(get_file(i->path())));
+    }
+  }
+  int iters = argc > 2 ? std::atoi(argv[2]) : 200;
+
+  Segments segs;
+  std::size_t ntoks = 0;
+  for (const Tokens& ts : toks) {
+    split_decls(ts, segs);
+    ntoks += ts.size();
+  }
+  Parse_stats stats = parse_all(segs);
+  std::cout << toks.size() << " files, " << ntoks << " tokens ("
+            << stats.tokens << " parsed), " << segs.size() 
+            << " declarations (" << stats.decls << " valid), "
+            << iters << " iterations\n";
+  print_backtracking(stats.backtrack);
+
+  auto start = Clock::now();
+  for (int n = 0; n < iters; ++n)
+    parse_all(segs);
+  auto stop = Clock::now();
+  double secs = std::chrono::duration<double>(stop - start).count();
+  std::cout << (stats.tokens * iters) / secs / 1e6 << " Mtokens/s, "
+            << secs / iters * 1e3 << " ms/iteration\n";
+  return 0;
+}
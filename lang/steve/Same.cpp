@@ -54,6 +54,11 @@ template<typename T>
 
 bool
 is_same(Expr* t, Expr* u) {
+  // Identical expressions are the same. This is always the case for
+  // equivalent canonical types.
+  if (t == u)
+    return true;
+
   // If both expressions are null, they are the same. If one is 
   // null and the other is not, they are different.
   if (not t) {
@@ -0,0 +1,291 @@
+
+#include <steve/Scan.hpp>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define STEVE_SCAN_X86 1
+#  include <immintrin.h>
+#endif
+
+namespace steve {
+
+// -------------------------------------------------------------------------- //
+// Character classes
+
+#define S space_char
+#define N newline_char
+#define A alpha_char
+#define D (digit_char | xdigit_char)
+#define X (alpha_char | xdigit_char)
+#define U under_char
+
+// Note that all non-ASCII characters are unclassified.
+const Char_class char_classes_[256] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 0, S, N, 0, 0, 0, 0, 0, // 00-0f
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 10-1f
+  S, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 20-2f
+  D, D, D, D, D, D, D, D, D, D, 0, 0, 0, 0, 0, 0, // 30-3f
+  0, X, X, X, X, X, X, A, A, A, A, A, A, A, A, A, // 40-4f
+  A, A, A, A, A, A, A, A, A, A, A, 0, 0, 0, 0, U, // 50-5f
+  0, X, X, X, X, X, X, A, A, A, A, A, A, A, A, A, // 60-6f
+  A, A, A, A, A, A, A, A, A, A, A, 0, 0, 0, 0, 0, // 70-7f
+};
+
+#undef S
+#undef N
+#undef A
+#undef D
+#undef X
+#undef U
+
+
+namespace {
+
+// -------------------------------------------------------------------------- //
+// Scalar kernels
+
+const char*
+scalar_space(const char* first, const char* last) {
+  while (first != last and is_space(*first))
+    ++first;
+  return first;
+}
+
+const char*
+scalar_id_rest(const char* first, const char* last) {
+  while (first != last and is_id_rest(*first))
+    ++first;
+  return first;
+}
+
+const char*
+scalar_comment(const char* first, const char* last) {
+  while (first != last and *first != '\n')
+    ++first;
+  return first;
+}
+
+const Scan_kernels scalar_kernels {
+  scalar_isa, scalar_space, scalar_id_rest, scalar_comment
+};
+
+
+#if STEVE_SCAN_X86
+
+// -------------------------------------------------------------------------- //
+// SSE2 kernels
+//
+// Each kernel computes a 16-bit mask of the bytes that end the run
+// and stops at the lowest set bit. Trailing bytes that do not fill a
+// vector are scanned by the scalar kernels so that we never read past
+// the end of the input (which may be the end of a mapped file).
+
+#define SSE2 __attribute__((target("sse2")))
+
+// Returns a mask of the bytes in v that are in [ \t].
+SSE2 inline __m128i
+sse2_space_mask(__m128i v) {
+  return _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                      _mm_cmpeq_epi8(v, _mm_set1_epi8('\t')));
+}
+
+// Returns a mask of the bytes in v that are in [a-zA-Z0-9_]. The range
+// checks are done by biasing each range so that its lower bound is
+// -128 and then using a signed comparison. Folding in 0x20 maps upper
+// case letters onto lower case ones.
+SSE2 inline __m128i
+sse2_id_rest_mask(__m128i v) {
+  __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+  __m128i alpha = _mm_cmplt_epi8(_mm_add_epi8(lower, _mm_set1_epi8(128 - 'a')),
+                                 _mm_set1_epi8(-128 + 26));
+  __m128i digit = _mm_cmplt_epi8(_mm_add_epi8(v, _mm_set1_epi8(128 - '0')),
+                                 _mm_set1_epi8(-128 + 10));
+  __m128i under = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+  return _mm_or_si128(_mm_or_si128(alpha, digit), under);
+}
+
+SSE2 const char*
+sse2_space(const char* first, const char* last) {
+  while (last - first >= 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+    unsigned m = _mm_movemask_epi8(sse2_space_mask(v)) ^ 0xffff;
+    if (m)
+      return first + __builtin_ctz(m);
+    first += 16;
+  }
+  return scalar_space(first, last);
+}
+
+SSE2 const char*
+sse2_id_rest(const char* first, const char* last) {
+  while (last - first >= 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+    unsigned m = _mm_movemask_epi8(sse2_id_rest_mask(v)) ^ 0xffff;
+    if (m)
+      return first + __builtin_ctz(m);
+    first += 16;
+  }
+  return scalar_id_rest(first, last);
+}
+
+SSE2 const char*
+sse2_comment(const char* first, const char* last) {
+  const __m128i nl = _mm_set1_epi8('\n');
+  while (last - first >= 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+    unsigned m = _mm_movemask_epi8(_mm_cmpeq_epi8(v, nl));
+    if (m)
+      return first + __builtin_ctz(m);
+    first += 16;
+  }
+  return scalar_comment(first, last);
+}
+
+#undef SSE2
+
+const Scan_kernels sse2_kernels {
+  sse2_isa, sse2_space, sse2_id_rest, sse2_comment
+};
+
+
+// -------------------------------------------------------------------------- //
+// AVX2 kernels
+//
+// These are the same as the SSE2 kernels, but scan 32 bytes at a time.
+// Note that AVX2 has no signed less-than, so the operands of the range
+// checks are swapped.
+
+#define AVX2 __attribute__((target("avx2")))
+
+AVX2 inline __m256i
+avx2_space_mask(__m256i v) {
+  return _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                         _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t')));
+}
+
+AVX2 inline __m256i
+avx2_id_rest_mask(__m256i v) {
+  __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+  __m256i alpha = _mm256_cmpgt_epi8(_mm256_set1_epi8(-128 + 26),
+                    _mm256_add_epi8(lower, _mm256_set1_epi8(128 - 'a')));
+  __m256i digit = _mm256_cmpgt_epi8(_mm256_set1_epi8(-128 + 10),
+                    _mm256_add_epi8(v, _mm256_set1_epi8(128 - '0')));
+  __m256i under = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+  return _mm256_or_si256(_mm256_or_si256(alpha, digit), under);
+}
+
+AVX2 const char*
+avx2_space(const char* first, const char* last) {
+  while (last - first >= 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+    unsigned m = ~unsigned(_mm256_movemask_epi8(avx2_space_mask(v)));
+    if (m)
+      return first + __builtin_ctz(m);
+    first += 32;
+  }
+  return sse2_space(first, last);
+}
+
+AVX2 const char*
+avx2_id_rest(const char* first, const char* last) {
+  while (last - first >= 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+    unsigned m = ~unsigned(_mm256_movemask_epi8(avx2_id_rest_mask(v)));
+    if (m)
+      return first + __builtin_ctz(m);
+    first += 32;
+  }
+  return sse2_id_rest(first, last);
+}
+
+AVX2 const char*
+avx2_comment(const char* first, const char* last) {
+  const __m256i nl = _mm256_set1_epi8('\n');
+  while (last - first >= 32) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+    unsigned m = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, nl));
+    if (m)
+      return first + __builtin_ctz(m);
+    first += 32;
+  }
+  return sse2_comment(first, last);
+}
+
+#undef AVX2
+
+const Scan_kernels avx2_kernels {
+  avx2_isa, avx2_space, avx2_id_rest, avx2_comment
+};
+
+#endif // STEVE_SCAN_X86
+
+// Returns true if the host supports the instruction set.
+bool
+supports(Scan_isa isa) {
+  switch (isa) {
+  case scalar_isa:
+    return true;
+#if STEVE_SCAN_X86
+  case sse2_isa:
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+  case avx2_isa:
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+  default:
+    return false;
+  }
+}
+
+} // namespace
+
+
+// -------------------------------------------------------------------------- //
+// Scanning
+
+// The scalar kernels are used until init_scan() selects better ones.
+const Scan_kernels* scan_ = &scalar_kernels;
+
+const char*
+scan_isa_name(Scan_isa isa) {
+  switch (isa) {
+  case scalar_isa: return "scalar";
+  case sse2_isa: return "sse2";
+  case avx2_isa: return "avx2";
+  }
+  return "<unknown>";
+}
+
+// Returns the most capable instruction set supported by the host.
+Scan_isa
+best_scan_isa() {
+  if (supports(avx2_isa))
+    return avx2_isa;
+  if (supports(sse2_isa))
+    return sse2_isa;
+  return scalar_isa;
+}
+
+// Use the kernels for the given instruction set. Returns false if the
+// host does not support that instruction set.
+bool
+use_scan_isa(Scan_isa isa) {
+  if (not supports(isa))
+    return false;
+  switch (isa) {
+  case scalar_isa: scan_ = &scalar_kernels; break;
+#if STEVE_SCAN_X86
+  case sse2_isa: scan_ = &sse2_kernels; break;
+  case avx2_isa: scan_ = &avx2_kernels; break;
+#endif
+  default: return false;
+  }
+  return true;
+}
+
+void
+init_scan() {
+  use_scan_isa(best_scan_isa());
+}
+
+} // namespace steve
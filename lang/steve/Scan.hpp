@@ -0,0 +1,65 @@
+#ifndef STEVE_SCAN_HPP
+#define STEVE_SCAN_HPP
+
+#include <cstdint>
+
+// The scan module provides the character classification and scanning
+// primitives used by the lexer. Classification is done through a
+// 256-entry table; the scanning of long runs (whitespace, identifier
+// bodies, comment bodies) is done by vectorized kernels that are
+// selected at runtime based on the capabilities of the host.
+
+namespace steve {
+
+// -------------------------------------------------------------------------- //
+// Character classes
+
+// A character class is a set of flags describing the lexical properties
+// of a character. Note that classification is independent of the current
+// locale: only ASCII characters are ever classified.
+using Char_class = std::uint8_t;
+
+constexpr Char_class space_char   = 1 << 0; // [ \t]
+constexpr Char_class newline_char = 1 << 1; // [\n]
+constexpr Char_class alpha_char   = 1 << 2; // [a-zA-Z]
+constexpr Char_class digit_char   = 1 << 3; // [0-9]
+constexpr Char_class under_char   = 1 << 4; // [_]
+constexpr Char_class xdigit_char  = 1 << 5; // [0-9a-fA-F]
+
+constexpr Char_class id_head_char = alpha_char | under_char;
+constexpr Char_class id_rest_char = alpha_char | digit_char | under_char;
+
+Char_class char_class(char);
+
+bool is_space(char);
+bool is_id_head(char);
+bool is_id_rest(char);
+bool is_digit(char);
+bool is_hex_digit(char);
+
+
+// -------------------------------------------------------------------------- //
+// Scanning
+
+// The instruction set used by the scanning kernels.
+enum Scan_isa {
+  scalar_isa, // Portable, table-driven scanning
+  sse2_isa,   // 16 bytes at a time
+  avx2_isa,   // 32 bytes at a time
+};
+
+const char* scan_isa_name(Scan_isa);
+
+Scan_isa best_scan_isa();
+Scan_isa current_scan_isa();
+bool use_scan_isa(Scan_isa);
+
+const char* skip_space(const char*, const char*);
+const char* skip_id_rest(const char*, const char*);
+const char* find_newline(const char*, const char*);
+
+} // namespace steve
+
+#include <steve/Scan.ipp>
+
+#endif
@@ -0,0 +1,68 @@
+
+namespace steve {
+
+// The character class table.
+extern const Char_class char_classes_[256];
+
+// A set of scanning kernels. Each kernel returns the first position
+// in [first, last) that does not belong to the run it scans.
+struct Scan_kernels {
+  Scan_isa isa;
+  const char* (*space)(const char*, const char*);
+  const char* (*id_rest)(const char*, const char*);
+  const char* (*comment)(const char*, const char*);
+};
+
+// The active scanning kernels.
+extern const Scan_kernels* scan_;
+
+// Returns the class of the character c.
+inline Char_class
+char_class(char c) { return char_classes_[static_cast<unsigned char>(c)]; }
+
+// Returns true if c is in [ \t].
+inline bool
+is_space(char c) { return char_class(c) & space_char; }
+
+// Returns true if c is in [a-zA-Z_].
+inline bool
+is_id_head(char c) { return char_class(c) & id_head_char; }
+
+// Returns true if c is in [a-zA-Z0-9_].
+inline bool
+is_id_rest(char c) { return char_class(c) & id_rest_char; }
+
+// Returns true if c is in [0-9].
+inline bool
+is_digit(char c) { return char_class(c) & digit_char; }
+
+// Returns true if c is in [0-9a-fA-F].
+inline bool
+is_hex_digit(char c) { return char_class(c) & xdigit_char; }
+
+// Returns the instruction set used by the active kernels.
+inline Scan_isa
+current_scan_isa() { return scan_->isa; }
+
+// Returns the first position in [first, last) that is not horizontal
+// whitespace.
+inline const char*
+skip_space(const char* first, const char* last) {
+  return scan_->space(first, last);
+}
+
+// Returns the first position in [first, last) that cannot continue
+// an identifier.
+inline const char*
+skip_id_rest(const char* first, const char* last) {
+  return scan_->id_rest(first, last);
+}
+
+// Returns the first newline in [first, last), or last if there is
+// no such character.
+inline const char*
+find_newline(const char* first, const char* last) {
+  return scan_->comment(first, last);
+}
+
+} // namespace steve
@@ -30,35 +30,25 @@ scope_name(const Scope* s) {
 }
 
 // -------------------------------------------------------------------------- //
-// Name comparison
+// Name keys
 //
 // TODO: Generalize this for all expressions.
 
 namespace {
 
-template<typename T>
-  inline bool 
-  literal_less(const T* a, const T* b) { 
-    return a->first < b->first; 
-  }
-
-} // namespace
-
-std::size_t
-Name_less::operator()(const Name* a, const Name* b) const {
-  if (a->kind < b->kind)
-    return true;
-  if (b->kind < a->kind)
-    return false;
-  
-  switch (a->kind) {
-  case basic_id: return literal_less(as<Basic_id>(a), as<Basic_id>(b));
-  case operator_id: return literal_less(as<Operator_id>(a), as<Operator_id>(b));
+// Returns the interned spelling of the name n.
+inline const String_entry*
+name_str(const Name* n) {
+  switch (n->kind) {
+  case basic_id: return as<Basic_id>(n)->first.ptr();
+  case operator_id: return as<Operator_id>(n)->first.ptr();
   default: break;
   }
-  steve_unreachable(format("unhandled node '{}'", node_name(a)));
+  steve_unreachable(format("unhandled node '{}'", node_name(n)));
 }
 
+} // namespace
+
 // -------------------------------------------------------------------------- //
 // Scope
 
@@ -105,12 +95,51 @@ Scope::Scope(Scope_kind k, Scope* p, Expr* c)
   check_scope_and_context(k, c);
 }
 
+// Returns the slot for the name n. This is either the slot holding
+// n or the empty slot where n would be inserted. The table must not
+// be empty.
+Scope_slot*
+Scope::probe(Name* n) {
+  const String_entry* str = name_str(n);
+  std::size_t mask = slots_.size() - 1;
+  std::size_t i = (str->hash + n->kind) & mask;
+  while (true) {
+    Scope_slot& s = slots_[i];
+    if (not s.str or (s.str == str and s.kind == n->kind))
+      return &s;
+    i = (i + 1) & mask;
+  }
+}
+
+// Double the size of the hash table, re-inserting each entry. The
+// size of the table is always a power of two.
+void
+Scope::grow() {
+  std::size_t n = slots_.empty() ? 8 : 2 * slots_.size();
+  slots_.assign(n, Scope_slot {nullptr, 0, 0});
+  for (std::size_t i = 0; i < entries_.size(); ++i) {
+    Name* name = entries_[i].name;
+    *probe(name) = {name_str(name), name->kind, std::uint32_t(i)};
+  }
+}
+
+// Return the overload set of the given name, if it is declared in
+// this scope.
+Overload*
+Scope::find(Name* n) {
+  if (slots_.empty())
+    return nullptr;
+  Scope_slot* s = probe(n);
+  if (not s->str)
+    return nullptr;
+  return &entries_[s->index].ovl;
+}
+
 // Return a declaration corresponding to the given name.
 Overload*
 Scope::lookup(Name* n) {
-  auto iter = find(n);
-  if (iter != end())
-    return &iter->second;
+  if (Overload* ovl = find(n))
+    return ovl;
 
   // TODO: There might be some scope-specific lookup rules here.
   // For example, in class scope, we might search through base
@@ -125,24 +154,31 @@ Scope::lookup(Name* n) {
 // Insert the given declaration into this scope. If this is not the
 // first declaration with the given name, then we need to determine
 // if the definition can be overloaded.
+//
+// The table is kept at most half full.
 Overload*
 Scope::declare(Name* n, Decl* d) {
-  auto result = insert({n, {d}});
-  Overload& ovl = result.first->second;
-  
-  // If this didn't succeed, ovl is non-empty, so we need to
-  // determine if we can add d to that set.
-  if (not result.second) {
+  if (2 * (entries_.size() + 1) > slots_.size())
+    grow();
+  Scope_slot* s = probe(n);
+
+  // If the name is already declared, we need to determine if we
+  // can add d to its overload set.
+  if (s->str) {
+    Overload& ovl = entries_[s->index].ovl;
     if (declare_overload(ovl, d))
       return &ovl;
     else
       return nullptr;
   }
 
+  *s = {name_str(n), n->kind, std::uint32_t(entries_.size())};
+  entries_.push_back({n, {d}});
+
   // Associate this declaration with its enclosing context.
   d->cxt_ = current_context();
 
-  return &ovl;
+  return &entries_.back().ovl;
 }
 
 namespace {
@@ -171,12 +207,12 @@ lookup_single(Name* n) {
   if (Overload* ovl = lookup(n)) {
     if (ovl->singleton())
       return ovl->front();
-    error(n->loc) << format("'{}' refers to multiple entities:", debug(n));
+    error(n->loc) << message("'{}' refers to multiple entities:", debug(n));
     for (Decl* d : *ovl) {
-      note(d->loc) << format("  - {}", debug(d));
+      note(d->loc) << message("  - {}", debug(d));
     }
   } else {
-    error(n->loc) << format("no matching declaration for '{}'", debug(n));
+    error(n->loc) << message("no matching declaration for '{}'", debug(n));
   }
   return nullptr;
 }
@@ -327,8 +363,8 @@ current_function() {
 std::ostream&
 operator<<(std::ostream& os, debug_scope d) {
   Scope* s = d.s;
-  for (auto& x : *s)
-    os << debug(x.first) << " : " << debug(&x.second) << '\n';
+  for (Scope_entry& x : *s)
+    os << debug(x.name) << " : " << debug(&x.ovl) << '\n';
   return os;
 }
 
@@ -2,8 +2,10 @@
 #ifndef STEVE_SCOPE_HPP
 #define STEVE_SCOPE_HPP
 
+#include <cstdint>
+#include <deque>
 #include <iosfwd>
-#include <map>
+#include <memory>
 #include <vector>
 
 #include <steve/Ast.hpp>
@@ -23,17 +25,38 @@ enum Scope_kind {
   block_scope
 };
 
+struct Resolution_cache;
+
 // An overload set is a list of definitions sharing the same name,
-// but having different types and definitions.
-struct Overload : std::vector<Decl*> {
-  using std::vector<Decl*>::vector;
+// but having different types and definitions. Most names declare
+// a single entity, which is stored in place.
+//
+// An overload set owns the cache of calls resolved against it. The
+// cache is created by the first resolution that can be cached.
+struct Overload : Small_vector<Decl*, 1> {
+  Overload();
+  Overload(std::initializer_list<Decl*>);
+  Overload(Overload&&);
+  ~Overload();
 
   bool singleton() const;
+
+  std::unique_ptr<Resolution_cache> cache;
+};
+
+// An entry in a scope associates a name with its overload set.
+struct Scope_entry {
+  Name*    name;
+  Overload ovl;
 };
 
-// A The hash name function generates a hash of a name.
-struct Name_less {
-  std::size_t operator()(const Name*, const Name*) const;
+// A slot in the hash table of a scope. A name is keyed by its kind
+// and its interned spelling, so names are compared without looking
+// at their characters. A slot with no spelling is empty.
+struct Scope_slot {
+  const String_entry* str;   // The spelling of the name
+  Node_kind           kind;  // The kind of name
+  std::uint32_t       index; // The index of the entry
 };
 
 // The Scope class defines a mapping from names to declarations.
@@ -43,17 +66,35 @@ struct Name_less {
 //
 // A scope's context is the declaration (if any) that introduces
 // the scope (e.g., a function, record, variant, etc).
-struct Scope : std::map<Name*, Overload, Name_less> {
+//
+// Names are found using an open-addressing hash table with linear
+// probing. The entries are stored separately, in declaration order,
+// so that growing the table does not move any overload set.
+struct Scope {
 public:
+  using iterator = std::deque<Scope_entry>::iterator;
+
   Scope(Scope_kind, Scope*);
   Scope(Scope_kind, Scope*, Expr*);
 
+  Overload* find(Name*);
   Overload* lookup(Name*);
   Overload* declare(Name*, Decl*);
 
+  std::size_t size() const;
+  iterator begin();
+  iterator end();
+
   Scope_kind kind;
   Scope* parent;
   Expr* context;
+
+private:
+  Scope_slot* probe(Name*);
+  void grow();
+
+  std::deque<Scope_entry> entries_;
+  std::vector<Scope_slot> slots_;
 };
 
 
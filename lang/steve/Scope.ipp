@@ -15,6 +15,16 @@ inline
 Scope::Scope(Scope_kind k, Scope* p)
   : kind(k), parent(p), context(nullptr) { }
 
+// Returns the number of names declared in the scope.
+inline std::size_t
+Scope::size() const { return entries_.size(); }
+
+inline Scope::iterator
+Scope::begin() { return entries_.begin(); }
+
+inline Scope::iterator
+Scope::end() { return entries_.end(); }
+
 // -------------------------------------------------------------------------- //
 // Declarations
 
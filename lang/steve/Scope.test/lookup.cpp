@@ -0,0 +1,62 @@
+
+// This program measures the cost of name lookup. Each identifier in
+// a source file is declared in a module scope, and every occurrence
+// of an identifier is then looked up from a block scope nested within
+// a function scope of that module.
+//
+//    scope_lookup <file> [<iterations>]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <vector>
+
+#include <steve/Language.hpp>
+#include <steve/Lexer.hpp>
+#include <steve/Scope.hpp>
+
+using namespace steve;
+
+using Clock = std::chrono::steady_clock;
+
+int
+main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::cerr << "usage: scope_lookup <file> [<iterations>]\n";
+    return 1;
+  }
+  Language lang;
+
+  int iters = argc > 2 ? std::atoi(argv[2]) : 1000;
+
+  // Collect the identifiers of the file.
+  Lexer lex;
+  Tokens toks = lex(get_file(argv[1]));
+  std::vector<Name*> ids;
+  for (const Token& t : toks)
+    if (t.kind() == identifier_tok)
+      ids.push_back(new Basic_id(t.text()));
+
+  // Declare each distinct identifier in a module scope.
+  Scope_guard mod(module_scope);
+  std::set<String> names;
+  for (Name* n : ids)
+    if (names.insert(as<Basic_id>(n)->value()).second)
+      declare(new Def(n, nullptr, nullptr));
+  Scope_guard fn(function_scope);
+  Scope_guard block(block_scope);
+  std::cout << names.size() << " names, " 
+            << ids.size() << " references, "
+            << iters << " iterations\n";
+
+  std::size_t found = 0;
+  auto start = Clock::now();
+  for (int i = 0; i < iters; ++i)
+    for (Name* n : ids)
+      found += lookup(n) != nullptr;
+  auto stop = Clock::now();
+  double nsecs = std::chrono::duration<double, std::nano>(stop - start).count();
+  std::cout << nsecs / (double(ids.size()) * iters) << " ns/lookup\n";
+  return found == ids.size() * iters ? 0 : 1;
+}
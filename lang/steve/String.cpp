@@ -1,22 +1,194 @@
 
 #include <cctype>
 #include <algorithm>
-#include <unordered_set>
+#include <atomic>
+#include <mutex>
 
 #include <steve/String.hpp>
+#include <steve/Memory.hpp>
 
 namespace steve {
 
 namespace {
 
-// The string table.
-static std::unordered_set<std::string> strings_;
+// Returns the hash of the n characters in s. This is the 64-bit
+// FNV-1a hash.
+inline std::uint64_t
+hash_chars(const char* s, std::size_t n) {
+  std::uint64_t h = 0xcbf29ce484222325ull;
+  for (std::size_t i = 0; i < n; ++i) {
+    h ^= static_cast<unsigned char>(s[i]);
+    h *= 0x100000001b3ull;
+  }
+  return h;
+}
+
+// The string table is a set of shards, each of which is an
+// open-addressed hash table of string entries. The shard of a string
+// is chosen by the high bits of its (mixed) hash; the low bits choose
+// its slot within the shard.
+//
+// Lookups are lock-free: slots are published with release stores and
+// read with acquire loads, and a shard's slot array is replaced (never
+// modified in place) when it grows. Insertions lock the shard. When
+// a lookup misses, it is repeated under the lock before inserting.
+//
+// Entries (and their characters) are allocated in a per-shard arena
+// and are never moved, so a String is the same pointer in every thread.
+class String_table {
+public:
+  static constexpr int shard_bits = 6;
+  static constexpr int shard_count = 1 << shard_bits;
+
+  const String_entry* get(const char*, std::size_t);
+
+private:
+  using Slot = std::atomic<const String_entry*>;
+
+  // A slot array. Note that the array is allocated with its slots.
+  struct Slots {
+    static Slots* make(std::size_t);
+
+    Slot* begin() { return reinterpret_cast<Slot*>(this + 1); }
+
+    std::size_t mask;
+  };
+
+  struct Shard {
+    Shard();
+    ~Shard();
+
+    const String_entry* find(Slots*, const char*, std::size_t, std::size_t);
+    const String_entry* insert(const char*, std::size_t, std::size_t);
+    const String_entry* make(const char*, std::size_t, std::size_t);
+    void rehash();
+
+    std::atomic<Slots*> slots;
+    std::mutex mutex;
+    std::size_t count;
+    Arena arena;
+    std::vector<Slots*> retired; // Replaced slot arrays
+  };
+
+  Shard shards_[shard_count];
+};
+
+// Allocate a slot array with n (a power of 2) empty slots.
+String_table::Slots*
+String_table::Slots::make(std::size_t n) {
+  void* p = ::operator new(sizeof(Slots) + n * sizeof(Slot));
+  Slots* s = new (p) Slots {n - 1};
+  for (std::size_t i = 0; i < n; ++i)
+    new (s->begin() + i) Slot(nullptr);
+  return s;
+}
+
+String_table::Shard::Shard()
+  : slots(Slots::make(64)), count(0), arena(16 * 1024)
+{ }
+
+// Slots are trivially destructible, so slot arrays are simply freed.
+String_table::Shard::~Shard() {
+  ::operator delete(slots.load());
+  for (Slots* s : retired)
+    ::operator delete(s);
+}
+
+// Returns the entry for the n characters in s having hash h, or
+// nullptr if there is no such entry in the slot array.
+inline const String_entry*
+String_table::Shard::find(Slots* ss, const char* s, std::size_t n, 
+                          std::size_t h) {
+  Slot* p = ss->begin();
+  for (std::size_t i = h & ss->mask; ; i = (i + 1) & ss->mask) {
+    const String_entry* e = p[i].load(std::memory_order_acquire);
+    if (not e)
+      return nullptr;
+    if (e->hash == h and e->size == n and std::equal(s, s + n, e->data()))
+      return e;
+  }
+}
+
+// Insert a new entry for the n characters in s having hash h. If
+// another thread inserted the string first, return that entry.
+const String_entry*
+String_table::Shard::insert(const char* s, std::size_t n, std::size_t h) {
+  std::lock_guard<std::mutex> lock(mutex);
+  Slots* ss = slots.load(std::memory_order_relaxed);
+  Slot* p = ss->begin();
+  std::size_t i = h & ss->mask;
+  for (; ; i = (i + 1) & ss->mask) {
+    const String_entry* e = p[i].load(std::memory_order_relaxed);
+    if (not e)
+      break;
+    if (e->hash == h and e->size == n and std::equal(s, s + n, e->data()))
+      return e;
+  }
+  const String_entry* e = make(s, n, h);
+  p[i].store(e, std::memory_order_release);
+  if (++count * 2 > ss->mask)
+    rehash();
+  return e;
+}
+
+// Allocate a new entry for the n characters in s having hash h.
+const String_entry*
+String_table::Shard::make(const char* s, std::size_t n, std::size_t h) {
+  std::size_t size = sizeof(String_entry) + n + 1;
+  void* p = arena.allocate(size, alignof(String_entry));
+  String_entry* e = new (p) String_entry {h, n};
+  char* d = const_cast<char*>(e->data());
+  std::copy(s, s + n, d);
+  d[n] = 0;
+  return e;
+}
+
+// Replace the slot array with one that is twice as large. The old
+// array may still be read by concurrent lookups, so it is retired
+// rather than freed.
+void
+String_table::Shard::rehash() {
+  Slots* old = slots.load(std::memory_order_relaxed);
+  Slots* ss = Slots::make(2 * (old->mask + 1));
+  for (std::size_t j = 0; j <= old->mask; ++j) {
+    const String_entry* e = old->begin()[j].load(std::memory_order_relaxed);
+    if (not e)
+      continue;
+    std::size_t i = e->hash & ss->mask;
+    while (ss->begin()[i].load(std::memory_order_relaxed))
+      i = (i + 1) & ss->mask;
+    ss->begin()[i].store(e, std::memory_order_relaxed);
+  }
+  slots.store(ss, std::memory_order_release);
+  retired.push_back(old);
+}
+
+// Returns the entry for the n characters in s, inserting a new entry
+// if no such string has been interned.
+const String_entry*
+String_table::get(const char* s, std::size_t n) {
+  std::uint64_t h = hash_chars(s, n);
+  Shard& shard = shards_[(h * 0x9e3779b97f4a7c15ull) >> (64 - shard_bits)];
+  Slots* ss = shard.slots.load(std::memory_order_acquire);
+  if (const String_entry* e = shard.find(ss, s, n, h))
+    return e;
+  return shard.insert(s, n, h);
+}
+
+// Returns the string table. This is constructed on first use so that
+// strings can be interned during static initialization.
+String_table&
+strings() {
+  static String_table strings_;
+  return strings_;
+}
 
 } // namesapce
 
-// Returns a pointer to a unique string with the same spelling as str.
-const std::string* 
-String::intern(const std::string& str) { return &*strings_.insert(str).first; }
+// Returns a pointer to a unique string with the same spelling as the
+// n characters in s.
+const String_entry*
+String::intern(const char* s, std::size_t n) { return strings().get(s, n); }
 
 // Convert a string to lowercase.
 String
@@ -33,4 +205,4 @@ to_upper(String s) {
   return r;
 }
 
-} // namespace steve
\ No newline at end of file
+} // namespace steve
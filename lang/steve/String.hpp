@@ -9,21 +9,35 @@
 
 namespace steve {
 
+// An entry in the string table. The characters of the string are
+// stored (null terminated) immediately after the entry, and the hash
+// of those characters is computed once, when the string is interned.
+struct String_entry {
+  const char* data() const;
+
+  std::size_t hash;
+  std::size_t size;
+};
+
 // The String class is a handle to an interned string. Its usage guarantees
 // that each unique occurrence of a string in the text of a program appears
 // only once in the memory of the program.
 //
 // The String class is a regular, but reference semantic type.
+//
+// Note that constructing a String from a character range does not
+// allocate unless the string has not been seen before.
 class String {
 public:
-  using iterator       = std::string::const_iterator;
-  using const_iterator = std::string::const_iterator;
+  using iterator       = const char*;
+  using const_iterator = const char*;
 
   // Constructors
   String();
   String(const std::string& s);
   String(const char* s);
   String(const char* s, std::size_t n);
+  String(const char* first, const char* last);
 
   template<typename I> String(I first, I last);
 
@@ -32,22 +46,20 @@ public:
 
   // Observers
   std::size_t size() const;
-  const std::string* ptr() const;
-  const std::string& str() const;
+  std::size_t hash() const;
+  const String_entry* ptr() const;
+  std::string str() const;
   const char* data() const;
 
   // Iterators
-  iterator begin();
-  iterator end();
-
   const_iterator begin() const;
   const_iterator end() const;
 
 private:
-  static const std::string* intern(const std::string&);
+  static const String_entry* intern(const char*, std::size_t);
 
 private:
-  const std::string* str_;
+  const String_entry* str_;
 };
 
 // Equality comparison
@@ -1,21 +1,31 @@
 
 namespace steve {
 
+// Returns the characters of the string.
+inline const char*
+String_entry::data() const { 
+  return reinterpret_cast<const char*>(this + 1); 
+}
+
 inline 
 String::String() 
   : str_(nullptr) { }
   
 inline
 String::String(const std::string& s)
-  : str_(intern(s)) { }
+  : str_(intern(s.data(), s.size())) { }
 
 inline
 String::String(const char* s)
-  : String(std::string(s)) { }
+  : str_(intern(s, std::strlen(s))) { }
 
 inline
 String::String(const char* s, std::size_t n)
-  : String(std::string(s, n)) { }
+  : str_(intern(s, n)) { }
+
+inline
+String::String(const char* first, const char* last)
+  : str_(intern(first, last - first)) { }
 
 template<typename I>
 inline
@@ -29,32 +39,30 @@ String::operator bool() const { return str_; }
 
 /// Returns the number of characters in the string.
 inline std::size_t 
-String::size() const { return str_->size(); }
+String::size() const { return str_->size; }
 
-/// Returns the underlying string pointer.
-inline const std::string* 
+/// Returns the hash of the string's characters.
+inline std::size_t
+String::hash() const { return str_->hash; }
+
+/// Returns the underlying string table entry.
+inline const String_entry*
 String::ptr() const { return str_; }
 
-/// Returns a reference to the underlying string.
-inline const std::string& 
-String::str() const { return *str_; }
+/// Returns a copy of the underlying string.
+inline std::string
+String::str() const { return std::string(data(), size()); }
 
-/// Returns a pointer to the underlying character data.
+/// Returns a pointer to the underlying (null terminated) character data.
 inline const char* 
-String::data() const { return str().c_str(); }
+String::data() const { return str_->data(); }
 
 // Iterators
-inline String::iterator 
-String::begin() { return str_->begin(); }
-
-inline String::iterator 
-String::end() { return str_->end(); }
-
 inline String::const_iterator
-String::begin() const { return str_->begin(); }
+String::begin() const { return data(); }
 
 inline String::const_iterator 
-String::end() const { return str_->end(); }
+String::end() const { return data() + size(); }
 
 // Equality comparison
 // Returns true when two strings refer to the same object.
@@ -91,7 +99,9 @@ template<typename C>
 // Streaming
 template<typename C, typename T>
   inline std::basic_ostream<C, T>&
-  operator<<(std::basic_ostream<C, T>& os, String s) { return os << s.str(); }
+  operator<<(std::basic_ostream<C, T>& os, String s) { 
+    return os.write(s.data(), s.size()); 
+  }
 
 } // namespace steve
 
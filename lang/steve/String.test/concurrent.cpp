@@ -0,0 +1,100 @@
+
+// This program interns the same set of spellings from many threads,
+// each in a different order, and checks that every thread resolves a
+// spelling to the same string table entry.
+//
+//    string_concurrent [<threads>] [<strings>]
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include <steve/String.hpp>
+
+using namespace steve;
+
+using Spellings = std::vector<std::string>;
+using Entries = std::vector<const String_entry*>;
+
+// Generate n distinct spellings. Many of them share prefixes and
+// lengths, so that they collide in the upper parts of the table.
+Spellings
+make_spellings(std::size_t n) {
+  Spellings ss;
+  for (std::size_t i = 0; i < n; ++i)
+    ss.push_back("id_" + std::to_string(i));
+  return ss;
+}
+
+int
+main(int argc, char* argv[]) {
+  int nthreads = argc > 1 ? std::atoi(argv[1]) : 8;
+  std::size_t nstrings = argc > 2 ? std::atoi(argv[2]) : 50000;
+
+  Spellings ss = make_spellings(nstrings);
+  std::vector<Entries> results(nthreads, Entries(nstrings));
+
+  // Each thread interns every spelling in its own order. The threads
+  // spin until all of them have started to maximize contention.
+  std::atomic<int> ready(0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < nthreads; ++t) {
+    threads.emplace_back([&, t]() {
+      std::vector<std::size_t> order(nstrings);
+      for (std::size_t i = 0; i < nstrings; ++i)
+        order[i] = i;
+      std::shuffle(order.begin(), order.end(), std::mt19937(t));
+
+      ++ready;
+      while (ready < nthreads)
+        ;
+      for (std::size_t i : order) {
+        const std::string& s = ss[i];
+        results[t][i] = String(s.data(), s.size()).ptr();
+      }
+    });
+  }
+  for (std::thread& t : threads)
+    t.join();
+
+  // Check that every thread found the same entry for each spelling,
+  // that each entry has the right spelling, and that entries are
+  // unique.
+  int errors = 0;
+  std::unordered_set<const String_entry*> seen;
+  for (std::size_t i = 0; i < nstrings; ++i) {
+    const String_entry* e = results[0][i];
+    for (int t = 1; t < nthreads; ++t) {
+      if (results[t][i] != e) {
+        std::cerr << "thread " << t << " resolved '" << ss[i] 
+                  << "' to a different entry\n";
+        ++errors;
+      }
+    }
+    if (std::string(e->data(), e->size) != ss[i]) {
+      std::cerr << "wrong spelling for '" << ss[i] << "'\n";
+      ++errors;
+    }
+    if (not seen.insert(e).second) {
+      std::cerr << "duplicate entry for '" << ss[i] << "'\n";
+      ++errors;
+    }
+  }
+
+  // Interning again on this thread must not change anything.
+  for (std::size_t i = 0; i < nstrings; ++i) {
+    if (String(ss[i]).ptr() != results[0][i]) {
+      std::cerr << "'" << ss[i] << "' changed after interning\n";
+      ++errors;
+    }
+  }
+
+  std::cout << nthreads << " threads, " << nstrings << " strings, "
+            << errors << " errors\n";
+  return errors != 0;
+}
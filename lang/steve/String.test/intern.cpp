@@ -0,0 +1,84 @@
+
+// This program measures the throughput of string interning on the
+// spellings of the tokens in a source tree. It compares the string
+// table against an unordered_set of std::strings, which is how strings
+// were previously interned.
+//
+//    string_intern <dir> [<iterations>]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <unordered_set>
+#include <vector>
+
+#include <steve/Language.hpp>
+#include <steve/Lexer.hpp>
+
+using namespace steve;
+
+using Clock = std::chrono::steady_clock;
+
+// The spelling of a token as a range of characters in its file.
+struct Spelling {
+  const char* first;
+  const char* last;
+};
+
+using Spellings = std::vector<Spelling>;
+
+// Collect the spellings of all tokens in the source files under the
+// directory d.
+Spellings
+find_spellings(const Path& d) {
+  Spellings ss;
+  for (fs::recursive_directory_iterator i(d), e; i != e; ++i) {
+    if (i->path().extension() != ".steve")
+      continue;
+    File* f = get_file(i->path());
+    Lexer lex;
+    for (const Token& k : lex(f)) {
+      const char* p = f->begin() + (k.offset() - f->base());
+      ss.push_back({p, p + k.text().size()});
+    }
+  }
+  return ss;
+}
+
+template<typename F>
+  void
+  measure(const char* name, const Spellings& ss, int iters, F fn) {
+    auto start = Clock::now();
+    for (int n = 0; n < iters; ++n)
+      for (const Spelling& s : ss)
+        fn(s);
+    auto stop = Clock::now();
+    double secs = std::chrono::duration<double>(stop - start).count();
+    std::cout << name << ": " 
+              << (ss.size() * iters) / secs / 1e6 << " M strings/s\n";
+  }
+
+int
+main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::cerr << "usage: string_intern <dir> [<iterations>]\n";
+    return 1;
+  }
+  Language lang;
+
+  Spellings ss = find_spellings(argv[1]);
+  int iters = argc > 2 ? std::atoi(argv[2]) : 200;
+  std::cout << ss.size() << " strings, " << iters << " iterations\n";
+
+  std::unordered_set<std::string> set;
+  measure("unordered_set", ss, iters, [&set](const Spelling& s) {
+    set.insert(std::string(s.first, s.last));
+  });
+
+  // Make sure that interning actually agrees with the spelling.
+  measure("String", ss, iters, [](const Spelling& s) {
+    String str(s.first, s.last);
+    if (str.size() != std::size_t(s.last - s.first))
+      std::abort();
+  });
+}
@@ -9,38 +9,74 @@
 
 namespace steve {
 
-template<typename C, typename T>
-  std::basic_ostream<C, T>&
-  operator<<(std::basic_ostream<C, T>& os, const Subst& s) {
-    for (auto&& p : s)
-      os << debug(p.first) << " ~> " << debug(p.second) << '\n';
-    return os;
-  }
-
-
 // -------------------------------------------------------------------------- //
 // Substitution
 
+Subst::Subst()
+  : size_(0), table_() { }
+
 // Initialize the substitution with the mapping of a sequence of
 // arguments to parameters.
-Subst::Subst(Decl_seq* parms, Expr_seq* args) {
+Subst::Subst(Decl_seq* parms, Expr_seq* args)
+  : Subst()
+{
   steve_assert(parms->size() == args->size(), "parameter/argument mismatch");
   auto first1 = parms->begin();
   auto first2 = args->begin();
   while (first1 != parms->end()) {
-    insert({*first1, *first2});
+    insert(*first1, *first2);
     ++first1;
     ++first2;
   }
 }
 
+// Returns the number of mappings in the substitution.
+std::size_t
+Subst::size() const { return size_; }
+
+// Returns the index of the in-place slot holding d, or of the empty
+// slot where d would be stored. Declarations are allocated with
+// at least 16-byte alignment, so the low bits of their address are
+// not hashed.
+std::size_t
+Subst::probe(Decl* d) const {
+  std::size_t i = (reinterpret_cast<std::uintptr_t>(d) >> 4) & (slots - 1);
+  while (table_[i].decl and table_[i].decl != d)
+    i = (i + 1) & (slots - 1);
+  return i;
+}
+
+// Map d to e. If d is already mapped, the substitution is unchanged.
+void
+Subst::insert(Decl* d, Expr* e) {
+  if (size_ < small) {
+    Slot& s = table_[probe(d)];
+    if (not s.decl) {
+      s = {d, e};
+      ++size_;
+    }
+    return;
+  }
+
+  // Move the in-place mappings to the hash table.
+  if (large_.empty()) {
+    for (const Slot& s : table_)
+      if (s.decl)
+        large_.emplace(s.decl, s.expr);
+  }
+  if (large_.emplace(d, e).second)
+    ++size_;
+}
+
+// Returns the expression mapped to d, or null if d is not mapped.
 Expr*
 Subst::get(Decl* d) const {
-  auto iter = find(d);
-  if (iter != end())
+  if (size_ <= small)
+    return table_[probe(d)].expr;
+  auto iter = large_.find(d);
+  if (iter != large_.end())
     return iter->second;
-  else
-    return iter->first;
+  return nullptr;
 }
 
 // -------------------------------------------------------------------------- //
@@ -111,6 +147,38 @@ subst_call(Call* e, const Subst& sub) {
   return make_expr<Call>(e->loc, type(e), fn, args);
 }
 
+// Substitute into a binary term.
+//
+//    [s](a op b) = [s]a op [s]b
+Expr*
+subst_binary(Binary* e, const Subst& sub) {
+  Expr* a = subst(e->left(), sub);
+  Expr* b = subst(e->right(), sub);
+  return make_expr<Binary>(e->loc, type(e), e->fn(), a, b);
+}
+
+// Substitute into a conditional term. Note that the branches are
+// not evaluated by substitution.
+Expr*
+subst_if(If* e, const Subst& sub) {
+  Term* c = as<Term>(subst(e->cond(), sub));
+  Expr* t = subst(e->pass(), sub);
+  Expr* f = subst(e->fail(), sub);
+  return make_expr<If>(e->loc, type(e), c, t, f);
+}
+
+Expr*
+subst_promo(Promo* e, const Subst& sub) {
+  Expr* t = subst(e->expr(), sub);
+  return make_expr<Promo>(e->loc, type(e), t, e->type());
+}
+
+Expr*
+subst_pred(Pred* e, const Subst& sub) {
+  Expr* t = subst(e->expr(), sub);
+  return make_expr<Pred>(e->loc, type(e), t, e->type());
+}
+
 Expr*
 subst_variant(Dep_variant_type* e, const Subst& sub) {
   steve_assert(sub.get(e->arg()), "missing argument for dependent variant type");
@@ -146,6 +214,10 @@ subst(Expr* e, const Subst& sub) {
   case fn_term: return subst_fn(as<Fn>(e), sub);
   case call_term: return subst_call(as<Call>(e), sub);
   case builtin_term: return subst_builtin(as<Builtin>(e), sub);
+  case binary_term: return subst_binary(as<Binary>(e), sub);
+  case if_term: return subst_if(as<If>(e), sub);
+  case promo_term: return subst_promo(as<Promo>(e), sub);
+  case pred_term: return subst_pred(as<Pred>(e), sub);
 
   case typename_type: return e;
   case unit_type: return e;
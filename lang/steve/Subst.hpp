@@ -4,18 +4,40 @@
 
 #include <steve/Ast.hpp>
 
-#include <map>
+#include <unordered_map>
 
 namespace steve {
 
 // A substitution is a mapping between declarations (generally parameters)
 // and an expression with which they are being replaced.
-struct Subst : std::map<Decl*, Expr*> {
-  using std::map<Decl*, Expr*>::map;
-
+//
+// Functions have few parameters, so up to eight mappings are stored in
+// place, in a table with linear probing. A larger substitution moves
+// its mappings to a hash table.
+class Subst {
+public:
+  Subst();
   Subst(Decl_seq*, Expr_seq*);
 
+  void insert(Decl*, Expr*);
   Expr* get(Decl*) const;
+
+  std::size_t size() const;
+
+private:
+  static constexpr std::size_t small = 8;  // Mappings stored in place
+  static constexpr std::size_t slots = 16; // Size of the in-place table
+
+  struct Slot {
+    Decl* decl;
+    Expr* expr;
+  };
+
+  std::size_t probe(Decl*) const;
+
+  std::size_t size_;
+  Slot table_[slots];
+  std::unordered_map<Decl*, Expr*> large_;
 };
 
 Expr* subst(Expr*, const Subst&);
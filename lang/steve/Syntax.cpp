@@ -76,7 +76,7 @@ void debug_print(Printer&, Tree*);
 
 void
 debug_print(Printer& p, const Token* k) {
-  print(p, k->text);
+  print(p, k->text());
 }
 
 struct debug_printer {
@@ -135,13 +135,13 @@ template<typename T>
 
 void
 debug_unary(Printer& p, Unary_tree* t) {
-    sexpr s(p, t->op()->text);
+    sexpr s(p, t->op()->text());
     debug_print(p, t->arg());
 }
 
 void
 debug_binary(Printer& p, Binary_tree* t) {
-    sexpr s(p, t->op()->text);
+    sexpr s(p, t->op()->text());
     debug_print(p, t->left());
     print_space(p);
     debug_print(p, t->right());
@@ -58,7 +58,7 @@ using Tree_seq = Seq<Tree>;
 // An identifier.
 struct Id_tree : Tree, Kind_of<id_tree> {
   Id_tree(const Token* k) 
-    : Tree(Kind, k->loc), first(k) { }
+    : Tree(Kind, k->loc()), first(k) { }
 
   const Token* value() const { return first; }
 
@@ -68,7 +68,7 @@ struct Id_tree : Tree, Kind_of<id_tree> {
 // A literal.
 struct Lit_tree : Tree, Kind_of<lit_tree> {
   Lit_tree(const Token* k)
-    : Tree(Kind, k->loc), first(k) { }
+    : Tree(Kind, k->loc()), first(k) { }
 
   const Token* value() const { return first; }
 
@@ -78,7 +78,7 @@ struct Lit_tree : Tree, Kind_of<lit_tree> {
 // A brace tree is an enclosed sequence of statements.
 struct Brace_tree : Tree, Kind_of<brace_tree> {
   Brace_tree(const Token* k, Tree_seq* s)
-    : Tree(Kind, k->loc), first(s) { }
+    : Tree(Kind, k->loc()), first(s) { }
 
   Tree_seq* stmts() const { return first; }
 
@@ -153,7 +153,7 @@ struct App_tree : Tree, Kind_of<app_tree> {
 // An overloadable unary operator.
 struct Unary_tree : Tree, Kind_of<unary_tree> {
   Unary_tree(const Token* k, Tree* t)
-    : Tree(Kind, k->loc), first(k), second(t) { }
+    : Tree(Kind, k->loc()), first(k), second(t) { }
 
   const Token* op() const { return first; }
   Tree* arg() const { return second; }
@@ -179,7 +179,7 @@ struct Binary_tree : Tree, Kind_of<binary_tree> {
 // An if expression.
 struct If_tree : Tree, Kind_of<if_tree> {
   If_tree(const Token* k, Tree* c, Tree* t, Tree* f)
-    : Tree(Kind, k->loc), first(c), second(t), third(f) { }
+    : Tree(Kind, k->loc()), first(c), second(t), third(f) { }
 
   Tree* cond() const { return first; }
   Tree* pass() const { return second; }
@@ -197,7 +197,7 @@ struct If_tree : Tree, Kind_of<if_tree> {
 // A block tree is an enclosed sequence of statements.
 struct Block_tree : Tree, Kind_of<block_tree> {
   Block_tree(const Token* k, Tree_seq* s)
-    : Tree(Kind, k->loc), first(s) { }
+    : Tree(Kind, k->loc()), first(s) { }
 
   Tree_seq* stmts() const { return first; }
 
@@ -207,7 +207,7 @@ struct Block_tree : Tree, Kind_of<block_tree> {
 // A return statement defines the value of a block statement.
 struct Return_tree : Tree, Kind_of<return_tree> {
   Return_tree(const Token* k, Tree* t)
-    : Tree(Kind, k->loc), first(t) { }
+    : Tree(Kind, k->loc()), first(t) { }
 
   Tree* value() const { return first; }
 
@@ -217,19 +217,19 @@ struct Return_tree : Tree, Kind_of<return_tree> {
 // A break statement.
 struct Break_tree : Tree, Kind_of<break_tree> {
   Break_tree(const Token* k)
-    : Tree(Kind, k->loc) { }
+    : Tree(Kind, k->loc()) { }
 };
 
 // A continue statement.
 struct Cont_tree : Tree, Kind_of<cont_tree> {
   Cont_tree(const Token* k)
-    : Tree(Kind, k->loc) { }
+    : Tree(Kind, k->loc()) { }
 };
 
 // A while expression.
 struct While_tree : Tree, Kind_of<while_tree> {
   While_tree(const Token* k, Tree* c, Tree* b)
-    : Tree(Kind, k->loc), first(c), second(b) { }
+    : Tree(Kind, k->loc()), first(c), second(b) { }
 
   Tree* cond() const { return first; }
   Tree* body() const { return second; }
@@ -241,7 +241,7 @@ struct While_tree : Tree, Kind_of<while_tree> {
 // A switch expression.
 struct Switch_tree : Tree, Kind_of<switch_tree> {
   Switch_tree(const Token* k, Tree* t, Tree* b)
-    : Tree(Kind, k->loc), first(t), second(b) { }
+    : Tree(Kind, k->loc()), first(t), second(b) { }
 
   Tree* term() const { return first; }
   Tree* body() const { return second; }
@@ -253,7 +253,7 @@ struct Switch_tree : Tree, Kind_of<switch_tree> {
 // A case label within a switch.
 struct Case_tree : Tree, Kind_of<case_tree> {
   Case_tree(const Token* k, Tree* t, Tree* b)
-    : Tree(Kind, k->loc), first(t), second(b) { }
+    : Tree(Kind, k->loc()), first(t), second(b) { }
 
   Tree* label() const { return first; }
   Tree* body() const { return second; }
@@ -282,7 +282,7 @@ struct Load_tree : Tree, Kind_of<load_tree> {
 // of fields.
 struct Record_tree : Tree, Kind_of<record_tree> {
   Record_tree(const Token* k, Tree_seq* fs)
-    : Tree(Kind, k->loc), first(fs) { }
+    : Tree(Kind, k->loc()), first(fs) { }
 
   Tree_seq* fields() const { return first; }
 
@@ -293,7 +293,7 @@ struct Record_tree : Tree, Kind_of<record_tree> {
 // (optional) discriminator type and 'c*' is a sequence of alternatives.
 struct Variant_tree : Tree, Kind_of<variant_tree> {
   Variant_tree(const Token* k, Tree* d, Tree_seq* as)
-    : Tree(Kind, k->loc), first(d), second(as) { }
+    : Tree(Kind, k->loc()), first(d), second(as) { }
 
   Tree* arg() const { return first; }
   Tree_seq* alts() const { return second; }
@@ -306,7 +306,7 @@ struct Variant_tree : Tree, Kind_of<variant_tree> {
 // a sequence of values (possibly having names).
 struct Enum_tree : Tree, Kind_of<enum_tree> {
   Enum_tree(const Token* k, Tree* t, Tree_seq* es)
-    : Tree(Kind, k->loc), first(t), second(es) { }
+    : Tree(Kind, k->loc()), first(t), second(es) { }
 
   Tree* base() const { return first; }
   Tree_seq* ctors() const { return second; }
@@ -358,7 +358,7 @@ struct Fn_tree : Tree, Kind_of<fn_tree> {
 // A definition.
 struct Def_tree : Tree, Kind_of<def_tree> {
   Def_tree(const Token* k, Tree* d, Tree* e)
-    : Tree(Kind, k->loc), first(d), second(e) { }
+    : Tree(Kind, k->loc()), first(d), second(e) { }
 
   Tree* decl() const { return first; }
   Tree* init() const  { return second; }
@@ -371,7 +371,7 @@ struct Def_tree : Tree, Kind_of<def_tree> {
 // has a null name and a null constraint.
 struct Field_tree : Tree, Kind_of<field_tree> {
   Field_tree(const Token* k, Tree* n, Tree* t, Tree* c)
-    : Tree(Kind, k->loc), first(n), second(t), third(c) { }
+    : Tree(Kind, k->loc()), first(n), second(t), third(c) { }
 
   Tree* name() const { return first; }
   Tree* type() const { return second; }
@@ -400,7 +400,7 @@ struct Import_tree : Tree, Kind_of<import_tree> {
   Import_tree(const Location& l, Tree* t)
     : Tree(Kind, l), first(t) { }
   Import_tree(const Token* k, Tree* t)
-    : Import_tree(k->loc, t) { }
+    : Import_tree(k->loc(), t) { }
 
   Tree* module() const { return first; }
 
@@ -410,7 +410,7 @@ struct Import_tree : Tree, Kind_of<import_tree> {
 // A declaration of the form `using n`.
 struct Using_tree : Tree, Kind_of<using_tree> {
   Using_tree(const Token* k, Tree* n)
-    : Tree(Kind, k->loc), first(n) { }
+    : Tree(Kind, k->loc()), first(n) { }
 
   Tree* name() const { return first; }
 
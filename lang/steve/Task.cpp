@@ -0,0 +1,130 @@
+
+#include <steve/Task.hpp>
+
+namespace steve {
+
+namespace {
+
+// The pool and queue of the current thread, if it is in a pool.
+thread_local const Task_pool* pool_ = nullptr;
+thread_local std::size_t queue_ = 0;
+
+} // namespace
+
+// Start a pool of n threads.
+Task_pool::Task_pool(std::size_t n)
+  : queued_(0), pending_(0), next_(0), sleeping_(0), stop_(false)
+{
+  if (n == 0)
+    n = 1;
+  for (std::size_t i = 0; i < n; ++i)
+    queues_.emplace_back(new Queue());
+  threads_.reserve(n);
+  for (std::size_t i = 0; i < n; ++i)
+    threads_.emplace_back([this, i]() { run(i); });
+}
+
+// Stop the pool. Tasks that have been submitted are run before the
+// threads are joined.
+Task_pool::~Task_pool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  ready_.notify_all();
+  for (std::thread& t : threads_)
+    t.join();
+}
+
+// Submit a task to be run by one of the threads in the pool. The
+// task is pending before it is queued, so that wait does not return
+// before it has run, and it is counted as queued only once it can be
+// taken, so that a woken thread always finds it (unless another
+// thread takes it first).
+//
+// A thread counts itself as sleeping before it checks for queued tasks
+// under the lock, so a sleeping thread is always seen here, and it is
+// woken under the lock, so that the wakeup is not lost.
+void
+Task_pool::submit(Task t) {
+  ++pending_;
+  std::size_t q = pool_ == this ? queue_ : next_++ % queues_.size();
+  {
+    Queue& queue = *queues_[q];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back(std::move(t));
+  }
+  ++queued_;
+  if (sleeping_ != 0) {
+    { std::lock_guard<std::mutex> lock(mutex_); }
+    ready_.notify_one();
+  }
+}
+
+// Wait until every submitted task has been run. This must not be
+// called by a thread in the pool.
+void
+Task_pool::wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_.wait(lock, [this]() { return pending_ == 0; });
+}
+
+// Take the newest task from the queue q.
+bool
+Task_pool::pop(std::size_t q, Task& t) {
+  Queue& queue = *queues_[q];
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.tasks.empty())
+    return false;
+  t = std::move(queue.tasks.back());
+  queue.tasks.pop_back();
+  --queued_;
+  return true;
+}
+
+// Take the oldest task from a queue other than q, trying each in
+// turn.
+bool
+Task_pool::steal(std::size_t q, Task& t) {
+  std::size_t n = queues_.size();
+  for (std::size_t i = 1; i < n; ++i) {
+    Queue& queue = *queues_[(q + i) % n];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+      continue;
+    t = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    --queued_;
+    return true;
+  }
+  return false;
+}
+
+// Run tasks from the queue q, or stolen from other queues, until the
+// pool is stopped and no tasks remain. A thread sleeps only when no
+// task is queued.
+void
+Task_pool::run(std::size_t q) {
+  pool_ = this;
+  queue_ = q;
+  while (true) {
+    Task t;
+    if (pop(q, t) or steal(q, t)) {
+      t();
+      if (--pending_ == 0) {
+        { std::lock_guard<std::mutex> lock(mutex_); }
+        idle_.notify_all();
+      }
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++sleeping_;
+    ready_.wait(lock, [this]() { return stop_ or queued_ != 0; });
+    --sleeping_;
+    if (stop_ and queued_ == 0)
+      return;
+  }
+}
+
+} // namespace steve
@@ -0,0 +1,70 @@
+
+#ifndef STEVE_TASK_HPP
+#define STEVE_TASK_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// This module defines a pool of threads that run tasks in the
+// background. A task must not throw; it is responsible for reporting
+// its own failure.
+//
+// Tasks are scheduled by work stealing. Each thread has its own queue
+// of tasks. A task submitted by a thread in the pool is added to that
+// thread's queue, and tasks submitted by other threads are dealt to the
+// queues in turn. A thread runs the newest task in its own queue first.
+// When its queue is empty, it steals the oldest task in the queue of
+// another thread.
+//
+// The counts of tasks are atomic, so that submitting and running a
+// task takes only the lock of a queue. The lock of the pool is used
+// only to put idle threads to sleep and wake them.
+
+namespace steve {
+
+using Task = std::function<void()>;
+
+struct Task_pool {
+  explicit Task_pool(std::size_t);
+  ~Task_pool();
+
+  Task_pool(const Task_pool&) = delete;
+  Task_pool& operator=(const Task_pool&) = delete;
+
+  void submit(Task);
+  void wait();
+
+  std::size_t size() const { return threads_.size(); }
+
+private:
+  // The queue of tasks owned by a thread.
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  bool pop(std::size_t, Task&);
+  bool steal(std::size_t, Task&);
+  void run(std::size_t);
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::mutex mutex_;
+  std::condition_variable ready_;     // Signaled when a task is queued
+  std::condition_variable idle_;      // Signaled when all tasks have run
+  std::atomic<std::size_t> queued_;   // The number of queued tasks
+  std::atomic<std::size_t> pending_;  // The number of tasks not yet run
+  std::atomic<std::size_t> next_;     // The next queue to deal a task to
+  std::atomic<std::size_t> sleeping_; // The number of sleeping threads
+  bool stop_;                         // Guarded by mutex_
+  std::vector<std::thread> threads_;
+};
+
+} // namespace steve
+
+#endif
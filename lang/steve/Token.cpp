@@ -1,5 +1,6 @@
 
 #include <iostream>
+#include <mutex>
 #include <unordered_map>
 
 #include <steve/Token.hpp>
@@ -7,6 +8,74 @@
 
 namespace steve {
 
+// -------------------------------------------------------------------------- //
+// Symbols
+
+Symbol_table symbols_;
+
+namespace {
+
+// Hashing and equality for symbols.
+struct Symbol_hash {
+  std::size_t operator()(const Symbol& s) const {
+    return std::hash<String>()(s.text) ^ s.kind;
+  }
+};
+
+struct Symbol_eq {
+  bool operator()(const Symbol& a, const Symbol& b) const {
+    return a.kind == b.kind && a.text == b.text;
+  }
+};
+
+using Symbol_map = std::unordered_map<Symbol, Symbol_id, Symbol_hash, Symbol_eq>;
+
+// A mapping from symbols to their index in the symbol table. Symbols
+// are added under a lock, since several threads may lex at once.
+Symbol_map symbol_ids_;
+std::mutex symbol_mutex_;
+
+// The symbols found by this thread. Symbols are never removed, so
+// this is a cache of symbol_ids_ that is read without locking.
+thread_local Symbol_map local_ids_;
+
+// Add the symbol to the symbol table, returning its index.
+Symbol_id
+add_symbol(const Symbol& sym) {
+  constexpr int b = Symbol_table::base_bits;
+  Symbol_id n = symbols_.size++;
+  std::uint32_t m = (n >> b) + 1;
+  int k = 31 - __builtin_clz(m);
+  if (not symbols_.blocks[k])
+    symbols_.blocks[k] = new Symbol[std::size_t(1) << (k + b)];
+  symbols_.blocks[k][n - (((std::uint32_t(1) << k) - 1) << b)] = sym;
+  return n;
+}
+
+} // namespace
+
+// Returns the index of the symbol with the given kind and spelling,
+// adding that symbol to the symbol table if needed.
+Symbol_id
+get_symbol(Token_kind k, String s) {
+  Symbol sym {k, s};
+  auto iter = local_ids_.find(sym);
+  if (iter != local_ids_.end())
+    return iter->second;
+
+  Symbol_id n;
+  {
+    std::lock_guard<std::mutex> lock(symbol_mutex_);
+    auto iter = symbol_ids_.find(sym);
+    if (iter != symbol_ids_.end())
+      n = iter->second;
+    else
+      n = symbol_ids_.insert({sym, add_symbol(sym)}).first->second;
+  }
+  local_ids_.insert({sym, n});
+  return n;
+}
+
 // -------------------------------------------------------------------------- //
 // Token spelling
 
@@ -138,21 +207,21 @@ keyword(String s) {
 // Elaborate the token as an identifer.
 String
 as_identifier(const Token& k) {
-  steve_assert(token::get_type(k.kind) == token_id_type,
+  steve_assert(token::get_type(k.kind()) == token_id_type,
                format("token '{0}' is not an identifier", k));
-  return k.text;
+  return k.text();
 }
 
 // Elaborate the token as a boolean value.
 bool
 as_boolean(const Token& k) {
-  steve_assert(token::get_type(k.kind) == token_bool_type,
+  steve_assert(token::get_type(k.kind()) == token_bool_type,
                format("token '{0}' is not a boolean value", k));
   static String true_ = "true";
   static String false_ = "false";
-  if (k.text == true_)
+  if (k.text() == true_)
     return true;
-  if (k.text == false_)
+  if (k.text() == false_)
     return false;
   steve_unreachable("ill-formed boolean-literal");
 }
@@ -160,13 +229,13 @@ as_boolean(const Token& k) {
 // Elaborate the token as an integer value.
 Integer
 as_integer(const Token& k) {
-  steve_assert(token::get_type(k.kind) == token_int_type,
+  steve_assert(token::get_type(k.kind()) == token_int_type,
                format("token '{0}' is not an integer token", k));
-  switch (k.kind) {
-  case binary_literal_tok: return {k.text, 2};
-  case octal_literal_tok: return {k.text, 8};
-  case decimal_literal_tok: return {k.text, 10};
-  case hexadecimal_literal_tok: return {k.text, 16};
+  switch (k.kind()) {
+  case binary_literal_tok: return {k.text(), 2};
+  case octal_literal_tok: return {k.text(), 8};
+  case decimal_literal_tok: return {k.text(), 10};
+  case hexadecimal_literal_tok: return {k.text(), 16};
   default: break;
   }
   steve_unreachable("unhandled integer-literal");
@@ -8,6 +8,8 @@
 #include <steve/Integer.hpp>
 #include <steve/Location.hpp>
 
+#include <vector>
+
 namespace steve {
 
 // -------------------------------------------------------------------------- //
@@ -225,15 +227,45 @@ constexpr Token_kind comment_tok             = make_token(token_comment_type, 50
 // -------------------------------------------------------------------------- //
 // Token structure
 
+// -------------------------------------------------------------------------- //
+// Symbols
+
+// A symbol is the kind and spelling of a token. Each unique symbol is
+// stored once in the symbol table and is referred to by its index.
+struct Symbol {
+  Token_kind kind; // The kind of symbol represented
+  String     text; // A textual represntation of the symbol
+};
+
+using Symbol_id = std::uint32_t;
+
+Symbol_id get_symbol(Token_kind, String);
+const Symbol& get_symbol(Symbol_id);
+
+
+// -------------------------------------------------------------------------- //
+// Tokens
+
 // A token represents a symbol at a particular location in a
 // program's source text.
-struct Token {
+//
+// Tokens are packed into 8 bytes: the source offset (i.e., location)
+// of the token and the index of its symbol.
+class Token {
+public:
   Token(Token_kind, String);
-  Token(const Location&, Token_kind, String);
+  Token(Source_offset, Token_kind, String);
 
-  Location   loc;  // The location of the token
-  Token_kind kind; // The kind of symbol represented
-  String     text; // A textual represntation of the symbol
+  Source_offset offset() const;
+  Symbol_id symbol() const;
+
+  Location   loc() const;
+  Token_kind kind() const;
+  String     text() const;
+
+private:
+  Source_offset off_;
+  Symbol_id     sym_;
 };
 
 using Tokens = std::vector<Token>;
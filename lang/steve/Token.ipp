@@ -1,13 +1,58 @@
 
 namespace steve {
 
+// The symbol table. Symbols are stored in blocks whose sizes double,
+// starting with 2^base_bits symbols, so that a symbol never moves once
+// it has been added. This allows one thread to add symbols while others
+// read the symbols of tokens they have already lexed.
+struct Symbol_table {
+  static constexpr int base_bits = 10;
+
+  Symbol* blocks[32];
+  Symbol_id size;
+};
+
+extern Symbol_table symbols_;
+
+// Returns the symbol with the given index. Block k contains the
+// symbols whose indexes are in [(2^k - 1) * 2^b, (2^(k+1) - 1) * 2^b),
+// where b is the base_bits of the table.
+inline const Symbol&
+get_symbol(Symbol_id n) {
+  constexpr int b = Symbol_table::base_bits;
+  std::uint32_t m = (n >> b) + 1;
+  int k = 31 - __builtin_clz(m);
+  return symbols_.blocks[k][n - (((std::uint32_t(1) << k) - 1) << b)];
+}
+
+// Initialize a token that has no source location.
 inline
 Token::Token(Token_kind k, String t)
-  : loc(), kind(k), text(t) { }
+  : off_(0), sym_(get_symbol(k, t)) { }
 
 inline
-Token::Token(const Location& l, Token_kind k, String t)
-  : loc(l), kind(k), text(t) { }
+Token::Token(Source_offset n, Token_kind k, String t)
+  : off_(n), sym_(get_symbol(k, t)) { }
+
+// Returns the source offset of the token.
+inline Source_offset
+Token::offset() const { return off_; }
+
+// Returns the index of the token's symbol.
+inline Symbol_id
+Token::symbol() const { return sym_; }
+
+// Returns the location of the token.
+inline Location
+Token::loc() const { return Location(off_); }
+
+// Returns the kind of the token.
+inline Token_kind
+Token::kind() const { return get_symbol(sym_).kind; }
+
+// Returns the spelling of the token.
+inline String
+Token::text() const { return get_symbol(sym_).text; }
 
 
 // -------------------------------------------------------------------------- //
@@ -15,11 +60,11 @@ Token::Token(const Location& l, Token_kind k, String t)
 
 // Returns the token's kind.
 inline Token_kind
-kind(const Token& t) { return t.kind; }
+kind(const Token& t) { return t.kind(); }
 
 // Returns the token's kind.
 inline Token_kind
-kind(const Token* t) { return t->kind; }
+kind(const Token* t) { return t->kind(); }
 
 
 // -------------------------------------------------------------------------- //
@@ -46,16 +91,16 @@ template<typename T>
 template<typename C, typename T>
   std::basic_ostream<C, T>&
   operator<<(std::basic_ostream<C, T>& os, const Token& tok) {
-    return os << tok.text;
+    return os << tok.text();
   }
 
 template<typename C, typename T, typename K>
   inline std::basic_ostream<C, T>&
   operator<<(std::basic_ostream<C, T>& os, const debug_token<K>& k) {
     os << '[';
-    os << token_name(k.tok.kind);
-    if (token::is_typed(k.tok.kind))
-      os << ":" << k.tok.text;
+    os << token_name(k.tok.kind());
+    if (token::is_typed(k.tok.kind()))
+      os << ":" << k.tok.text();
      os << ']';
      return os;
   }
@@ -63,7 +108,7 @@ template<typename C, typename T, typename K>
 template<typename C, typename T, typename K>
   inline std::basic_ostream<C, T>&
   operator<<(std::basic_ostream<C, T>& os, const quote_token<K>& k) {
-    return os << '\'' << k.tok.text << '\'';
+    return os << '\'' << k.tok.text() << '\'';
   }
 
 } // namespace steve
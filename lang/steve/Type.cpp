@@ -161,7 +161,7 @@ get_parm_type_list(Decl_seq* ps) {
 Type*
 make_fn_type(Decl_seq* ps, Type* e) {
   Type_seq* ts = get_parm_type_list(ps);
-  return new Fn_type(ts, e);
+  return make_expr<Fn_type>(no_location, nullptr, ts, e);
 }
 
 
@@ -0,0 +1,83 @@
+// This program checks that canonical types are hash-consed: equal
+// constructions of a function or bitfield type return the same node,
+// different ones return different nodes, and the types allocated in
+// an arena are removed from the type table when it is forgotten.
+//
+//    type_canonical
+
+#include <iostream>
+
+#include <steve/Ast.hpp>
+#include <steve/Language.hpp>
+#include <steve/Memory.hpp>
+#include <steve/Type.hpp>
+
+using namespace steve;
+
+// Returns the type of a function taking an int and a bool, and
+// returning r. Each call builds a new parameter list.
+Type*
+make_fn(Type* r) {
+  Type_seq* ts = new Type_seq {get_int_type(), make_bool_type(no_location)};
+  return make_expr<Fn_type>(no_location, nullptr, ts, r);
+}
+
+// Returns the type bits(int, n, 0), with new integer operands.
+Type*
+make_bits(int n) {
+  Term* w = new Int(Integer(n));
+  Term* o = new Int(Integer(0));
+  return make_expr<Bitfield_type>(no_location, nullptr, get_int_type(), w, o);
+}
+
+bool
+check(const char* what, bool ok) {
+  if (not ok)
+    std::cerr << "error: " << what << '\n';
+  return ok;
+}
+
+int
+main() {
+  Language lang;
+  bool ok = true;
+
+  Type_table_stats before = type_table_stats();
+  Type* f1 = make_fn(get_int_type());
+  Type* f2 = make_fn(make_int_type(no_location));
+  Type* g = make_fn(get_bool_type());
+  Type_table_stats after = type_table_stats();
+  ok &= check("equal function types are different nodes", f1 == f2);
+  ok &= check("different function types are the same node", f1 != g);
+  ok &= check("function types are not counted",
+              after.lookups - before.lookups == 3 and
+              after.types - before.types == 2);
+
+  Type* b1 = make_bits(8);
+  Type* b2 = make_bits(8);
+  Type* b3 = make_bits(16);
+  ok &= check("equal bitfield types are different nodes", b1 == b2);
+  ok &= check("different bitfield types are the same node", b1 != b3);
+  ok &= check("canonical types are not canonical",
+              is_canonical_type(f1) and is_canonical_type(b1));
+
+  // A type made in an arena is canonical until the arena is forgotten,
+  // after which an equal construction makes a new node.
+  std::size_t types;
+  {
+    Arena a;
+    Type* r;
+    {
+      Arena_guard ag(a);
+      r = make_fn(make_bits(32));
+      ok &= check("arena type is not found", make_fn(make_bits(32)) == r);
+    }
+    types = type_table_stats().types;
+    forget_types(a);
+  }
+  ok &= check("forgotten types are kept", type_table_stats().types == types - 2);
+  ok &= check("kept types are forgotten", make_fn(get_int_type()) == f1);
+
+  std::cout << (ok ? "canonical types are shared\n" : "canonical types are not shared\n");
+  return ok ? 0 : 1;
+}
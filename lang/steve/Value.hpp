@@ -2,6 +2,7 @@
 #ifndef STEVE_VALUE_HPP
 #define STEVE_VALUE_HPP
 
+#include <steve/Memory.hpp>
 #include <steve/String.hpp>
 #include <steve/Integer.hpp>
 #include <steve/Ast.hpp>
@@ -28,7 +29,8 @@ union Value_data {
   Value_data() { }
   Value_data(unit_t u) : u(u) { }
   Value_data(bool b) : b(b) { }
-  Value_data(Integer n) : n(n) { }
+  Value_data(const Integer& n) : n(n) { }
+  Value_data(Integer&& n) : n(std::move(n)) { }
   Value_data(Fn* f) : f(f) { }
   Value_data(Type* t) : t(t) { }
   ~Value_data() { }
@@ -58,7 +60,8 @@ struct Value {
 
   Value(unit_t);
   Value(bool);
-  Value(Integer);
+  Value(const Integer&);
+  Value(Integer&&);
   Value(Fn*);
   Value(Type*);
   ~Value();
@@ -110,6 +113,7 @@ struct Eval {
 
   // Initialization
   Eval(const Value& v);
+  Eval(Value&& v);
   Eval(Expr* e);
 
   // Extraction
@@ -121,8 +125,13 @@ struct Eval {
 };
 
 // A sequence of evaluations. This is used, for example to store
-// the results of evaluating function arguments.
-using Eval_seq = std::vector<Eval>;
+// the results of evaluating function arguments. Most functions take
+// at most three arguments, which are stored in place.
+using Eval_seq = Small_vector<Eval, 3>;
+
+// A sequence of values. This is used to store the arguments of
+// calls evaluated by compiled code.
+using Value_seq = Small_vector<Value, 3>;
 
 bool is_value(const Eval&);
 bool is_partial(const Eval&);
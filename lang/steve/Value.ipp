@@ -104,9 +104,13 @@ Value::Value(bool b)
   : kind(bool_value), data(b) { }
 
 inline
-Value::Value(Integer n)
+Value::Value(const Integer& n)
   : kind(integer_value), data(n) { }
 
+inline
+Value::Value(Integer&& n)
+  : kind(integer_value), data(std::move(n)) { }
+
 inline
 Value::Value(Fn* f)
   : kind(function_value), data(f) { }
@@ -193,7 +197,7 @@ copy_data(bool p, Eval_data& self, const Eval_data& x) {
 // Move data into self. Note that we need to inplace construct the
 // non-trivial members.
 inline void
-move_data(bool p, Eval_data& self, const Eval_data&& x) {
+move_data(bool p, Eval_data& self, Eval_data&& x) {
   if (p)
     self.e = x.e;
   else
@@ -243,6 +247,10 @@ inline
 Eval::Eval(const Value& v)
   : partial(false), data(v) { }
 
+inline 
+Eval::Eval(Value&& v)
+  : partial(false), data(std::move(v)) { }
+
 inline 
 Eval::Eval(Expr* e)
   : partial(true), data(e) { }
@@ -21,7 +21,7 @@ make_discriminator_eq(Decl* parm, Expr* arg) {
   Resolution res = resolve_binary(arg->loc, *ovl, arg, fake);
   if (!res.is_unique()) {
     // TODO: Diagnose candidates.
-    error(arg->loc) << format("no matching call to operator == for '{}' "
+    error(arg->loc) << message("no matching call to operator == for '{}' "
                               "and a descriminator '{}'",
                               typed(arg), typed(parm));
     return nullptr;
@@ -79,7 +79,7 @@ Type*
 instantiate_variant(Dep_variant_type* type, Expr* arg) {
   if (Alt* alt = find_alternative(type, arg))
     return alt->type();
-  error(arg->loc) << format("no alternative matching '{}'", debug(arg));
+  error(arg->loc) << message("no alternative matching '{}'", debug(arg));
   return nullptr;
 }
 